@@ -0,0 +1,145 @@
+#include "csv_dev_file.h"
+#include "csv_reader.h"
+#include "csv_bind.h"
+#include <iostream>
+#include <iomanip>    // needed by setprecision
+#include <chrono>
+#include <memory>
+#include <random>
+#include <cstdio>
+#include <cstdlib>
+
+
+
+using namespace std;
+using namespace csv;
+typedef chrono::steady_clock::time_point tp;
+
+void print_throughput( const char* label, tp ts, tp te, size_t bytes )
+{
+  std::chrono::duration<double> duration =  (te - ts);
+  cout << setprecision(4) << "  " << left << setw(28) << label
+       << duration.count() << "s  " << (static_cast<double>(bytes) / duration.count() / static_cast<double>(to_bytes<1>::GBytes)) << " GB/s" << endl;
+}
+
+/**
+ * Plain struct filled from each row.
+ */
+struct trade
+{
+  int64_t       id       = 0;
+  std::string   symbol;
+  double        price    = 0;
+  int64_t       quantity = 0;
+  bool          buy      = false;
+};
+
+/**
+ * Synthetic data set with trades.
+ */
+std::string make_dataset( size_t size )
+{
+  std::mt19937_64  rnd( 42 );
+  std::string      data = "id,symbol,price,quantity,buy,venue\n";
+  const char*      symbols[] = { "AAPL", "MSFT", "GOOG", "AMZN", "\"BRK.B\"" };
+
+  data.reserve( size + 1024 );
+
+  for ( size_t id = 0; data.size() < size; ++id )
+  {
+    data += std::to_string(id) + "," + symbols[rnd()%5] + "," + std::to_string(rnd()%100000) + "." + std::to_string(rnd()%100) + ","
+          + std::to_string(rnd()%10000) + "," + ((rnd()%2)?"true":"false") + ",XNAS\n";
+  }
+
+  return data;
+}
+
+unique_ptr<csv_reader> make_reader( const std::string& filename )
+{
+  unique_ptr<csv_dev_file_options> optInput = std::make_unique<csv_dev_file_options>( filename,
+                                                                                      csv_dev_file_options::openmode::read,
+                                                                                      to_bytes<8>::MBytes );
+  unique_ptr<csv_dev_file>         devInput = std::make_unique<csv_dev_file>( std::move(optInput),nullptr);
+  return std::make_unique<csv_reader>( "csv reader", std::move(devInput), nullptr );
+}
+
+int main( int argc, char* argv[] )
+{
+  const size_t      _nSize  = ((argc > 1)?std::strtoul(argv[1],nullptr,10):256) * to_bytes<1>::MBytes;
+  const std::string filename = "csv_bind_benchmark.csv";
+
+  cout << "Generating " << (_nSize / to_bytes<1>::MBytes) << " MB data set" << endl;
+  {
+    const std::string data = make_dataset( _nSize );
+    FILE* pFile = fopen( filename.c_str(), "w" );
+    if ( pFile == nullptr )
+      return 1;
+    fwrite( data.data(), 1, data.size(), pFile );
+    fclose( pFile );
+  }
+
+  double checksum[2] = { 0, 0 };
+
+  cout << "----------------------------------------------" << endl;
+  {
+    unique_ptr<csv_reader> reader = make_reader( filename );
+    csv_row                row;
+    trade                  item;
+    size_t                 ndx[5] = { 0, 0, 0, 0, 0 };
+    bool                   first  = true;
+
+    auto ts = chrono::steady_clock::now();
+    reader->open();
+    while ( reader->read( row ) )
+    {
+      if ( first )
+      {
+        const char* labels[] = { "id", "symbol", "price", "quantity", "buy" };
+        for ( size_t col = 0; col < 5; ++col )
+          ndx[col] = static_cast<size_t>(reader->get_header().get_index( csv_data_t(labels[col]) ));
+        first = false;
+      }
+
+      item.id       = row[ndx[0]].as<int64_t>();
+      item.symbol   = static_cast<std::string_view>(row[ndx[1]].data());
+      item.price    = row[ndx[2]].as<double>();
+      item.quantity = row[ndx[3]].as<int64_t>();
+      item.buy      = (static_cast<std::string_view>(row[ndx[4]].data()) == "true");
+      checksum[0]  += item.price * static_cast<double>(item.quantity) + static_cast<double>(item.symbol.length() + item.buy);
+    }
+    reader->close();
+    auto te = chrono::steady_clock::now();
+
+    print_throughput( "csv_row + as<T>", ts, te, _nSize );
+  }
+
+  {
+    unique_ptr<csv_reader> reader = make_reader( filename );
+    csv_bind<trade>        bind;
+    trade                  item;
+
+    bind.column<&trade::id>      ( "id"       )
+        .column<&trade::symbol>  ( "symbol"   )
+        .column<&trade::price>   ( "price"    )
+        .column<&trade::quantity>( "quantity" )
+        .column<&trade::buy>     ( "buy"      );
+
+    auto ts = chrono::steady_clock::now();
+    reader->open();
+    while ( reader->read( bind, item ) )
+    {
+      checksum[1]  += item.price * static_cast<double>(item.quantity) + static_cast<double>(item.symbol.length() + item.buy);
+    }
+    reader->close();
+    auto te = chrono::steady_clock::now();
+
+    print_throughput( "csv_bind<trade>", ts, te, _nSize );
+  }
+
+  if ( checksum[0] != checksum[1] )
+    cout << "  MISMATCH " << checksum[0] << "/" << checksum[1] << endl;
+
+  remove( filename.c_str() );
+
+  return 0;
+}
@@ -0,0 +1,239 @@
+#include "csv_dev_file.h"
+#include "csv_dev_compressed.h"
+#include "csv_reader.h"
+#include <iostream>
+#include <iomanip>    // needed by setprecision
+#include <chrono>
+#include <memory>
+#include <random>
+#include <cstdio>
+#include <cstdlib>
+
+#ifdef CSV_HAS_ZLIB
+# include <zlib.h>
+#endif
+#ifdef CSV_HAS_ZSTD
+# include <zstd.h>
+#endif
+
+
+
+using namespace std;
+using namespace csv;
+typedef chrono::steady_clock::time_point tp;
+
+void print_throughput( const char* label, tp ts, tp te, size_t bytes, size_t file_size )
+{
+  std::chrono::duration<double> duration =  (te - ts);
+  cout << setprecision(4) << "  " << left << setw(28) << label
+       << duration.count() << "s  " << (static_cast<double>(bytes) / duration.count() / static_cast<double>(to_bytes<1>::GBytes)) << " GB/s"
+       << "  file " << (file_size / to_bytes<1>::KBytes) << " KB" << endl;
+}
+
+/**
+ * Synthetic data set with mostly numeric fields.
+ */
+std::string make_dataset( size_t size )
+{
+  std::mt19937_64  rnd( 42 );
+  std::string      data = "id,name,value,quantity,note\n";
+
+  data.reserve( size + 1024 );
+
+  for ( size_t id = 0; data.size() < size; ++id )
+  {
+    data += std::to_string(id) + ",item " + std::to_string(rnd()%100000) + "," + std::to_string(rnd()%1000000) + "."
+          + std::to_string(rnd()%100) + "," + std::to_string(rnd()%10000) + ",\"note, " + std::to_string(rnd()%1000) + "\"\n";
+  }
+
+  return data;
+}
+
+bool write_file( const std::string& filename, const std::string& data )
+{
+  FILE* pFile = fopen( filename.c_str(), "w" );
+  if ( pFile == nullptr )
+    return false;
+  fwrite( data.data(), 1, data.size(), pFile );
+  fclose( pFile );
+  return true;
+}
+
+size_t file_size( const std::string& filename )
+{
+  FILE* pFile = fopen( filename.c_str(), "r" );
+  if ( pFile == nullptr )
+    return 0;
+  fseek( pFile, 0, SEEK_END );
+  size_t size = static_cast<size_t>(ftell( pFile ));
+  fclose( pFile );
+  return size;
+}
+
+void append_le( std::string& out, uint32_t value, size_t bytes )
+{
+  for ( size_t ndx = 0; ndx < bytes; ++ndx, value >>= 8 )
+    out += static_cast<char>(value & 0xFF);
+}
+
+#ifdef CSV_HAS_ZLIB
+/**
+ * BGZF: gzip members of at most 64 KB, with the member size in the "BC" extra subfield.
+ */
+bool write_bgzf( const std::string& filename, const std::string& data )
+{
+  const size_t  block_size = 65280;
+  std::string   out;
+
+  for ( size_t offset = 0; offset <= data.size(); offset += block_size )
+  {
+    const size_t  length = std::min( block_size, data.size() - offset );
+    const Bytef*  input  = reinterpret_cast<const Bytef*>(data.data() + offset);
+    std::string   block( compressBound( static_cast<uLong>(length) ) + 64, '\0' );
+    z_stream      zs{};
+
+    deflateInit2( &zs, 6, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY );
+    zs.next_in   = const_cast<Bytef*>(input);
+    zs.avail_in  = static_cast<uInt>(length);
+    zs.next_out  = reinterpret_cast<Bytef*>(block.data());
+    zs.avail_out = static_cast<uInt>(block.size());
+    deflate( &zs, Z_FINISH );
+    block.resize( zs.total_out );
+    deflateEnd( &zs );
+
+    out += std::string( "\x1f\x8b\x08\x04\0\0\0\0\0\xff\x06\0BC\x02\0", 16 );
+    append_le( out, static_cast<uint32_t>(18 + block.size() + 8 - 1), 2 );
+    out += block;
+    append_le( out, static_cast<uint32_t>(crc32( 0, input, static_cast<uInt>(length) )), 4 );
+    append_le( out, static_cast<uint32_t>(length), 4 );
+
+    // Last block is empty, as the BGZF end of file marker.
+    if ( length == 0 )
+      break;
+  }
+
+  return write_file( filename, out );
+}
+#endif
+
+#ifdef CSV_HAS_ZSTD
+/**
+ * zstd seekable format: independent frames followed by a skippable frame with the seek table.
+ */
+bool write_zstd_seekable( const std::string& filename, const std::string& data )
+{
+  const size_t  frame_size = to_bytes<1>::MBytes;
+  std::string   out;
+  std::string   table;
+  uint32_t      frames = 0;
+
+  for ( size_t offset = 0; offset < data.size(); offset += frame_size, ++frames )
+  {
+    const size_t  length = std::min( frame_size, data.size() - offset );
+    std::string   frame( ZSTD_compressBound( length ), '\0' );
+
+    frame.resize( ZSTD_compress( frame.data(), frame.size(), data.data() + offset, length, 3 ) );
+    out += frame;
+    append_le( table, static_cast<uint32_t>(frame.size()), 4 );
+    append_le( table, static_cast<uint32_t>(length), 4 );
+  }
+
+  append_le( out, 0x184D2A5E, 4 );
+  append_le( out, static_cast<uint32_t>(table.size() + 9), 4 );
+  out += table;
+  append_le( out, frames, 4 );
+  append_le( out, 0, 1 );
+  append_le( out, 0x8F92EAB1, 4 );
+
+  return write_file( filename, out );
+}
+#endif
+
+template<typename device_t>
+size_t read_all( const std::string& filename, csv_uint_t nReadAhead )
+{
+  unique_ptr<csv_dev_file_options> optInput = std::make_unique<csv_dev_file_options>( filename,
+                                                                                      csv_dev_file_options::openmode::read,
+                                                                                      to_bytes<1>::MBytes,
+                                                                                      csv_dev_file_options::filetype::PLAIN_TEXT,
+                                                                                      nReadAhead );
+  unique_ptr<device_t>             devInput = std::make_unique<device_t>( std::move(optInput),nullptr);
+  csv_reader                       reader( "csv reader", std::move(devInput), nullptr );
+  csv_row_view                     row;
+  size_t                           rows = 0;
+
+  reader.open();
+  while ( reader.read( row ) )
+    ++rows;
+  reader.close();
+
+  return rows;
+}
+
+int main( int argc, char* argv[] )
+{
+  const size_t      _nSize   = ((argc > 1)?std::strtoul(argv[1],nullptr,10):256) * to_bytes<1>::MBytes;
+  const std::string filename = "csv_compressed_benchmark.csv";
+  std::vector<std::string> files = { filename };
+
+  cout << "Generating " << (_nSize / to_bytes<1>::MBytes) << " MB data set" << endl;
+  const std::string data = make_dataset( _nSize );
+  if ( write_file( filename, data ) == false )
+    return 1;
+
+#ifdef CSV_HAS_ZLIB
+  {
+    gzFile pFile = gzopen( (filename + ".gz").c_str(), "wb6" );
+    if ( pFile != nullptr )
+    {
+      // gzwrite() take an unsigned length.
+      for ( size_t offset = 0; offset < data.size(); offset += to_bytes<1>::GBytes )
+        gzwrite( pFile, data.data() + offset, static_cast<unsigned>(std::min<size_t>( data.size() - offset, to_bytes<1>::GBytes )) );
+      gzclose( pFile );
+      files.push_back( filename + ".gz" );
+    }
+  }
+  if ( write_bgzf( filename + ".bgz", data ) )
+    files.push_back( filename + ".bgz" );
+#endif
+#ifdef CSV_HAS_ZSTD
+  {
+    std::string compressed( ZSTD_compressBound( data.size() ), '\0' );
+    size_t      length = ZSTD_compress( compressed.data(), compressed.size(), data.data(), data.size(), 3 );
+    if ( ZSTD_isError( length ) == 0 )
+    {
+      compressed.resize( length );
+      write_file( filename + ".zst", compressed );
+      files.push_back( filename + ".zst" );
+    }
+  }
+  if ( write_zstd_seekable( filename + ".seekable.zst", data ) )
+    files.push_back( filename + ".seekable.zst" );
+#endif
+
+  cout << "----------------------------------------------" << endl;
+  cout << "--------------WARM PAGE CACHE-----------------" << endl;
+
+  size_t rows = read_all<csv_dev_file>( filename, 0 );
+  for ( const std::string& name : files )
+  {
+    for ( csv_uint_t nReadAhead : { 1, 4 } )
+    {
+      const std::string label = name.substr( filename.size() ) + " read ahead " + std::to_string(nReadAhead);
+
+      auto   ts    = chrono::steady_clock::now();
+      size_t _rows = read_all<csv_dev_compressed>( name, nReadAhead );
+      auto   te    = chrono::steady_clock::now();
+
+      print_throughput( (name == filename)?("plain" + label).c_str():label.c_str(), ts, te, _nSize, file_size( name ) );
+
+      if ( _rows != rows )
+        cout << "  MISMATCH rows " << _rows << "/" << rows << endl;
+    }
+  }
+
+  for ( const std::string& name : files )
+    remove( name.c_str() );
+
+  return 0;
+}
@@ -0,0 +1,133 @@
+#include "csv_dev_mmap.h"
+#include "csv_reader.h"
+#include "csv_dialect.h"
+#include <iostream>
+#include <iomanip>    // needed by setprecision
+#include <chrono>
+#include <memory>
+#include <random>
+#include <cstdio>
+#include <cstring>
+
+
+
+using namespace std;
+using namespace csv;
+typedef chrono::steady_clock::time_point tp;
+
+/**
+ * Synthetic data set with 80 columns, mostly numeric fields with some quoted text.
+ */
+std::string make_dataset( size_t size, char delimiter )
+{
+  std::mt19937_64  rnd( 42 );
+  std::string      data;
+
+  data.reserve( size + 1024 );
+
+  for ( size_t col = 0; col < 80; ++col )
+    data += "column_" + std::to_string(col) + ((col<79)?delimiter:'\n');
+
+  while ( data.size() < size )
+  {
+    for ( size_t col = 0; col < 80; ++col )
+    {
+      switch ( col % 8 )
+      {
+        case 0: data += "192.168." + std::to_string(rnd()%256) + "." + std::to_string(rnd()%256); break;
+        case 1: data += "\"flow " + std::to_string(rnd()%100000) + " tcp\""; break;
+        case 2: data += std::to_string(rnd()%1000000) + "." + std::to_string(rnd()%1000); break;
+        case 3: data += (rnd()%2)?"true":"false"; break;
+        default: data += std::to_string(rnd()%100000000); break;
+      }
+      data += ((col<79)?delimiter:'\n');
+    }
+  }
+
+  return data;
+}
+
+/**
+ * Read the whole file and return elapsed time, @param checksum is updated 
+ * with the total length of the fields.
+ */
+template<typename reader_t, typename setup_t>
+double read_file( const std::string& filename, setup_t setup, size_t& checksum )
+{
+  unique_ptr<csv_dev_file_options> optInput = std::make_unique<csv_dev_file_options>( filename,
+                                                                                      csv_dev_file_options::openmode::read );
+  unique_ptr<csv_dev_mmap>         devInput = std::make_unique<csv_dev_mmap>( std::move(optInput),nullptr);
+  reader_t                         reader( "csv reader", std::move(devInput), nullptr );
+  csv_row_view                     row;
+
+  setup( reader );
+
+  auto ts = chrono::steady_clock::now();
+  reader.open();
+  while ( reader.read( row ) )
+  {
+    for ( const auto& field : row )
+      checksum += field.data().length();
+  }
+  reader.close();
+  auto te = chrono::steady_clock::now();
+
+  return std::chrono::duration<double>(te - ts).count();
+}
+
+template<typename dialect_t>
+void benchmark( const char* label, size_t size )
+{
+  const std::string filename = "csv_dialect_benchmark.csv";
+  const std::string data     = make_dataset( size, dialect_t::delimiter() );
+
+  FILE* pFile = fopen( filename.c_str(), "w" );
+  if ( pFile == nullptr )
+    return;
+  fwrite( data.data(), 1, data.size(), pFile );
+  fclose( pFile );
+
+  size_t _checksumRuntime  = 0;
+  size_t _checksumCompiled = 0;
+
+  // Warm up page cache.
+  read_file<csv_reader_t<dialect_t>>( filename, []( auto& ){}, _checksumCompiled );
+  _checksumCompiled = 0;
+
+  const double _runtime  = read_file<csv_reader>( filename, []( csv_reader& reader ){
+                                reader.set_delimeter   ( dialect_t::delimiter()        );
+                                reader.set_quote       ( dialect_t::quote()            );
+                                reader.set_eol         ( dialect_t::eol()              );
+                                reader.set_comment     ( dialect_t::comment()          );
+                                reader.allow_comments  ( dialect_t::allow_comments()   );
+                                reader.skip_whitespaces( dialect_t::skip_whitespaces() );
+                                reader.trim_all        ( dialect_t::trim_all()         );
+                              }, _checksumRuntime );
+  const double _compiled = read_file<csv_reader_t<dialect_t>>( filename, []( auto& ){}, _checksumCompiled );
+
+  const double _gbytes   = static_cast<double>(data.size()) / static_cast<double>(to_bytes<1>::GBytes);
+  cout << setprecision(4) << "  " << left << setw(12) << label
+       << "csv_reader " << (_gbytes / _runtime) << " GB/s   "
+       << "csv_reader_t " << (_gbytes / _compiled) << " GB/s   "
+       << "gain " << ((_runtime / _compiled - 1.0) * 100.0) << "%" << endl;
+
+  if ( _checksumRuntime != _checksumCompiled )
+    cout << "  MISMATCH " << _checksumRuntime << "/" << _checksumCompiled << endl;
+
+  remove( filename.c_str() );
+}
+
+int main( int argc, char* argv[] )
+{
+  const size_t _nSize = ((argc > 1)?std::strtoul(argv[1],nullptr,10):256) * to_bytes<1>::MBytes;
+
+  cout << "----------------------------------------------" << endl;
+  cout << "-------------------DIALECT--------------------" << endl;
+  benchmark<csv_dialect_rfc4180>( "rfc4180", _nSize );
+  benchmark<csv_dialect_tsv>    ( "tsv"    , _nSize );
+  benchmark<csv_dialect_ssv>    ( "ssv"    , _nSize );
+  benchmark<csv_dialect_raw>    ( "raw"    , _nSize );
+  benchmark<csv_dialect<',','\"','\n','#',true>>( "comments", _nSize );
+
+  return 0;
+}
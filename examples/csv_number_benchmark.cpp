@@ -0,0 +1,150 @@
+#include "csv_numeric_column.h"
+#include "csv_scanner.h"
+#include <iostream>
+#include <iomanip>    // needed by setprecision
+#include <chrono>
+#include <random>
+#include <string>
+#include <cstdlib>
+
+
+
+using namespace std;
+using namespace csv;
+typedef chrono::steady_clock::time_point tp;
+
+void print_throughput( const char* label, tp ts, tp te, size_t fields )
+{
+  std::chrono::duration<double> duration =  (te - ts);
+  cout << setprecision(4) << "  " << left << setw(28) << label
+       << duration.count() << "s  " << (static_cast<double>(fields) / duration.count() / 1000000.0) << " M fields/s" << endl;
+}
+
+/**
+ * Synthetic rows with two columns, integers and decimals of different lengths
+ * with a few missing values.
+ */
+std::vector<csv_row> make_rows( size_t count )
+{
+  std::mt19937_64       rnd( 42 );
+  std::vector<csv_row>  rows( count );
+
+  for ( auto& row : rows )
+  {
+    std::string integer = std::to_string( static_cast<int64_t>(rnd() % 10000000000ULL) * ((rnd()%4==0)?-1:1) );
+    std::string decimal = std::to_string( rnd() % 1000000 ) + "." + std::to_string( rnd() % 1000 );
+
+    if ( rnd()%100 == 0 )
+      integer = decimal = "n/a";
+
+    row.push_back( csv_field_t( csv_data_t( integer.c_str() ), false ) );
+    row.push_back( csv_field_t( csv_data_t( decimal.c_str() ), false ) );
+  }
+
+  return rows;
+}
+
+/**
+ * Compare values with csv_field::try_as(), that is the reference implementation.
+ */
+template<typename number_t>
+size_t check( const std::vector<csv_row>& rows, size_t column, const csv_numeric_column<number_t>& values )
+{
+  size_t mismatch = 0;
+
+  for ( size_t ndx = 0; ndx < rows.size(); ++ndx )
+  {
+    number_t value  = 0;
+    bool     valid  = rows[ndx][column].try_as( value );
+
+    if ( (valid == values.error(ndx)) || (valid && (value != values[ndx])) )
+      ++mismatch;
+  }
+
+  return mismatch;
+}
+
+template<typename number_t>
+void run_columns( const char* title, const std::vector<csv_row>& rows, const csv_column_batch& batch, size_t column )
+{
+  const csv_scanner::isa_t isas[] = { csv_scanner::isa_t::scalar, csv_scanner::isa_t::sse42 };
+  const csv_scanner::isa_t _isaDefault = csv_scanner::get_isa();
+
+  cout << "----------------------------------------------" << endl;
+  cout << title << endl;
+
+  {
+    number_t sum = 0;
+    auto ts = chrono::steady_clock::now();
+    for ( const auto& row : rows )
+    {
+      if constexpr ( std::is_same_v<number_t,double> )
+        sum += row[column].data().to_double();
+      else
+        sum += row[column].data().to_long();
+    }
+    auto te = chrono::steady_clock::now();
+    print_throughput( std::is_same_v<number_t,double>?"to_double (per field)":"to_long (per field)", ts, te, rows.size() );
+    if ( sum == 1 )
+      cout << sum << endl;
+  }
+
+  {
+    number_t sum = 0;
+    auto ts = chrono::steady_clock::now();
+    for ( const auto& row : rows )
+      sum += row[column].template as<number_t>();
+    auto te = chrono::steady_clock::now();
+    print_throughput( "as<T> (per field)", ts, te, rows.size() );
+    if ( sum == 1 )
+      cout << sum << endl;
+  }
+
+  for ( auto isa : isas )
+  {
+    if ( csv_scanner::set_isa( isa ) == false )
+      continue;
+
+    csv_numeric_column<number_t> values;
+
+    // buffers are allocated once and reused
+    values.parse( batch, column );
+
+    auto ts = chrono::steady_clock::now();
+    values.parse( rows, column );
+    auto te = chrono::steady_clock::now();
+    print_throughput( (std::string("rows ")+csv_scanner::isa_name(isa)).c_str(), ts, te, rows.size() );
+    if ( size_t mismatch = check( rows, column, values ) )
+      cout << "  MISMATCH " << mismatch << endl;
+
+    ts = chrono::steady_clock::now();
+    values.parse( batch, column );
+    te = chrono::steady_clock::now();
+    print_throughput( (std::string("column_batch ")+csv_scanner::isa_name(isa)).c_str(), ts, te, rows.size() );
+    if ( size_t mismatch = check( rows, column, values ) )
+      cout << "  MISMATCH " << mismatch << endl;
+  }
+
+  csv_scanner::set_isa( _isaDefault );
+}
+
+int main( int argc, char* argv[] )
+{
+  const size_t     _nRows  = ((argc > 1)?std::strtoul(argv[1],nullptr,10):4) * 1000000;
+
+  cout << "Generating " << _nRows << " rows" << endl;
+  const std::vector<csv_row> rows = make_rows( _nRows );
+  csv_column_batch           batch;
+
+  for ( const auto& row : rows )
+  {
+    for ( const auto& field : row )
+      batch.append( field.data().data(), field.data().length(), false );
+    batch.end_row();
+  }
+
+  run_columns<int64_t>( "-----------------INT64_T----------------------", rows, batch, 0 );
+  run_columns<double> ( "-----------------DOUBLE-----------------------", rows, batch, 1 );
+
+  return 0;
+}
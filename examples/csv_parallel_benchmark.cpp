@@ -0,0 +1,83 @@
+#include "csv_dev_file.h"
+#include "csv_dev_mmap.h"
+#include "csv_reader.h"
+#include "csv_parallel_reader.h"
+#include <iostream>
+#include <iomanip>    // needed by setprecision
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <cstdlib>
+
+
+
+using namespace std;
+using namespace csv;
+typedef chrono::steady_clock::time_point tp;
+
+void print_throughput( const std::string& label, tp ts, tp te, size_t rows )
+{
+  std::chrono::duration<double> duration =  (te - ts);
+  cout << setprecision(4) << "  " << left << setw(28) << label
+       << duration.count() << "s  " << rows << " rows" << endl;
+}
+
+int main( int argc, char* argv[] )
+{
+  if (argc < 2 )
+  {
+    printf( "Usage:                                                \n" );
+    printf( "      ./csv_parallel_benchmark <csv filename> [threads]\n" );
+    printf( "                                                      \n" );
+    return 0;
+  }
+
+  const std::string filename   = argv[1];
+  const std::size_t maxThreads = (argc > 2)?std::strtoul(argv[2],nullptr,10):std::thread::hardware_concurrency();
+
+  cout << "----------------------------------------------" << endl;
+  cout << "-----------------CSV_READER-------------------" << endl;
+  {
+    unique_ptr<csv_dev_file_options> optInput = std::make_unique<csv_dev_file_options>( filename,
+                                                                                        csv_dev_file_options::openmode::read,
+                                                                                        to_bytes<8>::MBytes );
+    unique_ptr<csv_dev_file>         devInput = std::make_unique<csv_dev_file>( std::move(optInput),nullptr);
+    csv_reader                       reader( "csv reader", std::move(devInput), nullptr );
+    csv_row                          row;
+
+    auto ts = chrono::steady_clock::now();
+    reader.open();
+    while ( reader.read( row ) )
+    {}
+    reader.close();
+    auto te = chrono::steady_clock::now();
+
+    print_throughput( "sequential", ts, te, reader.get_rows() );
+  }
+
+  cout << "----------------------------------------------" << endl;
+  cout << "------------CSV_PARALLEL_READER---------------" << endl;
+  for ( auto order : { csv_parallel_reader::order_t::ordered, csv_parallel_reader::order_t::unordered } )
+  {
+    for ( std::size_t threads = 1; threads <= std::max( maxThreads, std::size_t(1) ); threads *= 2 )
+    {
+      unique_ptr<csv_dev_file_options> optInput = std::make_unique<csv_dev_file_options>( filename,
+                                                                                          csv_dev_file_options::openmode::read );
+      unique_ptr<csv_dev_mmap>         devInput = std::make_unique<csv_dev_mmap>( std::move(optInput),nullptr);
+      csv_parallel_reader              reader( "csv parallel reader", std::move(devInput), nullptr, threads, order );
+      csv_row                          row;
+
+      auto ts = chrono::steady_clock::now();
+      reader.open();
+      while ( reader.read( row ) )
+      {}
+      reader.close();
+      auto te = chrono::steady_clock::now();
+
+      print_throughput( std::string((order==csv_parallel_reader::order_t::ordered)?"ordered":"unordered") + 
+                        " threads " + std::to_string(threads), ts, te, reader.get_rows() );
+    }
+  }
+
+  return 0;
+}
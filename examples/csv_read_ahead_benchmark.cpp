@@ -0,0 +1,146 @@
+#include "csv_dev_file.h"
+#include "csv_dev_uring.h"
+#include "csv_reader.h"
+#include <iostream>
+#include <iomanip>    // needed by setprecision
+#include <chrono>
+#include <memory>
+#include <random>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+
+
+
+using namespace std;
+using namespace csv;
+typedef chrono::steady_clock::time_point tp;
+
+void print_throughput( const char* label, tp ts, tp te, size_t bytes )
+{
+  std::chrono::duration<double> duration =  (te - ts);
+  cout << setprecision(4) << "  " << left << setw(28) << label
+       << duration.count() << "s  " << (static_cast<double>(bytes) / duration.count() / static_cast<double>(to_bytes<1>::GBytes)) << " GB/s" << endl;
+}
+
+/**
+ * Synthetic data set with mostly numeric fields.
+ */
+std::string make_dataset( size_t size )
+{
+  std::mt19937_64  rnd( 42 );
+  std::string      data = "id,name,value,quantity,note\n";
+
+  data.reserve( size + 1024 );
+
+  for ( size_t id = 0; data.size() < size; ++id )
+  {
+    data += std::to_string(id) + ",item " + std::to_string(rnd()%100000) + "," + std::to_string(rnd()%1000000) + "."
+          + std::to_string(rnd()%100) + "," + std::to_string(rnd()%10000) + ",\"note, " + std::to_string(rnd()%1000) + "\"\n";
+  }
+
+  return data;
+}
+
+/**
+ * Drop file pages from the page cache, so that data are read again from the storage.
+ */
+void drop_cache( const std::string& filename )
+{
+  int fd = open( filename.c_str(), O_RDONLY );
+  if ( fd == -1 )
+    return;
+  fdatasync( fd );
+  posix_fadvise( fd, 0, 0, POSIX_FADV_DONTNEED );
+  close( fd );
+}
+
+template<typename device_t>
+size_t read_all( const std::string& filename, csv_uint_t nBufSize, csv_uint_t nReadAhead, bool bDirect )
+{
+  unique_ptr<csv_dev_file_options> optInput = std::make_unique<csv_dev_file_options>( filename,
+                                                                                      csv_dev_file_options::openmode::read,
+                                                                                      nBufSize,
+                                                                                      csv_dev_file_options::filetype::PLAIN_TEXT,
+                                                                                      nReadAhead,
+                                                                                      bDirect );
+  unique_ptr<device_t>             devInput = std::make_unique<device_t>( std::move(optInput),nullptr);
+  csv_reader                       reader( "csv reader", std::move(devInput), nullptr );
+  csv_row_view                     row;
+  size_t                           rows = 0;
+
+  reader.open();
+  while ( reader.read( row ) )
+    ++rows;
+  reader.close();
+
+  return rows;
+}
+
+int main( int argc, char* argv[] )
+{
+  const size_t      _nSize   = ((argc > 1)?std::strtoul(argv[1],nullptr,10):256) * to_bytes<1>::MBytes;
+  const std::string filename = "csv_read_ahead_benchmark.csv";
+  const csv_uint_t  _nBufSize = to_bytes<1>::MBytes;
+
+  cout << "Generating " << (_nSize / to_bytes<1>::MBytes) << " MB data set" << endl;
+  {
+    const std::string data = make_dataset( _nSize );
+    FILE* pFile = fopen( filename.c_str(), "w" );
+    if ( pFile == nullptr )
+      return 1;
+    fwrite( data.data(), 1, data.size(), pFile );
+    fclose( pFile );
+  }
+
+  typedef size_t (*read_all_t)( const std::string&, csv_uint_t, csv_uint_t, bool );
+
+  struct {
+    const char*  label;
+    read_all_t   reader;
+    csv_uint_t   buffers;
+    bool         direct;
+  } const tests[] = {
+    { "synchronous",              read_all<csv_dev_file>,  0,  false },
+    { "read ahead 1 buffer",      read_all<csv_dev_file>,  1,  false },
+    { "read ahead 2 buffers",     read_all<csv_dev_file>,  2,  false },
+    { "read ahead 4 buffers",     read_all<csv_dev_file>,  4,  false },
+    { "O_DIRECT",                 read_all<csv_dev_file>,  0,  true  },
+    { "O_DIRECT read ahead 2",    read_all<csv_dev_file>,  2,  true  },
+#ifdef CSV_HAS_IO_URING
+    { "csv_dev_uring 4 buffers",  read_all<csv_dev_uring>, 4,  false },
+    { "csv_dev_uring 16 buffers", read_all<csv_dev_uring>, 16, false },
+    { "csv_dev_uring O_DIRECT",   read_all<csv_dev_uring>, 16, true  },
+#endif
+  };
+
+  for ( int cold = 1; cold >= 0; --cold )
+  {
+    cout << "----------------------------------------------" << endl;
+    cout << (cold?"--------------COLD PAGE CACHE-----------------":"--------------WARM PAGE CACHE-----------------") << endl;
+
+    size_t rows = 0;
+    for ( size_t ndx = 0; ndx < sizeof(tests)/sizeof(tests[0]); ++ndx )
+    {
+      if ( cold )
+        drop_cache( filename );
+      else
+        read_all<csv_dev_file>( filename, _nBufSize, 0, false );
+
+      auto   ts    = chrono::steady_clock::now();
+      size_t _rows = tests[ndx].reader( filename, _nBufSize, tests[ndx].buffers, tests[ndx].direct );
+      auto   te    = chrono::steady_clock::now();
+
+      print_throughput( tests[ndx].label, ts, te, _nSize );
+
+      if ( (ndx > 0) && (_rows != rows) )
+        cout << "  MISMATCH rows " << _rows << "/" << rows << endl;
+      rows = _rows;
+    }
+  }
+
+  remove( filename.c_str() );
+
+  return 0;
+}
@@ -0,0 +1,198 @@
+#include "csv_dev_file.h"
+#include "csv_dev_mmap.h"
+#include "csv_reader.h"
+#include "csv_row_index.h"
+#include <iostream>
+#include <iomanip>    // needed by setprecision
+#include <chrono>
+#include <memory>
+#include <random>
+#include <cstdio>
+#include <cstdlib>
+
+
+
+using namespace std;
+using namespace csv;
+typedef chrono::steady_clock::time_point tp;
+
+void print_throughput( const char* label, tp ts, tp te, size_t bytes )
+{
+  std::chrono::duration<double> duration =  (te - ts);
+  cout << setprecision(4) << "  " << left << setw(28) << label
+       << duration.count() << "s  " << (static_cast<double>(bytes) / duration.count() / static_cast<double>(to_bytes<1>::GBytes)) << " GB/s" << endl;
+}
+
+void print_latency( const char* label, tp ts, tp te, size_t count )
+{
+  std::chrono::duration<double, std::micro> duration =  (te - ts);
+  cout << setprecision(4) << "  " << left << setw(28) << label
+       << (duration.count() / static_cast<double>(count)) << " us for each row" << endl;
+}
+
+/**
+ * Synthetic data set where the first column is the row number, so that rows
+ * found with seek_row() can be checked.
+ */
+std::string make_dataset( size_t size, size_t& rows )
+{
+  std::mt19937_64  rnd( 42 );
+  std::string      data = "row,name,value,note\n";
+
+  data.reserve( size + 1024 );
+
+  for ( rows = 0; data.size() < size; ++rows )
+  {
+    data += std::to_string(rows) + ",item " + std::to_string(rnd()%100000) + "," + std::to_string(rnd()%1000000)
+          + ((rnd()%4)?",plain\n":",\"quoted, with delimiter\"\n");
+  }
+
+  return data;
+}
+
+template<typename device_t>
+unique_ptr<csv_reader> make_reader( const std::string& filename )
+{
+  unique_ptr<csv_dev_file_options> optInput = std::make_unique<csv_dev_file_options>( filename,
+                                                                                      csv_dev_file_options::openmode::read,
+                                                                                      to_bytes<1>::MBytes );
+  unique_ptr<device_t>             devInput = std::make_unique<device_t>( std::move(optInput),nullptr);
+  return std::make_unique<csv_reader>( "csv reader", std::move(devInput), nullptr );
+}
+
+template<typename device_t>
+bool seek_rows( const char* label, const std::string& filename, csv_row_index& index, const std::vector<size_t>& targets )
+{
+  unique_ptr<csv_reader> reader = make_reader<device_t>( filename );
+  csv_row_view           row;
+  bool                   valid = true;
+
+  reader->set_row_index( &index );
+  reader->open();
+
+  auto ts = chrono::steady_clock::now();
+  for ( size_t target : targets )
+  {
+    if ( (reader->seek_row( target ) == false) || (reader->read( row ) == false) ||
+         (row[0].as<size_t>() != target) )
+    {
+      valid = false;
+      cout << "  MISMATCH on row " << target << endl;
+      break;
+    }
+  }
+  auto te = chrono::steady_clock::now();
+  reader->close();
+
+  print_latency( label, ts, te, targets.size() );
+  return valid;
+}
+
+int main( int argc, char* argv[] )
+{
+  const size_t      _nSize   = ((argc > 1)?std::strtoul(argv[1],nullptr,10):256) * to_bytes<1>::MBytes;
+  const size_t      _nStep   = (argc > 2)?std::strtoul(argv[2],nullptr,10):64;
+  const std::string filename = "csv_row_index_benchmark.csv";
+  const std::string sidecar  = csv_row_index::sidecar_name( filename );
+  size_t            _nRows   = 0;
+
+  cout << "Generating " << (_nSize / to_bytes<1>::MBytes) << " MB data set" << endl;
+  {
+    const std::string data = make_dataset( _nSize, _nRows );
+    FILE* pFile = fopen( filename.c_str(), "w" );
+    if ( pFile == nullptr )
+      return 1;
+    fwrite( data.data(), 1, data.size(), pFile );
+    fclose( pFile );
+  }
+
+  cout << "----------------------------------------------" << endl;
+  cout << "-------------------SCAN-----------------------" << endl;
+  {
+    unique_ptr<csv_reader> reader = make_reader<csv_dev_file>( filename );
+    csv_row_view           row;
+
+    auto ts = chrono::steady_clock::now();
+    reader->open();
+    while ( reader->read( row ) )
+    {}
+    reader->close();
+    auto te = chrono::steady_clock::now();
+
+    print_throughput( "without index", ts, te, _nSize );
+  }
+
+  {
+    unique_ptr<csv_reader> reader = make_reader<csv_dev_file>( filename );
+    csv_row_index          index( _nStep );
+    csv_row_view           row;
+
+    auto ts = chrono::steady_clock::now();
+    reader->set_row_index( &index );
+    reader->open();
+    while ( reader->read( row ) )
+    {}
+    reader->close();
+    auto te = chrono::steady_clock::now();
+
+    print_throughput( "building index", ts, te, _nSize );
+
+    ts = chrono::steady_clock::now();
+    csv_result _res = index.save( sidecar, filename );
+    te = chrono::steady_clock::now();
+
+    cout << "  " << index.rows() << " rows, " << index.offsets().size() << " offsets, step " << index.step()
+         << ", saved in " << chrono::duration<double, std::milli>(te - ts).count() << " ms" << endl;
+
+    if ( (_res != csv_result::_ok) || (index.rows() != _nRows) )
+      cout << "  FAILED to build index" << endl;
+  }
+
+  cout << "----------------------------------------------" << endl;
+  cout << "-------------------SEEK-----------------------" << endl;
+  {
+    csv_row_index  index;
+
+    auto ts = chrono::steady_clock::now();
+    csv_result _res = index.load( sidecar, filename );
+    auto te = chrono::steady_clock::now();
+
+    cout << "  index loaded in " << chrono::duration<double, std::milli>(te - ts).count() << " ms" << endl;
+    if ( _res != csv_result::_ok )
+    {
+      cout << "  FAILED to load index" << endl;
+      return 1;
+    }
+
+    std::mt19937_64      rnd( 7 );
+    std::vector<size_t>  targets( 1000 );
+    for ( size_t& target : targets )
+      target = rnd() % _nRows;
+
+    seek_rows<csv_dev_file>( "seek_row() csv_dev_file", filename, index, targets );
+    seek_rows<csv_dev_mmap>( "seek_row() csv_dev_mmap", filename, index, targets );
+
+    // Same rows reached parsing from the beginning of the file.
+    std::vector<size_t>    scans( targets.begin(), targets.begin() + 4 );
+    unique_ptr<csv_reader> reader = make_reader<csv_dev_mmap>( filename );
+    csv_row_view           row;
+
+    ts = chrono::steady_clock::now();
+    for ( size_t target : scans )
+    {
+      reader = make_reader<csv_dev_mmap>( filename );
+      reader->open();
+      for ( size_t ndx = 0; (ndx <= target) && reader->read( row ); ++ndx )
+      {}
+      reader->close();
+    }
+    te = chrono::steady_clock::now();
+
+    print_latency( "scan from byte 0", ts, te, scans.size() );
+  }
+
+  remove( sidecar.c_str() );
+  remove( filename.c_str() );
+
+  return 0;
+}
@@ -0,0 +1,259 @@
+#include "csv_dev_file.h"
+#include "csv_reader.h"
+#include "csv_scanner.h"
+#include <iostream>
+#include <iomanip>    // needed by setprecision
+#include <chrono>
+#include <memory>
+#include <random>
+#include <cstdio>
+#include <cstring>
+
+
+
+using namespace std;
+using namespace csv;
+typedef chrono::steady_clock::time_point tp;
+
+void print_throughput( const char* label, tp ts, tp te, size_t bytes )
+{
+  std::chrono::duration<double> duration =  (te - ts);
+  cout << setprecision(4) << "  " << left << setw(28) << label
+       << duration.count() << "s  " << (static_cast<double>(bytes) / duration.count() / static_cast<double>(to_bytes<1>::GBytes)) << " GB/s" << endl;
+}
+
+/**
+ * Synthetic data set with 80 columns, mostly numeric fields as for network flows
+ * and some quoted text.
+ */
+std::string make_dataset( size_t size )
+{
+  std::mt19937_64  rnd( 42 );
+  std::string      data;
+
+  data.reserve( size + 1024 );
+
+  for ( size_t col = 0; col < 80; ++col )
+    data += "column_" + std::to_string(col) + ((col<79)?",":"\n");
+
+  while ( data.size() < size )
+  {
+    for ( size_t col = 0; col < 80; ++col )
+    {
+      switch ( col % 8 )
+      {
+        case 0: data += "192.168." + std::to_string(rnd()%256) + "." + std::to_string(rnd()%256); break;
+        case 1: data += "\"flow " + std::to_string(rnd()%100000) + ", tcp\""; break;
+        case 2: data += std::to_string(rnd()%1000000) + "." + std::to_string(rnd()%1000); break;
+        case 3: data += (rnd()%2)?"true":"false"; break;
+        default: data += std::to_string(rnd()%100000000); break;
+      }
+      data += ((col<79)?',':'\n');
+    }
+  }
+
+  return data;
+}
+
+/**
+ * Tokenizer with the same per-character logic used by csv_parser before csv_scanner.
+ */
+size_t tokenize_per_byte( const std::string& data, size_t& fields )
+{
+  const std::string  whitespaces = "\a\b\t\v\f\r\n";
+  csv_data_t         field;
+  size_t             checksum  = 0;
+  bool               quoteOpen = false;
+
+  for ( char ch : data )
+  {
+    if ( ((ch == ',') && (quoteOpen == false)) || (ch == '\n') ) {
+      checksum += field.length(); ++fields;
+      field.clear(); quoteOpen = false;
+      continue;
+    }
+
+    if ( ch == '\"' ) {
+      if ( field.empty() && !quoteOpen )        quoteOpen = true;
+      else if ( !field.empty() && quoteOpen )   quoteOpen = false;
+    }
+
+    if ( quoteOpen || (memchr( whitespaces.c_str(), ch, whitespaces.length() ) == nullptr) )
+      field.push_back( ch );
+  }
+
+  return checksum;
+}
+
+/**
+ * Tokenizer with bulk copies between structural characters located by csv_scanner.
+ */
+size_t tokenize_scanner( const std::string& data, size_t& fields )
+{
+  csv_scanner  unquoted;
+  csv_scanner  quoted;
+  csv_data_t   field;
+  size_t       checksum  = 0;
+  bool         quoteOpen = false;
+
+  unquoted.insert( ",\n\"" );
+  unquoted.insert( "\a\b\t\v\f\r\n" );
+  quoted.insert( "\n\"" );
+
+  const char* pFirst = data.data();
+  const char* pLast  = data.data() + data.size();
+
+  while ( pFirst < pLast )
+  {
+    const char* pNext = (quoteOpen?quoted:unquoted).find( pFirst, pLast );
+    field.append( pFirst, static_cast<size_t>(pNext-pFirst) );
+    if ( pNext == pLast )
+      break;
+
+    const char ch = *pNext;
+    pFirst = pNext + 1;
+
+    if ( ((ch == ',') && (quoteOpen == false)) || (ch == '\n') ) {
+      checksum += field.length(); ++fields;
+      field.clear(); quoteOpen = false;
+    } else if ( ch == '\"' ) {
+      if ( field.empty() && !quoteOpen )        quoteOpen = true;
+      else if ( !field.empty() && quoteOpen )   quoteOpen = false;
+      field.push_back( ch );
+    } else if ( quoteOpen ) {
+      field.push_back( ch );
+    }
+  }
+
+  return checksum;
+}
+
+int main( int argc, char* argv[] )
+{
+  const size_t     _nSize  = ((argc > 1)?std::strtoul(argv[1],nullptr,10):256) * to_bytes<1>::MBytes;
+  const csv_scanner::isa_t isas[] = { csv_scanner::isa_t::scalar, csv_scanner::isa_t::sse42,
+                                      csv_scanner::isa_t::avx2,   csv_scanner::isa_t::avx512 };
+  const csv_scanner::isa_t _isaDefault = csv_scanner::get_isa();
+
+  cout << "Generating " << (_nSize / to_bytes<1>::MBytes) << " MB data set" << endl;
+  const std::string data = make_dataset( _nSize );
+
+  cout << "----------------------------------------------" << endl;
+  cout << "-----------------TOKENIZER--------------------" << endl;
+  {
+    size_t fields   = 0;
+    auto   ts       = chrono::steady_clock::now();
+    size_t checksum = tokenize_per_byte( data, fields );
+    auto   te       = chrono::steady_clock::now();
+    print_throughput( "per byte (previous loop)", ts, te, data.size() );
+
+    for ( auto isa : isas )
+    {
+      if ( csv_scanner::set_isa( isa ) == false )
+        continue;
+
+      size_t _fields = 0;
+      ts = chrono::steady_clock::now();
+      size_t _checksum = tokenize_scanner( data, _fields );
+      te = chrono::steady_clock::now();
+      print_throughput( csv_scanner::isa_name(isa), ts, te, data.size() );
+
+      if ( (_fields != fields) || (_checksum != checksum) )
+        cout << "  MISMATCH fields " << _fields << "/" << fields << " bytes " << _checksum << "/" << checksum << endl;
+    }
+  }
+
+  cout << "----------------------------------------------" << endl;
+  cout << "-----------------CSV_READER-------------------" << endl;
+  {
+    const std::string filename = "csv_scanner_benchmark.csv";
+    FILE* pFile = fopen( filename.c_str(), "w" );
+    if ( pFile == nullptr )
+      return 1;
+    fwrite( data.data(), 1, data.size(), pFile );
+    fclose( pFile );
+
+    for ( auto isa : isas )
+    {
+      if ( csv_scanner::set_isa( isa ) == false )
+        continue;
+
+      unique_ptr<csv_dev_file_options> optInput = std::make_unique<csv_dev_file_options>( filename,
+                                                                                          csv_dev_file_options::openmode::read,
+                                                                                          to_bytes<8>::MBytes );
+      unique_ptr<csv_dev_file>         devInput = std::make_unique<csv_dev_file>( std::move(optInput),nullptr);
+      csv_reader                       reader( "csv reader", std::move(devInput), nullptr );
+      csv_row                          row;
+
+      auto ts = chrono::steady_clock::now();
+      reader.open();
+      while ( reader.read( row ) )
+      {}
+      reader.close();
+      auto te = chrono::steady_clock::now();
+
+      print_throughput( csv_scanner::isa_name(isa), ts, te, data.size() );
+    }
+
+    csv_scanner::set_isa( _isaDefault );
+    {
+      unique_ptr<csv_dev_file_options> optInput = std::make_unique<csv_dev_file_options>( filename,
+                                                                                          csv_dev_file_options::openmode::read,
+                                                                                          to_bytes<8>::MBytes );
+      unique_ptr<csv_dev_file>         devInput = std::make_unique<csv_dev_file>( std::move(optInput),nullptr);
+      csv_reader                       reader( "csv reader", std::move(devInput), nullptr );
+      csv_row_view                     row;
+
+      auto ts = chrono::steady_clock::now();
+      reader.open();
+      while ( reader.read( row ) )
+      {}
+      reader.close();
+      auto te = chrono::steady_clock::now();
+
+      print_throughput( "csv_row_view", ts, te, data.size() );
+    }
+
+    {
+      unique_ptr<csv_dev_file_options> optInput = std::make_unique<csv_dev_file_options>( filename,
+                                                                                          csv_dev_file_options::openmode::read,
+                                                                                          to_bytes<8>::MBytes );
+      unique_ptr<csv_dev_file>         devInput = std::make_unique<csv_dev_file>( std::move(optInput),nullptr);
+      csv_reader                       reader( "csv reader", std::move(devInput), nullptr );
+      csv_row_batch                    batch;
+
+      auto ts = chrono::steady_clock::now();
+      reader.open();
+      while ( reader.read_batch( batch, 1024 ) )
+      {}
+      reader.close();
+      auto te = chrono::steady_clock::now();
+
+      print_throughput( "read_batch (1024 rows)", ts, te, data.size() );
+    }
+
+    {
+      unique_ptr<csv_dev_file_options> optInput = std::make_unique<csv_dev_file_options>( filename,
+                                                                                          csv_dev_file_options::openmode::read,
+                                                                                          to_bytes<8>::MBytes );
+      unique_ptr<csv_dev_file>         devInput = std::make_unique<csv_dev_file>( std::move(optInput),nullptr);
+      csv_reader                       reader( "csv reader", std::move(devInput), nullptr );
+      csv_column_batch                 batch;
+
+      auto ts = chrono::steady_clock::now();
+      reader.open();
+      while ( reader.read_batch( batch, 1024 ) )
+      {}
+      reader.close();
+      auto te = chrono::steady_clock::now();
+
+      print_throughput( "column_batch (1024 rows)", ts, te, data.size() );
+    }
+
+    remove( filename.c_str() );
+  }
+
+  csv_scanner::set_isa( _isaDefault );
+
+  return 0;
+}
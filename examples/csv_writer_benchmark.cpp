@@ -0,0 +1,145 @@
+#include "csv_dev_file.h"
+#include "csv_writer.h"
+#include <iostream>
+#include <iomanip>    // needed by setprecision
+#include <chrono>
+#include <memory>
+#include <random>
+#include <cstdio>
+#include <cstdlib>
+
+
+
+using namespace std;
+using namespace csv;
+typedef chrono::steady_clock::time_point tp;
+
+/**
+ * Output device discarding data, it only count calls to send().
+ */
+class csv_dev_null : public csv_device
+{
+public:
+  csv_dev_null()
+    : csv_device( "csv_dev_null", nullptr, nullptr ), m_nSends(0)
+  {}
+
+  virtual csv_result open() noexcept override
+  { return csv_result::_ok; }
+  virtual csv_result send( [[maybe_unused]] const csv::byte* pBuffer, csv_uint_t nBufferLen ) noexcept override
+  { ++m_nSends; m_devStats.tx += nBufferLen; return csv_result::_ok; }
+  virtual csv_result recv( [[maybe_unused]] csv::byte* pBuffer, csv_uint_t& nBufferLen ) noexcept override
+  { nBufferLen = 0; return csv_result::_wrong_call; }
+  virtual csv_result close() noexcept override
+  { return csv_result::_ok; }
+  virtual csv_result is_valid() const noexcept override
+  { return csv_result::_ok; }
+
+  size_t    m_nSends;
+};
+
+void print_throughput( const char* label, tp ts, tp te, size_t bytes, size_t rows, size_t sends )
+{
+  std::chrono::duration<double> duration =  (te - ts);
+  cout << setprecision(4) << "  " << left << setw(28) << label
+       << duration.count() << "s  " << (static_cast<double>(bytes) / duration.count() / static_cast<double>(to_bytes<1>::GBytes)) << " GB/s";
+  if ( sends > 0 )
+    cout << "  " << (static_cast<double>(sends) / static_cast<double>(rows)) << " send() for each row";
+  cout << endl;
+}
+
+/**
+ * Synthetic rows with @param columns fields, mostly numeric, some of them quoted and 
+ * some unquoted text where one out of 16 contains delimiter and quotes to be escaped.
+ */
+void make_dataset( size_t columns, size_t rows, csv_header& header, std::vector<csv_row>& data )
+{
+  std::mt19937_64  rnd( 42 );
+  csv_row          labels;
+
+  for ( size_t col = 0; col < columns; ++col )
+  {
+    const std::string label = "column_" + std::to_string(col);
+    labels.push_back( csv_field_t( csv_data_t( label.data(), label.length() ), false ) );
+  }
+  header.init( std::move(labels) );
+
+  data.resize( rows );
+  for ( csv_row& row : data )
+  {
+    for ( size_t col = 0; col < columns; ++col )
+    {
+      std::string value;
+      if ( col % 8 == 7 )
+        value = "note " + std::to_string(rnd()%1000);
+      else if ( col % 8 == 3 )
+        value = "description of item " + std::to_string(rnd()%100000) + ((rnd()%16)?" in stock":", the \"best\" one");
+      else
+        value = std::to_string(rnd()%1000000);
+      row.push_back( csv_field_t( csv_data_t( value.data(), value.length() ), (col % 8 == 7) ) );
+    }
+  }
+}
+
+int main( int argc, char* argv[] )
+{
+  const size_t      _nRows    = (argc > 1)?std::strtoul(argv[1],nullptr,10):100000;
+  const size_t      _nColumns = (argc > 2)?std::strtoul(argv[2],nullptr,10):80;
+  const std::string filename  = "csv_writer_benchmark.csv";
+
+  csv_header            header;
+  std::vector<csv_row>  data;
+
+  cout << "Generating " << _nRows << " rows with " << _nColumns << " columns" << endl;
+  make_dataset( _nColumns, _nRows, header, data );
+
+  const csv_uint_t buffers[] = { 0, to_bytes<4>::KBytes, to_bytes<64>::KBytes, to_bytes<1>::MBytes };
+  size_t           bytes     = 0;
+
+  cout << "----------------------------------------------" << endl;
+  cout << "-----------------NULL DEVICE------------------" << endl;
+  for ( csv_uint_t nBufferSize : buffers )
+  {
+    unique_ptr<csv_dev_null> devOutput = std::make_unique<csv_dev_null>();
+    csv_dev_null*            pDevice   = devOutput.get();
+    csv_writer               writer( "csv writer", std::move(devOutput), nullptr, nBufferSize );
+    csv_dev_stats            stats;
+
+    auto ts = chrono::steady_clock::now();
+    writer.open( header );
+    for ( const csv_row& row : data )
+      writer.write( header, row );
+    writer.flush();
+    auto te = chrono::steady_clock::now();
+
+    pDevice->get_stats( stats );
+    bytes = stats.tx;
+
+    const std::string label = "buffer " + std::to_string(nBufferSize / to_bytes<1>::KBytes) + " KB";
+    print_throughput( label.c_str(), ts, te, bytes, _nRows + 1, pDevice->m_nSends );
+    writer.close();
+  }
+
+  cout << "----------------------------------------------" << endl;
+  cout << "-----------------FILE DEVICE------------------" << endl;
+  for ( csv_uint_t nBufferSize : buffers )
+  {
+    unique_ptr<csv_dev_file_options> optOutput = std::make_unique<csv_dev_file_options>( filename, csv_dev_file_options::openmode::write );
+    unique_ptr<csv_dev_file>         devOutput = std::make_unique<csv_dev_file>( std::move(optOutput),nullptr);
+    csv_writer                       writer( "csv writer", std::move(devOutput), nullptr, nBufferSize );
+
+    auto ts = chrono::steady_clock::now();
+    writer.open( header );
+    for ( const csv_row& row : data )
+      writer.write( header, row );
+    writer.close();
+    auto te = chrono::steady_clock::now();
+
+    const std::string label = "buffer " + std::to_string(nBufferSize / to_bytes<1>::KBytes) + " KB";
+    print_throughput( label.c_str(), ts, te, bytes, _nRows + 1, 0 );
+  }
+
+  remove( filename.c_str() );
+
+  return 0;
+}
@@ -0,0 +1,15 @@
+#ifndef CSV_CONFIG_H
+#define CSV_CONFIG_H
+
+#define CSV_LIB_VERSION_MAJOR           1
+#define CSV_LIB_VERSION_MINOR           2
+#define CSV_LIB_VERSION_PATCH           0
+
+#define CSV_LIB_VERSION   v1_2_0
+
+#define CSV_HAS_IO_URING
+
+#define CSV_HAS_ZLIB
+#define CSV_HAS_ZSTD
+
+#endif //CSV_CONFIG_H
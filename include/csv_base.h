@@ -66,7 +66,7 @@ public:
    *        Default value is comma ','.
    */
   constexpr inline void        set_delimeter( char ch ) noexcept
-  { m_cDelimeter = ch; }
+  { m_cDelimeter = ch; m_bDialectChanged = true; }
   /**
    * @brief Get field delimeter. 
    * 
@@ -80,7 +80,7 @@ public:
    *        Default value is '\"'.
    */
   constexpr inline void        set_quote( char ch ) noexcept
-  { m_cQuote = ch; }
+  { m_cQuote = ch; m_bDialectChanged = true; }
   /**
    * @brief Get quote delimeter. 
    * 
@@ -94,7 +94,7 @@ public:
    *        Default value is '\n'.
    */
   constexpr inline void        set_eol( char ch ) noexcept
-  { m_cEoL = ch; }
+  { m_cEoL = ch; m_bDialectChanged = true; }
 
   /**
    * @brief Get the EoL (End of Line character). 
@@ -109,7 +109,7 @@ public:
    *        Default value is '#' at the beginning of the line.
    */
   constexpr inline void        set_comment( char ch ) noexcept
-  { m_cComment = ch; }
+  { m_cComment = ch; m_bDialectChanged = true; }
 
   /**
    * @brief Get comment marker. 
@@ -211,6 +211,9 @@ protected:
   char                          m_cQuote;
   char                          m_cEoL;
   char                          m_cComment;
+  // Set each time a character with special meaning change, so that 
+  // tables depending on them can be updated before next use.
+  bool                          m_bDialectChanged;
   core::unique_ptr<csv_device>  m_ptrDevice;
   core::unique_ptr<csv_events>  m_ptrEvents;
   mutable csv_header            m_vHeader;
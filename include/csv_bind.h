@@ -0,0 +1,184 @@
+/**************************************************************************************************
+ * 
+ * Copyright 2022 https://github.com/fe-dagostino
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this 
+ * software and associated documentation files (the "Software"), to deal in the Software 
+ * without restriction, including without limitation the rights to use, copy, modify, 
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to 
+ * permit persons to whom the Software is furnished to do so, subject to the following 
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies 
+ * or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE 
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR 
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *************************************************************************************************/
+
+#ifndef CSV_BIND_H
+#define CSV_BIND_H
+
+#include "csv_common.h"
+#include "csv_header.h"
+#include "csv_number.h"
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace csv {
+inline namespace CSV_LIB_VERSION {
+
+/**
+ * @brief csv_bind describe how columns are converted into members of a plain struct @param T,
+ *        so that rows read with csv_reader::read( csv_bind<T>&, T& ) are converted straight 
+ *        from the parser buffer without allocating a csv_row:
+ * 
+ *          csv_bind<trade> bind;
+ *          bind.column<&trade::symbol>("symbol").column<&trade::price>("price");
+ *          while ( reader.read( bind, item ) ) { ... }
+ * 
+ *        Column indexes are resolved once from csv_header, and each member is converted 
+ *        with a function specialized at compile time for its type: numbers with 
+ *        try_parse_number(), bool with try_parse_bool(), std::string and csv_data_t 
+ *        reusing their buffers, std::string_view referring to the parser buffer, that is
+ *        valid until next read as for csv_row_view.
+ */
+template<typename T>
+class csv_bind
+{
+public:
+  using assign_fn_t = bool (*)( T& object, std::string_view value ) noexcept;
+
+  /***/
+  csv_bind() noexcept
+    : m_vColumns(), m_bResolved( false ), m_nErrors( 0 )
+  {}
+
+  /**
+   * @brief Bind column @param label to member @param member of T.
+   */
+  template<auto member>
+    requires std::is_member_object_pointer_v<decltype(member)>
+  inline csv_bind&                  column( const std::string& label ) noexcept
+  {
+    m_vColumns.emplace_back( column_t{ label, &assign<member>, -1 } );
+    m_bResolved = false;
+    return *this;
+  }
+
+  /**
+   * @brief Resolve column indexes with @param header.
+   * @return false if at least one label is not part of the header, such 
+   *         columns are reported as errors by assign().
+   */
+  inline bool                       resolve( const csv_header& header ) noexcept
+  {
+    bool _bFound = true;
+
+    for ( auto& col : m_vColumns )
+    {
+      col.index = header.get_index( csv_data_t( col.label.c_str(), col.label.length() ) );
+      _bFound  &= (col.index >= 0);
+    }
+
+    m_bResolved = true;
+    return _bFound;
+  }
+
+  /***/
+  constexpr inline bool             resolved() const noexcept
+  { return m_bResolved; }
+
+  /**
+   * @brief Force a new resolve(), for instance when reading a file with a different header.
+   */
+  constexpr inline void             reset() noexcept
+  { m_bResolved = false; }
+
+  /**
+   * @brief Convert fields from @param row, a csv_row_view or a csv_row, into @param object.
+   *        Members with a missing or invalid field are not modified.
+   * @return false if at least one field has not been converted, see errors().
+   */
+  template<typename row_t>
+  inline bool                       assign( const row_t& row, T& object ) noexcept
+  {
+    m_nErrors = 0;
+
+    for ( const auto& col : m_vColumns )
+    {
+      if ( (col.index < 0) || (static_cast<std::size_t>(col.index) >= row.size()) || 
+           (col.pfnAssign( object, static_cast<std::string_view>(row.get_field( static_cast<std::size_t>(col.index) ).data()) ) == false) )
+        ++m_nErrors;
+    }
+
+    return (m_nErrors == 0);
+  }
+
+  /**
+   * @brief Number of fields not converted by last call to assign().
+   */
+  constexpr inline std::size_t      errors() const noexcept
+  { return m_nErrors; }
+
+  /***/
+  inline std::size_t                size() const noexcept
+  { return m_vColumns.size(); }
+
+private:
+  /**
+   * @brief Conversion for member @param member, selected at compile time from its type.
+   */
+  template<auto member>
+  static bool                       assign( T& object, std::string_view value ) noexcept
+  {
+    using member_t = std::remove_cvref_t<decltype(object.*member)>;
+
+    if constexpr ( std::is_same_v<member_t,bool> )
+    {
+      return try_parse_bool( value.data(), value.length(), object.*member );
+    }
+    else if constexpr ( Number_t<member_t> )
+    {
+      return try_parse_number( value.data(), value.length(), object.*member );
+    }
+    else if constexpr ( std::is_same_v<member_t,std::string> || std::is_same_v<member_t,csv_data_t> )
+    {
+      (object.*member).assign( value.data(), value.length() );
+      return true;
+    }
+    else if constexpr ( std::is_same_v<member_t,std::string_view> )
+    {
+      object.*member = value;
+      return true;
+    }
+    else
+    {
+      static_assert( std::is_same_v<member_t,std::string_view>, "csv_bind: member type not supported" );
+      return false;
+    }
+  }
+
+private:
+  struct column_t {
+    std::string     label;
+    assign_fn_t     pfnAssign;
+    int32_t         index;
+  };
+
+  std::vector<column_t>   m_vColumns;
+  bool                    m_bResolved;
+  std::size_t             m_nErrors;
+};
+
+} //inline namespace
+} // namespace
+
+#endif //CSV_BIND_H
@@ -0,0 +1,202 @@
+/**************************************************************************************************
+ * 
+ * Copyright 2022 https://github.com/fe-dagostino
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this 
+ * software and associated documentation files (the "Software"), to deal in the Software 
+ * without restriction, including without limitation the rights to use, copy, modify, 
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to 
+ * permit persons to whom the Software is furnished to do so, subject to the following 
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies 
+ * or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE 
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR 
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *************************************************************************************************/
+
+#ifndef CSV_COLUMN_BATCH_H
+#define CSV_COLUMN_BATCH_H
+
+#include "csv_common.h"
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+namespace csv {
+inline namespace CSV_LIB_VERSION {
+
+/**
+ * @brief csv_column_batch is a block of rows stored column by column, where 
+ *        each column keep data for all its fields in a single buffer, with 
+ *        offsets and a bitmap for quoted fields.
+ *        Filled by csv_reader::read_batch(), buffers are kept when the batch is 
+ *        cleared so that they are reused from one read to the next one.
+ */
+class csv_column_batch
+{
+public:
+  /***/
+  class column
+  {
+  public:
+    /***/
+    column() noexcept
+      : m_vData(), m_nDataSize(0), m_vOffsets(1,0), m_vQuoted()
+    {}
+
+    /**
+     * @brief Number of fields in the column.
+     */
+    inline std::size_t                      size() const noexcept
+    { return m_vOffsets.size()-1; }
+
+    /**
+     * @brief Field at @param row, valid until the batch is cleared.
+     */
+    inline std::string_view                 get( std::size_t row ) const noexcept
+    { return std::string_view( m_vData.data()+m_vOffsets[row], m_vOffsets[row+1]-m_vOffsets[row] ); }
+    /***/
+    inline bool                             hasquotes( std::size_t row ) const noexcept
+    { return ((m_vQuoted[row/64] >> (row%64)) & 1); }
+
+    /**
+     * @brief Data for all fields, one after the other.
+     */
+    inline const char*                      data() const noexcept
+    { return m_vData.data(); }
+    /**
+     * @brief Field at row n start at offsets()[n] and end at offsets()[n+1].
+     */
+    inline const std::vector<std::size_t>&  offsets() const noexcept
+    { return m_vOffsets; }
+    /**
+     * @brief Bit n set when field at row n had quotes.
+     */
+    inline const std::vector<uint64_t>&     quoted() const noexcept
+    { return m_vQuoted; }
+
+    /***/
+    inline void                             clear() noexcept
+    { 
+      m_nDataSize = 0;
+      m_vOffsets.resize(1);
+      m_vQuoted.clear();
+    }
+
+    /***/
+    inline void                             append( const char* pData, std::size_t length, bool quoted ) noexcept
+    {
+      const std::size_t _nRow = size();
+
+      // Buffer size is managed here, so that it grow only when needed and 
+      // without initializing data that will be overwritten.
+      if ( m_nDataSize + length > m_vData.size() )
+        m_vData.resize( std::max( 2*m_vData.size(), m_nDataSize + length ) );
+
+      if ( length > 0 )
+        std::memcpy( m_vData.data()+m_nDataSize, pData, length );
+      m_nDataSize += length;
+      m_vOffsets.push_back( m_nDataSize );
+
+      if ( (_nRow % 64) == 0 )
+        m_vQuoted.push_back( 0 );
+      if ( quoted )
+        m_vQuoted.back() |= (uint64_t(1) << (_nRow % 64));
+    }
+
+  private:
+    std::vector<char>         m_vData;
+    std::size_t               m_nDataSize;
+    std::vector<std::size_t>  m_vOffsets;
+    std::vector<uint64_t>     m_vQuoted;
+  };
+
+public:
+  /***/
+  csv_column_batch() noexcept
+    : m_vColumns(), m_nColumns(0), m_nRows(0), m_nRowFields(0)
+  {}
+
+  /**
+   * @brief Number of rows in the batch.
+   */
+  constexpr inline std::size_t  size() const noexcept
+  { return m_nRows; }
+  /***/
+  constexpr inline bool         empty() const noexcept
+  { return (m_nRows == 0); }
+  /**
+   * @brief Number of columns, that is the number of fields in the largest row 
+   *        of the batch.
+   */
+  constexpr inline std::size_t  columns() const noexcept
+  { return m_nColumns; }
+
+  /***/
+  inline const column&          get_column( std::size_t index ) const noexcept
+  { return m_vColumns[index]; }
+  /***/
+  inline std::string_view       get( std::size_t row, std::size_t col ) const noexcept
+  { return m_vColumns[col].get( row ); }
+
+  /**
+   * @brief Remove all rows and columns from the batch, buffers of the columns 
+   *        are kept and reused by next rows.
+   */
+  inline void                   clear() noexcept
+  { 
+    for ( std::size_t col = 0; col < m_nColumns; ++col )
+      m_vColumns[col].clear();
+    m_nColumns = m_nRows = m_nRowFields = 0; 
+  }
+
+  /**
+   * @brief Append a field to the current row, when the row is larger than 
+   *        previous ones a new column is added with empty fields for them.
+   */
+  inline void                   append( const char* pData, std::size_t length, bool quoted ) noexcept
+  {
+    if ( m_nRowFields == m_nColumns )
+    {
+      if ( m_nColumns == m_vColumns.size() )
+        m_vColumns.emplace_back();
+      for ( std::size_t row = 0; row < m_nRows; ++row )
+        m_vColumns[m_nColumns].append( nullptr, 0, false );
+      ++m_nColumns;
+    }
+
+    m_vColumns[m_nRowFields++].append( pData, length, quoted );
+  }
+
+  /**
+   * @brief Complete current row, columns without a field in this row get an 
+   *        empty one.
+   */
+  inline void                   end_row() noexcept
+  {
+    for ( ; m_nRowFields < m_nColumns; ++m_nRowFields )
+      m_vColumns[m_nRowFields].append( nullptr, 0, false );
+
+    ++m_nRows;
+    m_nRowFields = 0;
+  }
+
+private:
+  std::vector<column>    m_vColumns;
+  std::size_t            m_nColumns;
+  std::size_t            m_nRows;
+  std::size_t            m_nRowFields;
+};
+
+} //inline namespace
+} // namespace
+
+#endif //CSV_COLUMN_BATCH_H
@@ -66,6 +66,7 @@ enum class csv_result : uint16_t {
   _conn_timeout    = 0x000B,
   _bom_mismatch    = 0x000C,
   _row_items_error = 0x000D,    // Number of items in the row do not match the number of expected columns as for header.
+  _unknown_label   = 0x000E,    // A predicate refers to a label not present in the header.
 
   _wrong_protocol  = 0x2001,
   _missing_soh,
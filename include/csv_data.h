@@ -25,6 +25,8 @@
 #define CSV_DATA_H
 
 #include "csv_common.h"
+#include "csv_number.h"
+#include <cctype>
 #include <cstring>
 
 namespace csv {
@@ -293,6 +295,44 @@ public:
     m_pData[m_nLength++] = value;
   }
 
+  /**
+   * Append @param length data_t from @param buffer.
+   */
+  constexpr inline void append( const_pointer buffer, size_type length ) noexcept
+  {
+    if ( length == 0 )
+      return;
+
+    if (m_nLength+length >= max_size()) {
+      // Keep the buffer size multiple of chunk_size
+      resize( ((m_nLength+length)/chunk_size + 1) * chunk_size );
+      if ( m_pData == nullptr )
+        return;
+    }
+
+    std::memcpy( &m_pData[m_nLength], buffer, length*data_type_size );
+    m_nLength += length;
+    std::memset( &m_pData[m_nLength], '\0', data_type_size );
+  }
+
+  /**
+   * Replace current content with @param length data_t from @param buffer, 
+   * memory is reallocated only if current capacity is not enough.
+   */
+  constexpr inline void assign( const_pointer buffer, size_type length ) noexcept
+  {
+    if ( length >= max_size() ) {
+      resize( length+1 );
+      if ( m_pData == nullptr )
+        return;
+    }
+
+    if ( length > 0 )
+      std::memcpy( m_pData, buffer, length*data_type_size );
+    m_nLength = length;
+    std::memset( &m_pData[m_nLength], '\0', data_type_size );
+  }
+
   /**
    *  @brief  Remove the last data_t if the buffer contain at least 
    *          one data_t.
@@ -314,17 +354,39 @@ public:
   { return data(); }
 
 
-  /***/
+  /**
+   * @brief Convert the content to a number, as std::stol() characters after the 
+   *        number are ignored. Return 0 if there is no valid number.
+   */
   constexpr inline long           to_long() const noexcept
-  { return std::stol( m_pData ); }
+  { return to_number<long>(); }
 
   /***/
   constexpr inline unsigned long  to_ulong() const noexcept
-  { return std::stoul( m_pData ); }
+  { return to_number<unsigned long>(); }
 
   /***/
   constexpr inline double         to_double() const noexcept
-  { return std::stod( m_pData ); }
+  { return to_number<double>(); }
+
+  /**
+   * @brief Convert the whole content to @param number_t, see parse_number().
+   * @return false if the content is not a valid number, then @param value is not modified.
+   */
+  template<Number_t number_t>
+  constexpr inline bool           try_as( number_t& value ) const noexcept
+  { return try_parse_number( m_pData, m_nLength, value ); }
+
+  /**
+   * @brief Same as try_as() returning @param defvalue on error.
+   */
+  template<Number_t number_t>
+  constexpr inline number_t       as( number_t defvalue = number_t() ) const noexcept
+  { 
+    number_t _value = defvalue;
+    try_as( _value );
+    return _value;
+  }
 
   /***/
   constexpr inline explicit operator std::string_view() const noexcept
@@ -332,15 +394,15 @@ public:
 
   /***/
   constexpr inline explicit operator long() noexcept
-  { return std::stol( m_pData ); }
+  { return to_long(); }
 
   /***/
   constexpr inline explicit operator unsigned long() noexcept
-  { return std::stoul( m_pData ); }
+  { return to_ulong(); }
 
   /***/
   constexpr inline explicit operator double() noexcept
-  { return std::stod( m_pData ); }
+  { return to_double(); }
 
   /**
    *  @brief  Return const pointer to contents.
@@ -427,6 +489,22 @@ public:
   { return data()[index]; }
 
 private:
+  /***/
+  template<Number_t number_t>
+  constexpr inline number_t       to_number() const noexcept
+  {
+    const_pointer pFirst = m_pData;
+    size_type     length = m_nLength;
+    number_t      _value = 0;
+
+    // As for std::stol() leading whitespaces are ignored.
+    while ( (length > 0) && std::isspace( static_cast<unsigned char>(*pFirst) ) )
+    { ++pFirst; --length; }
+
+    parse_number( pFirst, length, _value );
+    return _value;
+  }
+
   /***/
   constexpr inline void copy( const_pointer buffer, size_type length ) noexcept
   {
@@ -0,0 +1,155 @@
+/**************************************************************************************************
+ * 
+ * Copyright 2022 https://github.com/fe-dagostino
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this 
+ * software and associated documentation files (the "Software"), to deal in the Software 
+ * without restriction, including without limitation the rights to use, copy, modify, 
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to 
+ * permit persons to whom the Software is furnished to do so, subject to the following 
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies 
+ * or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE 
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR 
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *************************************************************************************************/
+
+#ifndef CSV_DFA_H
+#define CSV_DFA_H
+
+#include "csv_common.h"
+#include <array>
+#include <string_view>
+
+namespace csv {
+inline namespace CSV_LIB_VERSION {
+
+/**
+ * @brief csv_dfa is the state machine used by csv_parser for each character with 
+ *        special meaning. A table with 256 entries map each character to its class, 
+ *        that is the set of roles (delimiter, eol, quote, comment, whitespace) for
+ *        the character, then a transition table provide for each state and class 
+ *        the next state and the actions to be done.
+ *        Tables are built once for each dialect, so comments and whitespaces are
+ *        part of the classes only when enabled.
+ */
+class csv_dfa
+{
+public:
+  // States
+  static constexpr uint8_t  start      = 0x00;  // field is empty and quotes are closed
+  static constexpr uint8_t  data       = 0x01;  // field is not empty and quotes are closed
+  static constexpr uint8_t  quoted     = 0x02;  // quotes are open
+  static constexpr uint8_t  skip       = 0x03;  // comment, all characters are skipped until eol
+
+  // Actions, together with the next state in state_mask bits
+  static constexpr uint8_t  state_mask = 0x03;
+  static constexpr uint8_t  push       = 0x04;  // character is added to the field
+  static constexpr uint8_t  add_field  = 0x08;  // field is complete
+  static constexpr uint8_t  end_row    = 0x10;  // row is complete
+
+  /***/
+  constexpr csv_dfa() noexcept
+    : m_classes{}, m_transitions{}
+  {}
+
+  /***/
+  constexpr csv_dfa( char delimiter, char quote, char eol, char comment, bool allow_comments, 
+                     std::string_view whitespaces, bool skip_whitespaces ) noexcept
+    : csv_dfa()
+  { build( delimiter, quote, eol, comment, allow_comments, whitespaces, skip_whitespaces ); }
+
+  /**
+   * @brief Build class and transition tables for specified dialect.
+   */
+  constexpr void              build( char delimiter, char quote, char eol, char comment, bool allow_comments, 
+                                     std::string_view whitespaces, bool skip_whitespaces ) noexcept
+  {
+    m_classes.fill( 0 );
+
+    if ( skip_whitespaces )
+    {
+      for ( char ch : whitespaces )
+        m_classes[static_cast<uint8_t>(ch)] |= is_whitespace;
+    }
+    if ( allow_comments )
+      m_classes[static_cast<uint8_t>(comment)] |= is_comment;
+    m_classes[static_cast<uint8_t>(quote)]     |= is_quote;
+    m_classes[static_cast<uint8_t>(eol)]       |= is_eol;
+    m_classes[static_cast<uint8_t>(delimiter)] |= is_delimiter;
+
+    for ( uint8_t state = start; state <= skip; ++state )
+      for ( uint8_t cls = 0; cls < classes; ++cls )
+        m_transitions[state*classes + cls] = transition( state, cls );
+  }
+
+  /**
+   * @brief Retrieve next state and actions for character @param ch in @param state.
+   */
+  constexpr inline uint8_t    next( uint8_t state, char ch ) const noexcept
+  { return m_transitions[state*classes + m_classes[static_cast<uint8_t>(ch)]]; }
+
+private:
+  // Roles for a character, a class is a combination of them
+  static constexpr uint8_t  is_delimiter  = 0x01;
+  static constexpr uint8_t  is_eol        = 0x02;
+  static constexpr uint8_t  is_quote      = 0x04;
+  static constexpr uint8_t  is_comment    = 0x08;
+  static constexpr uint8_t  is_whitespace = 0x10;
+  static constexpr uint8_t  classes       = 0x20;
+
+  /**
+   * Rules applied to each character, where a character can have more roles. 
+   */
+  static constexpr uint8_t    transition( uint8_t state, uint8_t cls ) noexcept
+  {
+    const bool  _bFieldEmpty = (state == start);
+    bool        _bQuoteOpen  = (state == quoted);
+
+    if ( state == skip )
+    {
+      // Skip all until eol, field remain empty since comment start only with an empty field.
+      return (cls & is_eol)?start:skip;
+    }
+    
+    // A comment cannot be beween fields
+    if ( (cls & is_comment) && _bFieldEmpty )
+      return skip;
+
+    if ( (cls & is_delimiter) && (_bQuoteOpen == false) )
+      return static_cast<uint8_t>(start | add_field);
+
+    if ( cls & is_eol )
+      return static_cast<uint8_t>(start | add_field | end_row);
+
+    if ( cls & is_quote )
+    {
+      if ( _bFieldEmpty && (_bQuoteOpen == false) )
+      { _bQuoteOpen = true; }
+      else if ( (_bFieldEmpty == false) && (_bQuoteOpen == true) )
+      { _bQuoteOpen = false; }        
+    }
+
+    // Whitespaces are class members only when they should be skipped.
+    if ( _bQuoteOpen || ((cls & is_whitespace) == 0) )
+      return static_cast<uint8_t>((_bQuoteOpen?quoted:data) | push);
+
+    return (_bFieldEmpty?start:data);
+  }
+
+private:
+  std::array<uint8_t,256>             m_classes;
+  std::array<uint8_t,4*classes>       m_transitions;
+};
+
+} //inline namespace
+} // namespace
+
+#endif //CSV_DFA_H
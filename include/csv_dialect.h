@@ -0,0 +1,170 @@
+/**************************************************************************************************
+ * 
+ * Copyright 2022 https://github.com/fe-dagostino
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this 
+ * software and associated documentation files (the "Software"), to deal in the Software 
+ * without restriction, including without limitation the rights to use, copy, modify, 
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to 
+ * permit persons to whom the Software is furnished to do so, subject to the following 
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies 
+ * or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE 
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR 
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *************************************************************************************************/
+
+#ifndef CSV_DIALECT_H
+#define CSV_DIALECT_H
+
+#include "csv_common.h"
+#include "csv_dfa.h"
+
+#if defined(__SSE2__)
+# include <emmintrin.h>
+#endif
+
+namespace csv {
+inline namespace CSV_LIB_VERSION {
+
+/**
+ * @brief csv_dialect define at compile time characters with special meaning and 
+ *        parsing options, so that csv_reader_t<> can be specialized removing runtime 
+ *        checks for disabled options and comparing characters with constants.
+ *        Default values are the same used by csv_reader, whitespaces are always
+ *        "\a\b\t\v\f\r\n".
+ */
+template<char delimiter_v = ',', char quote_v = '\"', char eol_v = '\n', char comment_v = '#',
+         bool allow_comments_v = false, bool skip_whitespaces_v = true, bool trim_all_v = true>
+struct csv_dialect
+{
+  /***/
+  static constexpr inline char         delimiter() noexcept        { return delimiter_v;        }
+  /***/
+  static constexpr inline char         quote() noexcept            { return quote_v;            }
+  /***/
+  static constexpr inline char         eol() noexcept              { return eol_v;              }
+  /***/
+  static constexpr inline char         comment() noexcept          { return comment_v;          }
+  /***/
+  static constexpr inline bool         allow_comments() noexcept   { return allow_comments_v;   }
+  /***/
+  static constexpr inline bool         skip_whitespaces() noexcept { return skip_whitespaces_v; }
+  /***/
+  static constexpr inline bool         trim_all() noexcept         { return trim_all_v;         }
+
+  /***/
+  static constexpr inline const char*  whitespaces() noexcept
+  { return "\a\b\t\v\f\r\n"; }
+
+  /***/
+  static constexpr inline bool         is_whitespace( char ch ) noexcept
+  { return (ch >= '\a') && (ch <= '\r'); }
+
+  /**
+   * @brief Search next character to be processed when quotes are not open, 
+   *        that is delimiter, eol, quote and if enabled comment and whitespaces.
+   * @return pointer to the character or @param pLast if not found.
+   */
+  static inline const char*            find_unquoted( const char* pFirst, const char* pLast ) noexcept
+  { return find<true>( pFirst, pLast ); }
+
+  /**
+   * @brief Search next character to be processed when quotes are open, 
+   *        that is eol or quote.
+   * @return pointer to the character or @param pLast if not found.
+   */
+  static inline const char*            find_quoted( const char* pFirst, const char* pLast ) noexcept
+  { return find<false>( pFirst, pLast ); }
+
+  /**
+   * @brief Next state and actions for character @param ch, see csv_dfa.
+   *        Tables are built at compile time.
+   */
+  static constexpr inline uint8_t      next( uint8_t state, char ch ) noexcept
+  { return s_dfa.next( state, ch ); }
+
+private:
+  static constexpr csv_dfa             s_dfa{ delimiter_v, quote_v, eol_v, comment_v, allow_comments_v, 
+                                              whitespaces(), skip_whitespaces_v };
+
+  /***/
+  template<bool unquoted>
+  static constexpr inline bool         is_special( char ch ) noexcept
+  { 
+    if ( (ch == eol_v) || (ch == quote_v) )
+      return true;
+
+    if constexpr ( unquoted )
+      return (ch == delimiter_v) || (allow_comments_v && (ch == comment_v)) || (skip_whitespaces_v && is_whitespace(ch));
+
+    return false;
+  }
+
+  /**
+   * Characters are compared with constants, 16 at time when SSE2 is available, 
+   * without any call through csv_scanner.
+   */
+  template<bool unquoted>
+  static inline const char*            find( const char* pFirst, const char* pLast ) noexcept
+  {
+#if defined(__SSE2__)
+    while ( (pLast - pFirst) >= 16 )
+    {
+      const __m128i _block = _mm_loadu_si128( reinterpret_cast<const __m128i*>(pFirst) );
+      __m128i       _match = _mm_or_si128( _mm_cmpeq_epi8( _block, _mm_set1_epi8( eol_v   ) ), 
+                                           _mm_cmpeq_epi8( _block, _mm_set1_epi8( quote_v ) ) );
+
+      if constexpr ( unquoted )
+      {
+        _match = _mm_or_si128( _match, _mm_cmpeq_epi8( _block, _mm_set1_epi8( delimiter_v ) ) );
+
+        if constexpr ( allow_comments_v )
+          _match = _mm_or_si128( _match, _mm_cmpeq_epi8( _block, _mm_set1_epi8( comment_v ) ) );
+
+        if constexpr ( skip_whitespaces_v )
+        {
+          // Whitespaces are in the range ['\a','\r'], so (ch - '\a') <= ('\r' - '\a') as unsigned.
+          const __m128i _offset = _mm_sub_epi8( _block, _mm_set1_epi8( '\a' ) );
+          _match = _mm_or_si128( _match, _mm_cmpeq_epi8( _mm_min_epu8( _offset, _mm_set1_epi8( '\r' - '\a' ) ), _offset ) );
+        }
+      }
+
+      const int _mask = _mm_movemask_epi8( _match );
+      if ( _mask != 0 )
+        return pFirst + __builtin_ctz( static_cast<unsigned>(_mask) );
+
+      pFirst += 16;
+    }
+#endif
+
+    for ( ; pFirst < pLast; ++pFirst )
+    {
+      if ( is_special<unquoted>( *pFirst ) )
+        return pFirst;
+    }
+
+    return pLast;
+  }
+};
+
+/** RFC4180 with default options. */
+typedef csv_dialect<>                                       csv_dialect_rfc4180;
+/** Tab separated values. */
+typedef csv_dialect<'\t'>                                   csv_dialect_tsv;
+/** Semicolon separated values, common with decimal comma locales. */
+typedef csv_dialect<';'>                                    csv_dialect_ssv;
+/** RFC4180 without whitespaces removal and trimming, data are returned as they are. */
+typedef csv_dialect<',','\"','\n','#',false,false,false>    csv_dialect_raw;
+
+} //inline namespace
+} // namespace
+
+#endif //CSV_DIALECT_H
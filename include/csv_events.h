@@ -26,6 +26,7 @@
 
 #include "csv_common.h"
 #include "csv_header.h"
+#include <span>
 
 namespace csv {
 inline namespace CSV_LIB_VERSION {
@@ -66,6 +67,16 @@ public:
    */
   virtual csv_unique_ptr<csv_row> onFilteredRow ( const csv_header& header, csv_unique_ptr<csv_row> row ) = 0;
 
+  /**
+   * @brief Invoked by csv_reader::read_batch() for each block of rows, once 
+   *        filters, if any, have been applied.
+   *        Rows belong to the reader and will be reused with next block, so the
+   *        application can either process them in place or move their content.
+   *        Default implementation ignore the event.
+   */
+  virtual void                    onRows        ( const csv_header& header, std::span<csv_row> rows )
+  { (void)header; (void)rows; }
+
   /**
    * @brief Invoked when reading/writing operation have been completed.
    */
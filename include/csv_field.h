@@ -27,6 +27,7 @@
 #include "csv_common.h"
 #include "csv_data.h"
 #include <vector>
+#include <string_view>
 #include <concepts>
 #include <type_traits>
 
@@ -88,6 +89,26 @@ public:
   constexpr inline operator const string_t&() const noexcept
   { return m_sData; }
 
+  /**
+   * @brief Convert the whole field to @param number_t, without any allocation
+   *        and without requiring a null-terminated string, see parse_number().
+   * @return false if the field is not a valid number, then @param value is not modified.
+   */
+  template<Number_t number_t>
+  constexpr inline bool             try_as( number_t& value ) const noexcept
+  { return try_parse_number( m_sData.data(), m_sData.length(), value ); }
+
+  /**
+   * @brief Same as try_as() returning @param defvalue on error.
+   */
+  template<Number_t number_t>
+  constexpr inline number_t         as( number_t defvalue = number_t() ) const noexcept
+  { 
+    number_t _value = defvalue;
+    try_as( _value );
+    return _value;
+  }
+
 private:
   bool      m_bHasQuote;  
   string_t  m_sData;
@@ -98,6 +119,9 @@ typedef csv_data<char,size_t>         csv_data_t;
 typedef csv_field<csv_data_t>         csv_field_t;
 typedef std::vector<csv_field_t>      csv_row_base_t;
 
+typedef csv_field<std::string_view>   csv_field_view_t;
+typedef std::vector<csv_field_view_t> csv_row_view_base_t;
+
 
 } //inline namespace
 } // namespace
@@ -27,6 +27,7 @@
 #include "csv_common.h"
 #include "csv_row.h"
 #include <unordered_map>
+#include <atomic>
 
 namespace csv {
 inline namespace CSV_LIB_VERSION {
@@ -40,6 +41,7 @@ public:
 
   /***/
   csv_header()
+    : m_nRevision( 0 )
   {}
 
   /**
@@ -126,10 +128,28 @@ public:
   inline field_index_t operator[](const csv_data_t& label)
   { return m_label_2_index[ static_cast<std::string_view>(label) ]; }
 
+  /**
+   * @brief Identifier of current labels, unique in the process and changed by 
+   *        init() and append_label(), so that data computed from the labels can 
+   *        be cached and checked even when a new header takes the same address.
+   *        Copies of the header share the same revision.
+   */
+  constexpr inline uint64_t get_revision() const noexcept
+  { return m_nRevision; }
+
 private:
+  /***/
+  static inline uint64_t _next_revision() noexcept
+  {
+    static std::atomic<uint64_t> s_nRevision( 0 );
+    return ++s_nRevision;
+  }
+
   /***/
   inline void _update_lbl2ndx_map() noexcept
   {
+    m_nRevision = _next_revision();
+
     m_label_2_index.clear();
     for ( size_t ndx = 0; ndx < size(); ++ndx )
     {
@@ -138,6 +158,7 @@ private:
   }
 private:
   field_map_t     m_label_2_index;
+  uint64_t        m_nRevision;
 
 };
 
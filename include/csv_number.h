@@ -0,0 +1,113 @@
+/**************************************************************************************************
+ * 
+ * Copyright 2022 https://github.com/fe-dagostino
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this 
+ * software and associated documentation files (the "Software"), to deal in the Software 
+ * without restriction, including without limitation the rights to use, copy, modify, 
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to 
+ * permit persons to whom the Software is furnished to do so, subject to the following 
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies 
+ * or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE 
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR 
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *************************************************************************************************/
+
+#ifndef CSV_NUMBER_H
+#define CSV_NUMBER_H
+
+#include "csv_common.h"
+#include <charconv>
+#include <concepts>
+#include <string_view>
+#include <type_traits>
+
+namespace csv {
+inline namespace CSV_LIB_VERSION {
+
+/***/
+template<typename T>
+concept Number_t = std::is_arithmetic_v<T> && (std::is_same_v<T,bool> == false);
+
+/**
+ * @brief Convert @param length characters starting at @param pFirst to a number 
+ *        with std::from_chars(), so that data do not need to be null-terminated, 
+ *        locale is not used and no exception is thrown.
+ *        A leading '+' is accepted as for std::stol().
+ * 
+ * @return pointer to the first character not converted, nullptr if there is no 
+ *         number or if it is out of range for @param number_t; on error @param value
+ *         is not modified.
+ */
+template<Number_t number_t>
+inline const char* parse_number( const char* pFirst, std::size_t length, number_t& value ) noexcept
+{
+  const char* pLast = pFirst + length;
+
+  if ( (length > 1) && (*pFirst == '+') && (pFirst[1] != '-') )
+    ++pFirst;
+
+  const std::from_chars_result _res = std::from_chars( pFirst, pLast, value );
+
+  return (_res.ec == std::errc())?_res.ptr:nullptr;
+}
+
+/**
+ * @brief Same as parse_number() but all @param length characters must be part
+ *        of the number.
+ * @return true if @param value has been updated.
+ */
+template<Number_t number_t>
+inline bool        try_parse_number( const char* pFirst, std::size_t length, number_t& value ) noexcept
+{ 
+  number_t    _value = value;
+  const char* pLast  = parse_number( pFirst, length, _value );
+
+  if ( (pLast == nullptr) || (pLast != pFirst + length) )
+    return false;
+
+  value = _value;
+  return true;
+}
+
+/**
+ * @brief Convert @param length characters starting at @param pFirst to a bool, 
+ *        accepting "true" and "false" case insensitive, "1" and "0".
+ *        Same rule is used by csv_bind and by csv_schema::infer().
+ * @return true if @param value has been updated.
+ */
+inline bool        try_parse_bool( const char* pFirst, std::size_t length, bool& value ) noexcept
+{
+  constexpr std::string_view _true  = "true";
+  constexpr std::string_view _false = "false";
+
+  if ( (length == 1) && ((*pFirst == '0') || (*pFirst == '1')) )
+  {
+    value = (*pFirst == '1');
+    return true;
+  }
+
+  const std::string_view& _expected = (length == _true.length())?_true:_false;
+  if ( length != _expected.length() )
+    return false;
+
+  for ( std::size_t ndx = 0; ndx < length; ++ndx )
+    if ( (pFirst[ndx] | 0x20) != _expected[ndx] )
+      return false;
+
+  value = (length == _true.length());
+  return true;
+}
+
+} //inline namespace
+} // namespace
+
+#endif //CSV_NUMBER_H
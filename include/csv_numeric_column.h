@@ -0,0 +1,144 @@
+/**************************************************************************************************
+ * 
+ * Copyright 2022 https://github.com/fe-dagostino
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this 
+ * software and associated documentation files (the "Software"), to deal in the Software 
+ * without restriction, including without limitation the rights to use, copy, modify, 
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to 
+ * permit persons to whom the Software is furnished to do so, subject to the following 
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies 
+ * or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE 
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR 
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *************************************************************************************************/
+
+#ifndef CSV_NUMERIC_COLUMN_H
+#define CSV_NUMERIC_COLUMN_H
+
+#include "csv_common.h"
+#include "csv_number.h"
+#include "csv_header.h"
+#include "csv_row_batch.h"
+#include "csv_column_batch.h"
+#include <vector>
+
+namespace csv {
+inline namespace CSV_LIB_VERSION {
+
+/***/
+template<typename T>
+concept Column_number_t = std::is_same_v<T,int64_t> || std::is_same_v<T,double>;
+
+/**
+ * @brief csv_numeric_column convert all fields of one column at once into a contiguous 
+ *        array of int64_t or double, with a bitmap that flag fields that are not a valid 
+ *        number.
+ *        Fields are checked and converted up to 16 digits per step with SSE4.2, used 
+ *        when csv_scanner select SSE4.2 or a wider instruction set, where digits are 
+ *        validated all together and then combined with multiply-add instructions.
+ *        Each field is loaded with a single 16 bytes read, so up to 15 bytes after the
+ *        field are read and ignored when they are in the same 4 KiB page, otherwise 
+ *        the field is copied; for this reason the load is excluded from AddressSanitizer 
+ *        with no_sanitize_address.
+ *        Longer fields, exponents and special values such as "inf" are converted with 
+ *        try_parse_number(), so that results are always the same of csv_field::try_as().
+ *        Buffers are kept when the column is parsed again so that they are reused from 
+ *        one batch to the next one.
+ */
+template<Column_number_t number_t>
+class csv_numeric_column
+{
+public:
+  /***/
+  csv_numeric_column() noexcept
+    : m_vValues(), m_vErrors(), m_nErrors(0)
+  {}
+
+  /**
+   * @brief Convert field @param column from each row in @param rows. Rows without 
+   *        such field are reported as errors.
+   * @return number of fields that are not a valid number.
+   */
+  std::size_t                           parse( const std::vector<csv_row>& rows, std::size_t column ) noexcept;
+  /***/
+  std::size_t                           parse( const csv_row_batch& batch, std::size_t column ) noexcept;
+  /***/
+  std::size_t                           parse( const csv_column_batch::column& column ) noexcept;
+  /**
+   * @brief Convert column @param column from @param batch, if the column is not present
+   *        all rows are reported as errors.
+   */
+  std::size_t                           parse( const csv_column_batch& batch, std::size_t column ) noexcept;
+
+  /**
+   * @brief Number of values converted with last call to parse().
+   */
+  inline std::size_t                    size() const noexcept
+  { return m_vValues.size(); }
+  /***/
+  inline bool                           empty() const noexcept
+  { return m_vValues.empty(); }
+
+  /**
+   * @brief Converted values, fields with errors are set to zero.
+   */
+  inline const std::vector<number_t>&   values() const noexcept
+  { return m_vValues; }
+  /***/
+  inline const number_t*                data() const noexcept
+  { return m_vValues.data(); }
+  /***/
+  inline number_t                       operator[]( std::size_t index ) const noexcept
+  { return m_vValues[index]; }
+
+  /**
+   * @brief Bitmap with one bit for each value, set if the field is not a valid number.
+   */
+  inline const std::vector<uint64_t>&   errors() const noexcept
+  { return m_vErrors; }
+  /***/
+  inline bool                           error( std::size_t index ) const noexcept
+  { return ((m_vErrors[index/64] >> (index%64)) & 1); }
+  /***/
+  inline std::size_t                    error_count() const noexcept
+  { return m_nErrors; }
+
+  /***/
+  inline void                           clear() noexcept
+  {
+    m_vValues.clear();
+    m_vErrors.clear();
+    m_nErrors = 0;
+  }
+
+private:
+  /**
+   * @brief Resize values and bitmap to @param count elements, keeping their capacity.
+   */
+  void                                  resize( std::size_t count ) noexcept;
+  /***/
+  template<typename source_t>
+  std::size_t                           convert( const source_t& source, std::size_t count ) noexcept;
+
+private:
+  std::vector<number_t>   m_vValues;
+  std::vector<uint64_t>   m_vErrors;
+  std::size_t             m_nErrors;
+};
+
+extern template class csv_numeric_column<int64_t>;
+extern template class csv_numeric_column<double>;
+
+} //inline namespace
+} // namespace
+
+#endif //CSV_NUMERIC_COLUMN_H
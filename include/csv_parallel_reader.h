@@ -0,0 +1,157 @@
+/**************************************************************************************************
+ * 
+ * Copyright 2022 https://github.com/fe-dagostino
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this 
+ * software and associated documentation files (the "Software"), to deal in the Software 
+ * without restriction, including without limitation the rights to use, copy, modify, 
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to 
+ * permit persons to whom the Software is furnished to do so, subject to the following 
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies 
+ * or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE 
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR 
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *************************************************************************************************/
+
+#ifndef CSV_PARALLEL_READER_H
+#define CSV_PARALLEL_READER_H
+
+#include "csv_common.h"
+#include "csv_parser.h"
+#include "csv_dev_mmap.h"
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace csv {
+inline namespace CSV_LIB_VERSION {
+
+/**
+ * @brief csv_parallel_reader split a memory mapped file in ranges of rows that are 
+ *        parsed by a pool of threads, while rows are returned to the caller with 
+ *        read() as for csv_reader. 
+ *        Header, events and filters are processed in the thread calling read(), 
+ *        so csv_events implementations do not require any synchronization.
+ *        Ranges always start at the beginning of a row: since csv_parser terminate 
+ *        rows at each eol, also inside quotes, a range boundary is placed after 
+ *        the first eol following the nominal offset unless such eol terminate a 
+ *        comment, in which case the row continue on next line.
+ */
+class csv_parallel_reader : public csv_parser
+{
+public:
+  /***/
+  enum class order_t : uint8_t {
+    ordered   = 0,        // rows are returned in the same order they have in the file
+    unordered = 1         // rows are returned as soon as their range has been parsed
+  };
+
+  /**
+   * @brief Construct a parallel reader.
+   * 
+   * @param nThreads    number of parsing threads, 0 for std::thread::hardware_concurrency().
+   * @param eOrder      order for rows returned by read().
+   * @param nRangeSize  nominal size in bytes for each range.
+   */
+  csv_parallel_reader( const std::string& feedname, std::unique_ptr<csv_dev_mmap> ptrDevice, core::unique_ptr<csv_events> ptrEvents,
+                       std::size_t nThreads = 0, order_t eOrder = order_t::ordered, csv_uint_t nRangeSize = to_bytes<1>::MBytes );
+
+  /***/
+  virtual ~csv_parallel_reader();
+
+  /**
+   * @brief Map the file, read the header if not already set, split data in 
+   *        ranges and start parsing threads.
+   */
+  bool open();
+
+  /***/
+  bool read();
+  /***/
+  bool read( csv_row& row );
+
+  /***/
+  using csv_parser::apply_filters;
+
+  /**
+   * @brief Stop parsing threads and unmap the file.
+   */
+  bool close();
+
+  /***/
+  constexpr inline order_t      get_order() const noexcept
+  { return m_eOrder; }
+
+  /***/
+  constexpr inline std::size_t  get_threads() const noexcept
+  { return m_nThreads; }
+
+private:
+  struct range_t {
+    csv_uint_t  first;
+    csv_uint_t  last;
+  };
+
+  using rows_t = std::vector<csv_row>;
+
+  /**
+   * @brief Return next row or nullptr when all rows have been returned. 
+   */
+  csv_row*                  next() noexcept;
+  /***/
+  void                      parse_range( std::size_t ndx, rows_t& rows ) noexcept;
+  /***/
+  void                      worker() noexcept;
+  /***/
+  void                      finish() noexcept;
+  /**
+   * @brief Return the offset following the eol that terminate the row containing 
+   *        the line starting at @param offset. 
+   */
+  csv_uint_t                row_end( csv_uint_t offset ) const noexcept;
+  /**
+   * @brief Check if the line [pFirst,pLast) terminate with a comment.
+   */
+  bool                      is_comment( const char* pFirst, const char* pLast ) const noexcept;
+
+private:
+  std::size_t                   m_nThreads;
+  const order_t                 m_eOrder;
+  const csv_uint_t              m_nRangeSize;
+  bool                          m_bOpen;
+  bool                          m_bEnd;
+
+  const char*                   m_pData;
+  csv_uint_t                    m_nLength;
+  std::vector<range_t>          m_vRanges;
+  std::vector<rows_t>           m_vResults;
+  std::vector<bool>             m_vParsed;
+  std::deque<std::size_t>       m_qParsed;
+  std::vector<rows_t>           m_vRecycle;         // ranges returned to the caller to be released
+  std::size_t                   m_nNextRange;       // next range to be parsed
+  std::size_t                   m_nConsumed;        // ranges already returned to the caller
+  std::size_t                   m_nCurrent;         // range currently returned to the caller
+  std::size_t                   m_nCursor;          // next row in current range
+  bool                          m_bStop;
+
+  std::mutex                    m_mtxRanges;
+  std::condition_variable       m_cvWorkers;
+  std::condition_variable       m_cvReader;
+  std::vector<std::thread>      m_vThreads;
+};
+
+} //inline namespace
+} // namespace
+
+#endif //CSV_PARALLEL_READER_H
@@ -29,9 +29,18 @@
 #include "csv_field.h"
 #include "csv_data.h"
 #include "csv_header.h"
+#include "csv_row_view.h"
+#include "csv_row_batch.h"
+#include "csv_column_batch.h"
+#include "csv_scanner.h"
+#include "csv_structural_index.h"
+#include "csv_dfa.h"
+#include "csv_predicate.h"
+#include "csv_row_index.h"
 
 #include <memory>
 #include <functional>
+#include <cstring>
 
 namespace csv {
 inline namespace CSV_LIB_VERSION {
@@ -56,6 +65,21 @@ class csv_parser : public csv_base
     eEnd = 3 
   };
 
+public:
+  /**
+   * @brief Engine used to locate characters with special meaning, both engines
+   *        produce the same rows.
+   *        state_machine      search next character with csv_scanner. 
+   *        structural_index   build bitmaps for each block of data read from the device, 
+   *                           then quotes are resolved with bitwise operations and only 
+   *                           delimiters and eol outside quotes are processed. 
+   *                           Beneficial with many quoted fields.
+   */
+  enum class engine : uint8_t {
+    state_machine    = 0,
+    structural_index = 1
+  };
+
 protected:
   /***/
   csv_parser( const std::string& feedname );
@@ -74,14 +98,14 @@ public:
    * @param whitespaces 
    */
   inline           void               set_whitespaces( const std::string& whitespaces ) noexcept
-  { m_sWhitespaces = whitespaces; }
+  { m_sWhitespaces = whitespaces; m_bDialectChanged = true; }
   /***/
   constexpr inline const std::string& get_whitespaces( ) const noexcept
   { return m_sWhitespaces; }
 
   /***/
   constexpr inline void               skip_whitespaces( bool bSkip ) noexcept
-  { m_bSkipWhitespaces = bSkip; }
+  { m_bSkipWhitespaces = bSkip; m_bDialectChanged = true; }
   /***/
   constexpr inline bool               skip_whitespaces() const noexcept
   { return m_bSkipWhitespaces; }
@@ -93,30 +117,194 @@ public:
   constexpr inline bool               trim_all() const noexcept
   { return m_bTrimAll;   }
 
+  /***/
+  constexpr inline void               set_engine( engine eEngine ) noexcept
+  { m_eEngine = eEngine; m_bDialectChanged = true; }
+  /***/
+  constexpr inline engine             get_engine() const noexcept
+  { return m_eEngine; }
+
   /***/  
   constexpr inline void               allow_comments( bool bAllowed ) noexcept
-  { m_bAllowComments = bAllowed; }
+  { m_bAllowComments = bAllowed; m_bDialectChanged = true; }
   /***/  
   constexpr inline bool               allow_comments() const noexcept
   { return m_bAllowComments; }
 
+  /**
+   * @brief Restrict fields copied in rows to columns with specified @param labels,
+   *        all other fields are returned empty, without copying or trimming data,
+   *        so that indexes from csv_header remain valid.
+   *        Labels are resolved with csv_header::get_index() once the header is known
+   *        and labels not present in the header are ignored. 
+   *        An empty list disable the projection.
+   */
+  inline           void               set_projection( const std::vector<std::string>& labels ) noexcept
+  { m_vProjectionLabels = labels; m_bColumnsChanged = true; }
+  /***/
+  constexpr inline const std::vector<std::string>& get_projection() const noexcept
+  { return m_vProjectionLabels; }
+
+  /**
+   * @brief Add a predicate to be satisfied by each row, rows where at least one
+   *        predicate fail are discarded before being copied, see csv_predicate.
+   *        As for the projection labels are resolved once the header is known.
+   *        Fields missing in short rows are tested as empty fields, as well as 
+   *        labels not present in the header, that are also reported to onError() 
+   *        with csv_result::_unknown_label.
+   */
+  inline           void               add_predicate( const csv_predicate& predicate ) noexcept
+  { m_vPredicates.push_back( predicate ); m_bColumnsChanged = true; }
+  /***/
+  inline           void               clear_predicates() noexcept
+  { m_vPredicates.clear(); m_bColumnsChanged = true; }
+  /***/
+  constexpr inline const std::vector<csv_predicate>& get_predicates() const noexcept
+  { return m_vPredicates; }
+
+  /**
+   * @brief Copy dialect, engine, projection and predicates from @param parser, so that 
+   *        data are parsed with the same rules, for instance on a range of the same file.
+   */
+  void                                copy_settings( const csv_parser& parser ) noexcept;
+
   /**
    * @brief Retrieve then number of rows read from device.
    */
   inline std::size_t           get_rows() const
   { return m_nRowsCounter; }
 
+  /**
+   * @brief Record in @param pIndex the offset of each row read from now on, as
+   *        a side effect of reading, nullptr to stop recording. The index must 
+   *        remain valid while in use and it is also used by csv_reader::seek_row().
+   */
+  constexpr inline void        set_row_index( csv_row_index* pIndex ) noexcept
+  { m_pRowIndex = pIndex; }
+  /***/
+  constexpr inline csv_row_index* get_row_index() const noexcept
+  { return m_pRowIndex; }
+
+  /**
+   * @brief Offset in the device of the first character of the last row read.
+   */
+  constexpr inline csv_uint_t  get_row_offset() const noexcept
+  { return m_nRowOffset; }
+
 protected:
+  /**
+   * @brief Dialect with characters and options read from csv_parser at runtime,
+   *        see csv_dialect for the compile-time counterpart.
+   */
+  class runtime_dialect
+  {
+  public:
+    /***/
+    constexpr explicit runtime_dialect( const csv_parser& parser ) noexcept
+      : m_parser( parser )
+    {}
+
+    /***/
+    constexpr inline char  delimiter() const noexcept        { return m_parser.get_delimeter();    }
+    /***/
+    constexpr inline char  quote() const noexcept            { return m_parser.get_quote();        }
+    /***/
+    constexpr inline char  eol() const noexcept              { return m_parser.get_eol();          }
+    /***/
+    constexpr inline char  comment() const noexcept          { return m_parser.get_comment();      }
+    /***/
+    constexpr inline bool  allow_comments() const noexcept   { return m_parser.allow_comments();   }
+    /***/
+    constexpr inline bool  skip_whitespaces() const noexcept { return m_parser.skip_whitespaces(); }
+    /***/
+    constexpr inline bool  trim_all() const noexcept         { return m_parser.trim_all();         }
+
+    /**
+     * Note: whitespaces are part of the character classes in csv_dfa, so there
+     * is no need to search the character in get_whitespaces().
+     */
+    inline uint8_t         next( uint8_t state, char ch ) const noexcept
+    { return m_parser.m_dfa.next( state, ch ); }
+
+    /***/
+    inline const char*     find_unquoted( const char* pFirst, const char* pLast ) const noexcept
+    { return m_parser.m_scanUnquoted.find( pFirst, pLast ); }
+    /***/
+    inline const char*     find_quoted( const char* pFirst, const char* pLast ) const noexcept
+    { return m_parser.m_scanQuoted.find( pFirst, pLast ); }
+
+  private:
+    const csv_parser&  m_parser;
+  };
+
+  /**
+   * @brief Parse next row from the device, fields data are stored in m_sData 
+   *        and their position in m_vFields. 
+   *        Default implementation use runtime_dialect, derived classes can 
+   *        provide a dialect known at compile time.
+   */
+  virtual csv_result  parse_fields() noexcept;
+  /***/
+  template<typename dialect_t>
+  csv_result  parse_fields( const dialect_t& dialect ) noexcept;
+
+  /**
+   * @brief Move the device to @param nOffset, that must be the beginning of a row, 
+   *        then next row parsed is counted as row @param nRow. Header must be 
+   *        already known since it is not read again.
+   */
+  csv_result  seek( csv_uint_t nOffset, std::size_t nRow ) noexcept;
+
   /***/
   csv_result  parse( ) noexcept;
   /***/
   csv_result  parse( csv_row& row ) noexcept;
+  /**
+   * @brief Same as parse( csv_row& row ) but fields will refer to the parser 
+   *        internal buffer, so they are valid only until next call. 
+   */
+  csv_result  parse( csv_row_view& row ) noexcept;
+  /**
+   * @brief Parse up to @param nMaxRows rows in @param batch, events and filters
+   *        are bypassed as for parse( csv_row& row ).
+   */
+  csv_result  parse( csv_row_batch& batch, std::size_t nMaxRows ) noexcept;
+  /**
+   * @brief Same as parse( csv_row_batch& batch, std::size_t nMaxRows ) but
+   *        fields are stored by column.
+   */
+  csv_result  parse( csv_column_batch& batch, std::size_t nMaxRows ) noexcept;
 
 private:
   /***/
-  csv_result  parse( csv_row* row ) noexcept;
+  csv_result  parse( csv_row* row, csv_row_view* view, csv_row_batch* batch, csv_column_batch* columns, std::size_t nMaxRows ) noexcept;
+  /**
+   * @brief Fill @param batch with up to @param nMaxRows rows, without going
+   *        through the state machine for each row.
+   */
+  template<typename batch_t>
+  csv_result  parse_batch( batch_t& batch, std::size_t nMaxRows ) noexcept;
   /***/
   csv_result  parse_row( csv_row& row ) noexcept;
+  /***/
+  csv_result  parse_row( csv_row_view& row ) noexcept;
+  /**
+   * @brief Append next row to @param batch, only if it has been read successfully.
+   */
+  csv_result  parse_row( csv_row_batch& batch ) noexcept;
+  /***/
+  csv_result  parse_row( csv_column_batch& batch ) noexcept;
+  /**
+   * @brief Trim the field starting at @param start up to the end of m_sData
+   *        and append it to m_vFields.
+   */
+  template<typename dialect_t>
+  void        add_field( const dialect_t& dialect, std::size_t start ) noexcept;
+  /**
+   * @brief Make next chunk of data available in m_pRecvData, using the device 
+   *        buffer when acquire() is supported, otherwise copying data into m_recvCache.
+   */
+  csv_result  receive() noexcept;
 
   /**
    * @brief 
@@ -129,9 +317,53 @@ private:
    * @return size_t new length of the string once all spaces are removed. 
    *         If the length returned is the same of current lenght no trim have beed done.
    */
-  void        trim_all ( const char* & pFirst, const char* & pLast, size_t& length ) const noexcept;
+  template<typename dialect_t>
+  void        trim_all ( const dialect_t& dialect, const char* & pFirst, const char* & pLast, size_t& length ) const noexcept;
   /***/
-  bool        is_quoted( const char* & pFirst, const char* & pLast, size_t& length ) const noexcept;
+  template<typename dialect_t>
+  bool        is_quoted( const dialect_t& dialect, const char* & pFirst, const char* & pLast, size_t& length ) const noexcept;
+
+  /**
+   * @brief Update scanners with current delimiter, eol, quote, comment and 
+   *        whitespaces. Called from parse_row() only when something change.
+   */
+  void        update_dialect() noexcept;
+  /**
+   * @brief Resolve projection and predicates labels with the header. 
+   */
+  void        update_columns() noexcept;
+  /***/
+  constexpr inline uint8_t column_flags( std::size_t index ) const noexcept
+  { return (index < m_vColumnFlags.size())?m_vColumnFlags[index]:m_nOtherColumns; }
+  /**
+   * @brief Check predicates for last field in m_vFields, that is dropped if
+   *        not part of the projection.
+   * @return false if the row should be discarded.
+   */
+  bool        select_field( std::size_t index, uint8_t flags ) noexcept;
+  /**
+   * @brief Check predicates on columns from @param first on, missing at the end of 
+   *        current row, with empty fields.
+   * @return false if the row should be discarded.
+   */
+  bool        select_missing( std::size_t first ) const noexcept;
+  /**
+   * @brief Count last row parsed, recording its offset when a csv_row_index is in use.
+   */
+  inline void row_parsed() noexcept
+  {
+    if ( m_pRowIndex != nullptr ) [[unlikely]]
+      m_pRowIndex->record( m_nRowsCounter, m_nRowOffset );
+    ++m_nRowsCounter;
+  }
+
+private:
+  /***/
+  struct field_span_t {
+    std::size_t   offset;
+    std::size_t   length;
+    bool          quoted;
+  };
 
 private:
   Status                                 m_eState;
@@ -139,14 +371,264 @@ private:
   bool                                   m_bSkipWhitespaces;
   bool                                   m_bTrimAll;
   bool                                   m_bAllowComments;
+  // Characters to be processed one by one outside and inside quotes,
+  // any other character will be copied in bulk.
+  csv_scanner                            m_scanUnquoted;
+  csv_scanner                            m_scanQuoted;
+  // Transitions for characters found by scanners.
+  csv_dfa                                m_dfa;
+  engine                                 m_eEngine;
+  csv_structural_index                   m_index;
+  // Flags for each column in the header, used only with projection or predicates.
+  static constexpr uint8_t               column_keep = 0x01;   // field is returned
+  static constexpr uint8_t               column_test = 0x02;   // field has predicates
+  std::vector<std::string>               m_vProjectionLabels;
+  std::vector<csv_predicate>             m_vPredicates;
+  std::vector<uint8_t>                   m_vColumnFlags;
+  // Flags for columns not in the header.
+  uint8_t                                m_nOtherColumns;
+  // Indexes in m_vPredicates for each column.
+  std::vector<std::vector<std::size_t>>  m_vColumnPredicates;
+  // Rows with less fields are checked by select_missing(), all rows when m_bRejectAll.
+  std::size_t                            m_nTestColumns;
+  // Set when a predicate on a label not present in the header fail with an empty field.
+  bool                                   m_bRejectAll;
+  bool                                   m_bColumnsChanged;
 
   std::array<byte,to_bytes<32>::KBytes>  m_recvCache;
+  // Point either to m_recvCache or to the device buffer when acquired. 
+  const byte*                            m_pRecvData;
+  bool                                   m_bAcquire;
+  bool                                   m_bAcquired;
   std::size_t                            m_recvCachedBytes;
   std::size_t                            m_recvCacheCursor;
+  // Offset in the device of m_pRecvData and of the first character of current row.
+  csv_uint_t                             m_nRecvOffset;
+  csv_uint_t                             m_nRowOffset;
+  csv_row_index*                         m_pRowIndex;
   csv_data<char,size_t>                  m_sData;
+  std::vector<field_span_t>              m_vFields;
+
+protected:
   std::size_t                            m_nRowsCounter;
 };
 
+template<typename dialect_t>
+inline csv_result csv_parser::parse_fields( const dialect_t& dialect ) noexcept
+{
+  char          _ch{'\0'};
+  csv_result    _retVal = csv_result::_ok;
+
+  bool          _bEoL       = false;
+  uint8_t       _nState     = csv_dfa::start;
+
+  if ( m_bDialectChanged == true ) [[unlikely]]
+    update_dialect();
+
+  // Projection and predicates do not apply to the header.
+  if ( (m_bColumnsChanged == true) && (m_vHeader.empty() == false) ) [[unlikely]]
+    update_columns();
+
+  const bool    _bColumns   = (m_vColumnFlags.empty() == false) && (m_vHeader.empty() == false);
+  std::size_t   _nField     = 0;
+  // Data for fields neither in the projection nor with predicates are not copied.
+  uint8_t       _nFlags     = _bColumns?column_flags( 0 ):column_keep;
+  // Set when a predicate is not satisfied.
+  bool          _bRejected  = false;
+
+  // All fields in the row are stored one after the other in m_sData, 
+  // m_vFields keep track of position and length for each field.
+  std::size_t   _nFieldStart = 0;
+
+  m_sData.clear();
+  m_vFields.clear();
+  m_nRowOffset = m_nRecvOffset + m_recvCacheCursor;
+
+  do
+  {
+    if ( m_recvCacheCursor == m_recvCachedBytes )
+    {
+      csv_result _result = receive();
+      if ( (_result != csv_result::_ok) && (m_recvCachedBytes==0) ) {
+        _retVal = _result;
+        
+        if (_result != csv_result::_eof) {
+          if (m_ptrEvents != nullptr) {
+            m_ptrEvents->onError( _result );
+          }
+        }
+
+        break;
+      }
+      m_recvCacheCursor = 0; 
+
+      if ( m_eEngine == engine::structural_index )
+        m_index.build( reinterpret_cast<const char*>(m_pRecvData), m_recvCachedBytes );
+    }
+
+    const char* pFirst = reinterpret_cast<const char*>(m_pRecvData + m_recvCacheCursor);
+    const char* pLast  = reinterpret_cast<const char*>(m_pRecvData + m_recvCachedBytes);
+
+    if ( _nState != csv_dfa::skip ) [[likely]]
+    {
+      // All characters up to the next delimiter, eol, quote, comment or whitespace
+      // do not require any processing, so they can be copied with a single call.
+      const char* pNext = nullptr;
+      if ( m_eEngine == engine::structural_index )
+        pNext = reinterpret_cast<const char*>(m_pRecvData + m_index.find( m_recvCacheCursor, (_nState == csv_dfa::quoted), (_nState == csv_dfa::start) ));
+      else
+        pNext = (_nState == csv_dfa::quoted)?dialect.find_quoted( pFirst, pLast ):dialect.find_unquoted( pFirst, pLast );
+      if ( pNext != pFirst )
+      {
+        if ( _nFlags != 0 ) [[likely]]
+          m_sData.append( pFirst, static_cast<size_t>(pNext-pFirst) );
+        m_recvCacheCursor += static_cast<size_t>(pNext-pFirst);
+        if ( _nState == csv_dfa::start )
+          _nState = csv_dfa::data;
+
+        if ( pNext == pLast )
+          continue;
+      }
+    }
+    else
+    {
+      // Comment lines are skipped until eol, that will be processed as usual.
+      const void* pEoL = memchr( pFirst, dialect.eol(), static_cast<size_t>(pLast-pFirst) );
+      if ( pEoL == nullptr )
+      {
+        m_recvCacheCursor = m_recvCachedBytes;
+        continue;
+      }
+
+      m_recvCacheCursor += static_cast<size_t>(static_cast<const char*>(pEoL)-pFirst);
+      // Without comments only a discarded row is skipped, next row follow the eol.
+      if ( dialect.allow_comments() == false )
+        m_nRowOffset = m_nRecvOffset + m_recvCacheCursor + 1;
+    }
+
+    _ch = static_cast<char>(m_pRecvData[m_recvCacheCursor++]);
+
+    // Characters with special meaning are processed by the dialect state machine,
+    // see csv_dfa for rules applied to delimiter, eol, quote, comment and whitespaces.
+    const uint8_t _nAction = dialect.next( _nState, _ch );
+
+    if ( (_nAction & csv_dfa::push) && (_nFlags != 0) )
+      m_sData.push_back(_ch);
+
+    _nState = (_nAction & csv_dfa::state_mask);
+
+    if ( _nAction & csv_dfa::add_field )
+    {
+      bool _bSelected = true;
+
+      if ( _nFlags == column_keep ) [[likely]]
+      {
+        add_field( dialect, _nFieldStart );
+      }
+      else if ( _nFlags != 0 )
+      {
+        add_field( dialect, _nFieldStart );
+        _bSelected = select_field( _nField, _nFlags );
+      }
+      else
+      {
+        m_vFields.emplace_back( field_span_t{ _nFieldStart, 0, false } );
+      }
+
+      _nFieldStart = m_sData.length();
+      _bEoL        = ((_nAction & csv_dfa::end_row) != 0);
+      ++_nField;
+
+      if ( (_bEoL == true) && (_nField < m_nTestColumns) && _bColumns && _bSelected && (_bRejected == false) ) [[unlikely]]
+        _bSelected = select_missing( _nField );
+
+      if ( _bSelected == false ) [[unlikely]]
+        _bRejected = true;
+
+      if ( _bRejected == true ) [[unlikely]]
+      {
+        // Row is discarded. Without comments the eol always end the row, so remaining 
+        // data are skipped as for comments, otherwise a comment could still join next 
+        // line to this row and remaining fields are processed without copying them.
+        if ( (_bEoL == true) || (dialect.allow_comments() == false) )
+        {
+          m_sData.clear();
+          m_vFields.clear();
+          if ( _bEoL == true )
+            m_nRowOffset = m_nRecvOffset + m_recvCacheCursor;
+          _nFieldStart = _nField = 0;
+          _nState      = _bEoL?csv_dfa::start:csv_dfa::skip;
+          _bEoL        = _bRejected = false;
+        }
+      }
+
+      _nFlags = _bRejected?0:(_bColumns?column_flags( _nField ):column_keep);
+    }
+
+  } while (_bEoL==false);
+
+  /////////////////////////////////////////////////////////
+  // Intended to manage last data source row where line
+  // terminator (EOL) could be missed then we just got EoF.
+  if ( m_sData.length() != _nFieldStart )
+  {
+    add_field( dialect, _nFieldStart );
+  }
+
+  return _retVal;
+}
+
+template<typename dialect_t>
+inline void csv_parser::add_field( const dialect_t& dialect, std::size_t start ) noexcept
+{
+  const char* pFirst = nullptr;
+  const char* pLast  = nullptr;
+  size_t      length = m_sData.length() - start;
+  bool        quoted = false;
+
+  if ( length > 0 )
+  {
+    pFirst = m_sData.data() + start;
+    pLast  = &pFirst[length-1];
+
+    trim_all( dialect, pFirst, pLast, length );
+    
+    quoted = is_quoted( dialect, pFirst, pLast, length );
+  }
+
+  m_vFields.emplace_back( field_span_t{ (pFirst==nullptr)?start:static_cast<std::size_t>(pFirst-m_sData.data()), length, quoted } );
+}
+
+template<typename dialect_t>
+inline void csv_parser::trim_all( const dialect_t& dialect, const char* & pFirst, const char* & pLast, size_t& length ) const noexcept
+{
+  if ( dialect.trim_all() == true )
+  {
+    while ( *pFirst == ' ' ) { ++pFirst; --length; }
+
+    if ( length > 0 ) {
+      while ( *pLast  == ' ' ) { --pLast;  --length; } 
+    } else {
+      pLast = pFirst;
+    }
+  }
+}
+
+template<typename dialect_t>
+inline bool csv_parser::is_quoted( const dialect_t& dialect, const char* & pFirst, const char* & pLast, size_t& length ) const noexcept
+{
+  // The first condition consider when we have a single character that match with dialect.quote()
+  // in fact in such case content of the field shall be considered not quoted.
+  if ( (pFirst != pLast) && (*pFirst == dialect.quote()) && (*pLast == dialect.quote()) )
+  {
+    pFirst++; pLast--;
+    length -= 2;
+    return true;
+  }
+
+  return false;
+}
+
 } //inline namespace
 } // namespace
 
@@ -0,0 +1,131 @@
+/**************************************************************************************************
+ * 
+ * Copyright 2022 https://github.com/fe-dagostino
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this 
+ * software and associated documentation files (the "Software"), to deal in the Software 
+ * without restriction, including without limitation the rights to use, copy, modify, 
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to 
+ * permit persons to whom the Software is furnished to do so, subject to the following 
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies 
+ * or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE 
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR 
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *************************************************************************************************/
+
+#ifndef CSV_PREDICATE_H
+#define CSV_PREDICATE_H
+
+#include "csv_common.h"
+#include <algorithm>
+#include <charconv>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace csv {
+inline namespace CSV_LIB_VERSION {
+
+/**
+ * @brief csv_predicate is a condition on the field of a column, checked by 
+ *        csv_parser as soon as the field is complete, before the row is copied.
+ *        Rows where at least one predicate is not satisfied are discarded, 
+ *        skipping all remaining data up to the eol.
+ *        Fields are checked once trimmed and without quotes, as they will be
+ *        returned to the application.
+ */
+class csv_predicate
+{
+public:
+  /***/
+  enum class type_t : uint8_t {
+    equal  = 0,   // field is equal to the value
+    prefix = 1,   // field start with the value
+    range  = 2,   // field is a number in [min,max]
+    in     = 3    // field is equal to one of the values
+  };
+
+  /***/
+  static inline csv_predicate equal( const std::string& label, const std::string& value ) noexcept
+  { return csv_predicate( type_t::equal, label, { value }, 0, 0 ); }
+
+  /***/
+  static inline csv_predicate prefix( const std::string& label, const std::string& value ) noexcept
+  { return csv_predicate( type_t::prefix, label, { value }, 0, 0 ); }
+
+  /***/
+  static inline csv_predicate range( const std::string& label, double min, double max ) noexcept
+  { return csv_predicate( type_t::range, label, {}, min, max ); }
+
+  /***/
+  static inline csv_predicate in( const std::string& label, const std::vector<std::string>& values ) noexcept
+  { return csv_predicate( type_t::in, label, values, 0, 0 ); }
+
+  /***/
+  constexpr inline type_t              type() const noexcept
+  { return m_eType; }
+  /**
+   * @brief Label for the column, resolved with csv_header::get_index(). 
+   */
+  constexpr inline const std::string&  label() const noexcept
+  { return m_sLabel; }
+
+  /**
+   * @brief Check the predicate on @param field.
+   */
+  inline bool                          test( std::string_view field ) const noexcept
+  {
+    switch ( m_eType )
+    {
+      case type_t::equal:
+        return (field == m_vValues[0]);
+
+      case type_t::prefix:
+        return field.starts_with( m_vValues[0] );
+
+      case type_t::range:
+      {
+        double      _value = 0;
+        const char* pLast  = field.data() + field.length();
+        const auto  _res   = std::from_chars( field.data(), pLast, _value );
+
+        return (_res.ec == std::errc()) && (_res.ptr == pLast) && (_value >= m_dMin) && (_value <= m_dMax);
+      }
+
+      case type_t::in:
+        return std::binary_search( m_vValues.begin(), m_vValues.end(), field, std::less<>() );
+    }
+
+    return false;
+  }
+
+private:
+  /***/
+  csv_predicate( type_t type, const std::string& label, const std::vector<std::string>& values, double min, double max ) noexcept
+    : m_eType( type ), m_sLabel( label ), m_vValues( values ), m_dMin( min ), m_dMax( max )
+  {
+    // Values are sorted for binary search.
+    if ( m_eType == type_t::in )
+      std::sort( m_vValues.begin(), m_vValues.end() );
+  }
+
+private:
+  type_t                    m_eType;
+  std::string               m_sLabel;
+  std::vector<std::string>  m_vValues;
+  double                    m_dMin;
+  double                    m_dMax;
+};
+
+} //inline namespace
+} // namespace
+
+#endif //CSV_PREDICATE_H
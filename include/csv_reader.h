@@ -26,6 +26,8 @@
 
 #include "csv_common.h"
 #include "csv_parser.h"
+#include "csv_dialect.h"
+#include "csv_bind.h"
 
 namespace csv {
 inline namespace CSV_LIB_VERSION {
@@ -44,7 +46,59 @@ public:
   bool read();
   /***/
   bool read( csv_row& row );
+  /**
+   * @brief Read next row without copying fields, see csv_row_view.
+   */
+  bool read( csv_row_view& row );
+  /**
+   * @brief Read next row and convert it into @param object with @param bind, fields 
+   *        are not copied as for read( csv_row_view& row ) and column indexes are 
+   *        resolved with the header on first read. Conversion errors are reported
+   *        by csv_bind::errors().
+   * @return false when there are no more rows.
+   */
+  template<typename T>
+  inline bool read( csv_bind<T>& bind, T& object )
+  {
+    if ( read( m_rowView ) == false )
+      return false;
+
+    if ( bind.resolved() == false )
+      bind.resolve( get_header() );
+
+    bind.assign( m_rowView, object );
+    return true;
+  }
+
+  /**
+   * @brief Read up to @param nMaxRows rows in @param batch, replacing rows 
+   *        from previous read. As for read( csv_row& row ) both events and 
+   *        filters are bypassed.
+   * @return false when there are no more rows.
+   */
+  bool read_batch( csv_row_batch& batch, std::size_t nMaxRows );
+  /**
+   * @brief Same as read_batch( csv_row_batch& batch, std::size_t nMaxRows ) 
+   *        with fields stored column by column, see csv_column_batch.
+   */
+  bool read_batch( csv_column_batch& batch, std::size_t nMaxRows );
+  /**
+   * @brief Read up to @param nMaxRows rows in an internal batch, then filters 
+   *        are applied and rows are notified with csv_events::onRows().
+   * @return false when there are no more rows.
+   */
+  bool read_batch( std::size_t nMaxRows );
   
+  /**
+   * @brief Position the reader so that next row read is @param nRow, zero based 
+   *        and header excluded. Parsing restart from the nearest row in the index 
+   *        set with set_row_index(), then rows up to @param nRow are skipped.
+   *        The device must support csv_device::seek().
+   * @return false if there is no index, if the device cannot be moved or if 
+   *         there are less than @param nRow rows.
+   */
+  bool seek_row( std::size_t nRow );
+
   /***/
   using csv_parser::apply_filters;
 
@@ -52,6 +106,73 @@ public:
   bool close();
 
 private:
+  csv_row_batch     m_batch;
+  csv_row_view      m_rowView;
+};
+
+/**
+ * @brief csv_reader_t is a csv_reader where characters with special meaning and 
+ *        parsing options are fixed at compile time with a csv_dialect, so that 
+ *        the parsing loop is specialized for such dialect. 
+ *        Methods changing the dialect are not available, and changes done through 
+ *        a reference to csv_reader or csv_parser are reverted before next row, 
+ *        csv_reader remain the generic alternative when the dialect is known only 
+ *        at runtime.
+ */
+template<typename dialect_t>
+class csv_reader_t : public csv_reader
+{
+public:
+  using dialect_type = dialect_t;
+
+  /***/
+  csv_reader_t( const std::string& feedname, core::unique_ptr<csv_device> ptrDevice, core::unique_ptr<csv_events> ptrEvents )
+    : csv_reader( feedname, std::move(ptrDevice), std::move(ptrEvents) )
+  { apply_dialect(); }
+
+  void set_delimeter  ( char ch ) = delete;
+  void set_quote      ( char ch ) = delete;
+  void set_eol        ( char ch ) = delete;
+  void set_comment    ( char ch ) = delete;
+  void set_whitespaces( const std::string& whitespaces ) = delete;
+
+  /***/
+  constexpr inline bool allow_comments() const noexcept
+  { return dialect_t::allow_comments(); }
+  /***/
+  constexpr inline bool skip_whitespaces() const noexcept
+  { return dialect_t::skip_whitespaces(); }
+  /***/
+  constexpr inline bool trim_all() const noexcept
+  { return dialect_t::trim_all(); }
+
+protected:
+  /***/
+  virtual csv_result    parse_fields() noexcept override
+  { 
+    // Setters are still reachable through a reference to a base class.
+    if ( (m_bDialectChanged == true) || (csv_parser::trim_all() != dialect_t::trim_all()) ) [[unlikely]]
+      apply_dialect();
+
+    return csv_parser::parse_fields( dialect_t() ); 
+  }
+
+private:
+  /**
+   * @brief Runtime settings are still used by scanners and by get_*() methods,
+   *        so they are set with values from dialect_t.
+   */
+  inline void           apply_dialect() noexcept
+  {
+    csv_reader::set_delimeter   ( dialect_t::delimiter()        );
+    csv_reader::set_quote       ( dialect_t::quote()            );
+    csv_reader::set_eol         ( dialect_t::eol()              );
+    csv_reader::set_comment     ( dialect_t::comment()          );
+    csv_reader::allow_comments  ( dialect_t::allow_comments()   );
+    csv_reader::skip_whitespaces( dialect_t::skip_whitespaces() );
+    csv_reader::trim_all        ( dialect_t::trim_all()         );
+    csv_reader::set_whitespaces ( dialect_t::whitespaces()      );
+  }
 
 };
 
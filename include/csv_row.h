@@ -56,6 +56,11 @@ public:
     : csv_row_base_t(std::move(row)), m_flags(0)
   {}
 
+  /***/
+  csv_row( csv_row&& row ) noexcept
+    : csv_row_base_t(std::move(static_cast<csv_row_base_t&>(row))), m_flags(row.m_flags)
+  {}
+
   /***/
   constexpr inline uint32_t   get_flags() const noexcept
   { return m_flags; }
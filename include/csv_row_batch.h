@@ -0,0 +1,130 @@
+/**************************************************************************************************
+ * 
+ * Copyright 2022 https://github.com/fe-dagostino
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this 
+ * software and associated documentation files (the "Software"), to deal in the Software 
+ * without restriction, including without limitation the rights to use, copy, modify, 
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to 
+ * permit persons to whom the Software is furnished to do so, subject to the following 
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies 
+ * or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE 
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR 
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *************************************************************************************************/
+
+#ifndef CSV_ROW_BATCH_H
+#define CSV_ROW_BATCH_H
+
+#include "csv_common.h"
+#include "csv_row.h"
+#include <span>
+#include <vector>
+
+namespace csv {
+inline namespace CSV_LIB_VERSION {
+
+/**
+ * @brief csv_row_batch is a block of rows filled by csv_reader::read_batch().
+ *        Rows are not released when the batch is cleared, so both rows and 
+ *        fields storage are reused from one read to the next one.
+ */
+class csv_row_batch
+{
+public:
+  using iterator       = std::vector<csv_row>::iterator;
+  using const_iterator = std::vector<csv_row>::const_iterator;
+
+  /***/
+  csv_row_batch() noexcept
+    : m_vRows(), m_nSize(0)
+  {}
+
+  /**
+   * @brief Number of rows in the batch.
+   */
+  constexpr inline std::size_t  size() const noexcept
+  { return m_nSize; }
+  /***/
+  constexpr inline bool         empty() const noexcept
+  { return (m_nSize == 0); }
+  /**
+   * @brief Number of rows allocated, that can be filled without new allocations.
+   */
+  inline std::size_t           capacity() const noexcept
+  { return m_vRows.size(); }
+
+  /**
+   * @brief Remove all rows from the batch, keeping their storage.
+   */
+  constexpr inline void         clear() noexcept
+  { m_nSize = 0; }
+  /**
+   * @brief Remove all rows from the batch and release their storage.
+   */
+  inline void                   release() noexcept
+  { m_vRows.clear(); m_nSize = 0; }
+
+  /**
+   * @brief Append a row to the batch, reusing a previous one if available.
+   *        Note: the row returned is not cleared.
+   */
+  inline csv_row&               next() noexcept
+  {
+    if ( m_nSize == m_vRows.size() )
+      m_vRows.emplace_back();
+
+    return m_vRows[m_nSize++];
+  }
+  /**
+   * @brief Remove last row from the batch, storage is kept for next use.
+   */
+  constexpr inline void         pop_back() noexcept
+  { if ( m_nSize > 0 ) --m_nSize; }
+
+  /***/
+  inline const csv_row&         operator[]( std::size_t index ) const noexcept
+  { return m_vRows[index]; }
+  /***/
+  inline csv_row&               operator[]( std::size_t index ) noexcept
+  { return m_vRows[index]; }
+
+  /***/
+  inline iterator               begin() noexcept
+  { return m_vRows.begin(); }
+  /***/
+  inline iterator               end() noexcept
+  { return m_vRows.begin() + static_cast<std::ptrdiff_t>(m_nSize); }
+  /***/
+  inline const_iterator         begin() const noexcept
+  { return m_vRows.begin(); }
+  /***/
+  inline const_iterator         end() const noexcept
+  { return m_vRows.begin() + static_cast<std::ptrdiff_t>(m_nSize); }
+
+  /**
+   * @brief Rows in the batch as a contiguous sequence.
+   */
+  inline std::span<csv_row>     rows() noexcept
+  { return std::span<csv_row>( m_vRows.data(), m_nSize ); }
+  /***/
+  inline std::span<const csv_row> rows() const noexcept
+  { return std::span<const csv_row>( m_vRows.data(), m_nSize ); }
+
+private:
+  std::vector<csv_row>   m_vRows;
+  std::size_t            m_nSize;
+};
+
+} //inline namespace
+} // namespace
+
+#endif //CSV_ROW_BATCH_H
@@ -0,0 +1,136 @@
+/**************************************************************************************************
+ * 
+ * Copyright 2022 https://github.com/fe-dagostino
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this 
+ * software and associated documentation files (the "Software"), to deal in the Software 
+ * without restriction, including without limitation the rights to use, copy, modify, 
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to 
+ * permit persons to whom the Software is furnished to do so, subject to the following 
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies 
+ * or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE 
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR 
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *************************************************************************************************/
+
+#ifndef CSV_ROW_INDEX_H
+#define CSV_ROW_INDEX_H
+
+#include "csv_common.h"
+#include <string>
+#include <vector>
+
+namespace csv {
+inline namespace CSV_LIB_VERSION {
+
+/**
+ * @brief csv_row_index keep the offset in the device of the first character of 
+ *        each row, dense or sampled every N rows, so that csv_reader::seek_row() 
+ *        can start parsing from there instead of from the beginning of the file.
+ *        The index is filled as a side effect of reading rows, see 
+ *        csv_parser::set_row_index(), and can be saved in a sidecar file that 
+ *        is validated with size and modification time of the csv file.
+ *        Offsets are relative to data following the BOM, if any, and for compressed 
+ *        files to decompressed data, while the sidecar is validated with the file on disk.
+ */
+class csv_row_index
+{
+public:
+  /**
+   * @param nStep  an offset is recorded every @param nStep rows, 1 for a dense index.
+   */
+  explicit csv_row_index( std::size_t nStep = 1 ) noexcept
+    : m_nStep( (nStep==0)?1:nStep ), m_nRows( 0 ), m_vOffsets()
+  {}
+
+  /**
+   * @brief Record @param offset for @param row, rows must be provided in sequence 
+   *        so rows already indexed or following a gap are ignored.
+   */
+  inline void                           record( std::size_t row, csv_uint_t offset ) noexcept
+  {
+    if ( row != m_nRows )
+      return;
+
+    if ( (row % m_nStep) == 0 )
+      m_vOffsets.push_back( offset );
+    ++m_nRows;
+  }
+
+  /**
+   * @brief Search the nearest indexed row at or before @param row.
+   * 
+   * @param indexed_row  updated with the row found.
+   * @param offset       updated with the offset of @param indexed_row.
+   * @return false if the index is empty.
+   */
+  inline bool                           find( std::size_t row, std::size_t& indexed_row, csv_uint_t& offset ) const noexcept
+  {
+    if ( m_vOffsets.empty() )
+      return false;
+
+    const std::size_t _ndx = std::min( row / m_nStep, m_vOffsets.size()-1 );
+    indexed_row = _ndx * m_nStep;
+    offset      = m_vOffsets[_ndx];
+    return true;
+  }
+
+  /***/
+  constexpr inline std::size_t          step() const noexcept
+  { return m_nStep; }
+  /**
+   * @brief Number of rows seen while building the index.
+   */
+  constexpr inline std::size_t          rows() const noexcept
+  { return m_nRows; }
+  /***/
+  inline const std::vector<csv_uint_t>& offsets() const noexcept
+  { return m_vOffsets; }
+  /***/
+  inline bool                           empty() const noexcept
+  { return m_vOffsets.empty(); }
+  /***/
+  inline void                           clear() noexcept
+  { m_nRows = 0; m_vOffsets.clear(); }
+
+  /**
+   * @brief Write the index in @param sidecar together with size and modification
+   *        time of @param datafile. Offsets are stored as variable length deltas.
+   * \return _ok        index saved.
+   * \return _access    unable to access @param datafile or to write @param sidecar.
+   */
+  csv_result                            save( const std::string& sidecar, const std::string& datafile ) const noexcept;
+  /**
+   * @brief Read the index from @param sidecar.
+   * \return _ok        index loaded.
+   * \return _access    unable to access @param datafile or to read @param sidecar.
+   * \return _cfg_error @param sidecar is not an index or it refers to a different 
+   *                    version of @param datafile, that is size or modification time 
+   *                    do not match; the index is not modified.
+   */
+  csv_result                            load( const std::string& sidecar, const std::string& datafile ) noexcept;
+
+  /**
+   * @brief Default sidecar name for @param datafile.
+   */
+  static inline std::string             sidecar_name( const std::string& datafile ) noexcept
+  { return datafile + ".idx"; }
+
+private:
+  std::size_t               m_nStep;
+  std::size_t               m_nRows;
+  std::vector<csv_uint_t>   m_vOffsets;
+};
+
+} //inline namespace
+} // namespace
+
+#endif //CSV_ROW_INDEX_H
@@ -0,0 +1,70 @@
+/**************************************************************************************************
+ * 
+ * Copyright 2022 https://github.com/fe-dagostino
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this 
+ * software and associated documentation files (the "Software"), to deal in the Software 
+ * without restriction, including without limitation the rights to use, copy, modify, 
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to 
+ * permit persons to whom the Software is furnished to do so, subject to the following 
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies 
+ * or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE 
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR 
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *************************************************************************************************/
+
+#ifndef CSV_ROW_VIEW_H
+#define CSV_ROW_VIEW_H
+
+#include "csv_common.h"
+#include "csv_field.h"
+#include "csv_row.h"
+
+namespace csv {
+inline namespace CSV_LIB_VERSION {
+
+
+/**
+ * @brief csv_row_view hold fields as std::string_view that refer to the 
+ *        parser internal buffer, so reading a row do not require any memory 
+ *        allocation for each field.
+ *        Fields are valid until next read() or until the reader is destroyed, 
+ *        use to_row() in order to keep a copy of the row.
+ */
+class csv_row_view : public csv_row_view_base_t
+{
+public:
+  /***/
+  csv_row_view() noexcept
+  {}
+
+  /***/
+  inline const csv_field_view_t&  get_field(std::size_t index) const noexcept
+  { return at(index); }
+
+  /**
+   * @brief Copy all fields in a new csv_row that do not depend anymore 
+   *        from the parser.
+   */
+  inline void                     to_row( csv_row& row ) const noexcept
+  {
+    row.clear();
+    row.reserve( size() );
+    for ( const auto& item : *this )
+    { row.emplace_back( csv_field( csv_data_t(item.data().data(),item.data().length()), item.hasquotes() ) ); }
+  }
+
+};
+
+} //inline namespace
+} // namespace
+
+#endif //CSV_ROW_VIEW_H
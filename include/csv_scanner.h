@@ -0,0 +1,165 @@
+/**************************************************************************************************
+ * 
+ * Copyright 2022 https://github.com/fe-dagostino
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this 
+ * software and associated documentation files (the "Software"), to deal in the Software 
+ * without restriction, including without limitation the rights to use, copy, modify, 
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to 
+ * permit persons to whom the Software is furnished to do so, subject to the following 
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies 
+ * or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE 
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR 
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *************************************************************************************************/
+
+#ifndef CSV_SCANNER_H
+#define CSV_SCANNER_H
+
+#include "csv_common.h"
+#include <array>
+
+namespace csv {
+inline namespace CSV_LIB_VERSION {
+
+/**
+ * @brief csv_scanner locate the next character belonging to a set of "structural" 
+ *        characters, that are all characters that csv_parser need to process one by one 
+ *        such as delimiter, eol, quote, comment and whitespaces. All characters in 
+ *        between can be copied in bulk.
+ *        Search is performed with the widest instruction set available at runtime, 
+ *        AVX-512BW, AVX2 or SSE4.2, processing from 16 up to 64 bytes for each step.
+ *        A scalar fallback based on a lookup table is always available.
+ */
+class csv_scanner
+{
+public:
+  enum class isa_t : uint8_t {
+    scalar = 0x00,
+    sse42  = 0x01,
+    avx2   = 0x02,
+    avx512 = 0x03,
+  };
+
+  /***/
+  csv_scanner() noexcept;
+
+  /**
+   * @brief Remove all characters from the set.
+   */
+  void                    clear() noexcept;
+
+  /**
+   * @brief Add @param ch to the set of characters to be searched.
+   */
+  void                    insert( char ch ) noexcept;
+
+  /**
+   * @brief Add all characters in @param chars to the set of characters to be searched.
+   */
+  void                    insert( const std::string& chars ) noexcept;
+
+  /**
+   * @brief Check if @param ch is part of the set.
+   */
+  inline bool             contains( char ch ) const noexcept
+  { return m_table[static_cast<uint8_t>(ch)]; }
+
+  /**
+   * @brief Search the first character in the set.
+   * 
+   * @param pFirst  pointer to the first character to be checked.
+   * @param pLast   pointer past the last character to be checked.
+   * @return pointer to the first character in the set or @param pLast if no one 
+   *         of the characters between [pFirst,pLast) is part of the set.
+   */
+  inline const char*      find( const char* pFirst, const char* pLast ) const noexcept
+  { return m_pfnFind( *this, pFirst, pLast ); }
+
+  /**
+   * @brief Classify a block of 64 characters.
+   * 
+   * @param pBlock  pointer to the first of 64 characters, all of them must be readable.
+   * @return bitmap where bit N is set if pBlock[N] is part of the set.
+   */
+  inline uint64_t         mask( const char* pBlock ) const noexcept
+  { return m_pfnMask( *this, pBlock ); }
+
+  /**
+   * @brief Retrieve instruction set used by default from new scanners.
+   */
+  static isa_t            get_isa() noexcept;
+
+  /**
+   * @brief Force the instruction set to be used by scanners updated after this call.
+   *        Intended for benchmarks and troubleshooting, it is not thread safe.
+   * 
+   * @return true   if @param isa is supported by current CPU.
+   * @return false  if @param isa is not supported, in such case nothing change.
+   */
+  static bool             set_isa( isa_t isa ) noexcept;
+
+  /**
+   * @brief Check if @param isa is supported by current CPU.
+   */
+  static bool             is_supported( isa_t isa ) noexcept;
+
+  /**
+   * @brief Human readable name for @param isa.
+   */
+  static const char*      isa_name( isa_t isa ) noexcept;
+
+private:
+  using find_fn_t = const char* (*)( const csv_scanner&, const char*, const char* ) noexcept;
+  using mask_fn_t = uint64_t    (*)( const csv_scanner&, const char* ) noexcept;
+
+  /***/
+  void                    update() noexcept;
+
+  /***/
+  static const char*      find_scalar( const csv_scanner& scanner, const char* pFirst, const char* pLast ) noexcept;
+  /***/
+  static const char*      find_sse42 ( const csv_scanner& scanner, const char* pFirst, const char* pLast ) noexcept;
+  /***/
+  static const char*      find_avx2  ( const csv_scanner& scanner, const char* pFirst, const char* pLast ) noexcept;
+  /***/
+  static const char*      find_avx512( const csv_scanner& scanner, const char* pFirst, const char* pLast ) noexcept;
+
+  /***/
+  static uint64_t         mask_scalar( const csv_scanner& scanner, const char* pBlock ) noexcept;
+  /***/
+  static uint64_t         mask_sse42 ( const csv_scanner& scanner, const char* pBlock ) noexcept;
+  /***/
+  static uint64_t         mask_avx2  ( const csv_scanner& scanner, const char* pBlock ) noexcept;
+  /***/
+  static uint64_t         mask_avx512( const csv_scanner& scanner, const char* pBlock ) noexcept;
+
+private:
+  find_fn_t                     m_pfnFind;
+  mask_fn_t                     m_pfnMask;
+  // One entry for each character, true if the character is in the set.
+  std::array<bool,256>          m_table;
+  // Characters in the set, used by SSE4.2 implementation.
+  std::array<char,16>           m_needles;
+  uint8_t                       m_nNeedles;
+  // Nibbles lookup tables, used by AVX2 and AVX-512 implementations. Each 
+  // distinct high nibble in the set is mapped to a bit, so a character is part of the 
+  // set when (m_nibbleLo[ch & 0x0F] & m_nibbleHi[ch >> 4]) != 0.
+  // The 16 entries are replicated for each 128 bits lane of a 512 bits register.
+  std::array<uint8_t,64>        m_nibbleLo;
+  std::array<uint8_t,64>        m_nibbleHi;
+  uint8_t                       m_nNibbleGroups;
+};
+
+} //inline namespace
+} // namespace
+
+#endif //CSV_SCANNER_H
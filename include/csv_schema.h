@@ -0,0 +1,152 @@
+/**************************************************************************************************
+ * 
+ * Copyright 2022 https://github.com/fe-dagostino
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this 
+ * software and associated documentation files (the "Software"), to deal in the Software 
+ * without restriction, including without limitation the rights to use, copy, modify, 
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to 
+ * permit persons to whom the Software is furnished to do so, subject to the following 
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies 
+ * or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE 
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR 
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *************************************************************************************************/
+
+#ifndef CSV_SCHEMA_H
+#define CSV_SCHEMA_H
+
+#include "csv_common.h"
+#include "csv_header.h"
+#include <initializer_list>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace csv {
+inline namespace CSV_LIB_VERSION {
+
+class csv_parser;
+class csv_reader;
+
+/**
+ * @brief csv_schema declare the type of each column, identified by its label, so that 
+ *        conversions can be selected once for each column, for instance with resolve() 
+ *        and csv_numeric_column, instead of checking each value at runtime.
+ *        A schema can be declared by the user or proposed by infer(), sampling rows 
+ *        at the beginning of a file or blocks at random offsets.
+ */
+class csv_schema
+{
+public:
+  enum class type_t : uint8_t {
+    string     = 0x00,
+    integer    = 0x01,      // int64_t
+    floating   = 0x02,      // double
+    boolean    = 0x03,      // true or false, case insensitive, 1 or 0, see try_parse_bool()
+    timestamp  = 0x04,      // ISO 8601, YYYY-MM-DD[(T| )hh:mm[:ss[.fff]]][Z|(+|-)hh[:]mm]
+    dictionary = 0x05       // string with a small set of distinct values
+  };
+
+  /***/
+  struct column_t {
+    std::string   label;
+    type_t        type;
+    bool          nullable;   // empty fields are allowed
+  };
+
+  /***/
+  csv_schema() noexcept
+    : m_vColumns()
+  {}
+
+  /***/
+  csv_schema( std::initializer_list<column_t> columns ) noexcept
+    : m_vColumns( columns )
+  {}
+
+  /**
+   * @brief Add column @param label or update its type if already present.
+   */
+  void                                  add( const std::string& label, type_t type, bool nullable = true ) noexcept;
+
+  /***/
+  inline std::size_t                    size() const noexcept
+  { return m_vColumns.size(); }
+  /***/
+  inline bool                           empty() const noexcept
+  { return m_vColumns.empty(); }
+  /***/
+  inline const std::vector<column_t>&   columns() const noexcept
+  { return m_vColumns; }
+  /***/
+  inline const column_t&                operator[]( std::size_t index ) const noexcept
+  { return m_vColumns[index]; }
+  /***/
+  inline void                           clear() noexcept
+  { m_vColumns.clear(); }
+
+  /**
+   * @brief Search column with @param label.
+   * @return zero based index in the schema or -1 if not present.
+   */
+  int32_t                               find( std::string_view label ) const noexcept;
+
+  /**
+   * @brief Types for all fields in the same order of @param header, columns that 
+   *        are not declared in the schema are strings.
+   */
+  std::vector<type_t>                   resolve( const csv_header& header ) const noexcept;
+
+  /***/
+  static const char*                    type_name( type_t type ) noexcept;
+
+  /**
+   * @brief Most specific type for a single not empty @param value, never dictionary.
+   */
+  static type_t                         classify( std::string_view value ) noexcept;
+
+  /**
+   * @brief Propose a schema for all columns in @param header from a sample of @param rows.
+   *        Rows with a different number of fields than the header are not considered.
+   *        Types are widened as needed, integer to floating and any other mismatch 
+   *        to string; columns with only 1 and 0 are integer, but boolean when they 
+   *        also have true or false; string columns with at most @param nMaxDictionary 
+   *        distinct values, each one repeated on average, are proposed as dictionary.
+   */
+  static csv_schema                     infer( const csv_header& header, std::span<const csv_row> rows, 
+                                               std::size_t nMaxDictionary = 256 ) noexcept;
+
+  /**
+   * @brief Propose a schema reading up to @param nRows rows from @param reader, that 
+   *        must be open, rows read are consumed.
+   */
+  static csv_schema                     infer( csv_reader& reader, std::size_t nRows, 
+                                               std::size_t nMaxDictionary = 256 ) noexcept;
+
+  /**
+   * @brief Propose a schema for data in memory, for instance a file mapped with csv_dev_mmap,
+   *        parsing the header with the same dialect of @param parser and then @param nBlocks 
+   *        blocks of about @param nBlockSize bytes: first block follow the header, all others 
+   *        start from the first line after a random offset.
+   */
+  static csv_schema                     infer( const csv_parser& parser, const char* pData, std::size_t length,
+                                               std::size_t nBlocks, std::size_t nBlockSize, 
+                                               std::size_t nMaxDictionary = 256 ) noexcept;
+
+private:
+  std::vector<column_t>   m_vColumns;
+};
+
+} //inline namespace
+} // namespace
+
+#endif //CSV_SCHEMA_H
@@ -0,0 +1,157 @@
+/**************************************************************************************************
+ * 
+ * Copyright 2022 https://github.com/fe-dagostino
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this 
+ * software and associated documentation files (the "Software"), to deal in the Software 
+ * without restriction, including without limitation the rights to use, copy, modify, 
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to 
+ * permit persons to whom the Software is furnished to do so, subject to the following 
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies 
+ * or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE 
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR 
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *************************************************************************************************/
+
+#ifndef CSV_STRUCTURAL_INDEX_H
+#define CSV_STRUCTURAL_INDEX_H
+
+#include "csv_common.h"
+#include "csv_scanner.h"
+#include <vector>
+
+namespace csv {
+inline namespace CSV_LIB_VERSION {
+
+/**
+ * @brief csv_structural_index is the first stage of csv_parser::engine::structural_index.
+ *        For each block of 64 characters it builds the bitmaps of quotes, delimiters, eol,
+ *        whitespaces and comments, and then with a carry-less multiplication the mask of 
+ *        characters inside quotes.
+ *        Second stage, implemented by find(), walks only the set bits. Blocks where quotes
+ *        match the semantic of csv_parser, that is each quote is either opening at the start
+ *        of the field or closing before a delimiter or eol, with only whitespaces between them,
+ *        use the mask so that delimiters and quotes inside quotes are skipped without any branch;
+ *        quoted fields can span consecutive blocks resolved in this way. All other blocks, for instance
+ *        with quotes in the middle of a field or with comments, provide each quote, delimiter, eol, 
+ *        comment and whitespace to csv_parser as done with csv_scanner.
+ */
+class csv_structural_index
+{
+public:
+  /***/
+  csv_structural_index() noexcept;
+
+  /**
+   * @brief Set characters with special meaning. 
+   * 
+   * @param comments     comment marker, empty if comments are not allowed.
+   * @param whitespaces  whitespaces, empty if whitespaces should not be skipped.
+   */
+  void                  set_dialect( char delimiter, char quote, char eol, const std::string& comments, const std::string& whitespaces ) noexcept;
+
+  /**
+   * @brief First stage, build bitmaps for all blocks in [pData, pData+length).
+   *        Bitmaps are built by find() as needed, so data must remain valid 
+   *        until next call to build().
+   */
+  void                  build( const char* pData, std::size_t length ) noexcept;
+
+  /**
+   * @brief Second stage, search for the next character that csv_parser should process.
+   * 
+   * @param pos          offset to start searching from.
+   * @param quote_open   true if current field has an open quote.
+   * @param field_empty  true if no characters have been collected for current field.
+   * @return offset of next character to be processed or length specified with build() 
+   *         if there are no more characters to be processed. 
+   */
+  std::size_t           find( std::size_t pos, bool quote_open, bool field_empty ) noexcept;
+
+  /**
+   * @brief Number of blocks where quotes have been resolved with the mask of characters
+   *        inside quotes since last call to set_dialect().
+   */
+  constexpr inline std::size_t  fast_blocks() const noexcept
+  { return m_nFastBlocks; }
+
+  /**
+   * @brief Check if carry-less multiplication is supported from current CPU, otherwise
+   *        the mask of characters inside quotes is computed with shifts.
+   */
+  static bool           has_clmul() noexcept;
+
+private:
+  enum class mode_t : uint8_t {
+    undecided = 0,
+    fast      = 1,    // quotes resolved with inside mask
+    exact     = 2     // all characters with special meaning must be processed
+  };
+
+  struct block_t {
+    uint64_t  quote;
+    uint64_t  delimiter;
+    uint64_t  eol;
+    uint64_t  whitespace;
+    uint64_t  comment;
+    uint64_t  inside;       // characters between an opening and a closing quote, included opening
+    uint64_t  fast;         // characters to be processed when mode is fast
+    mode_t    mode;
+  };
+
+  using classify_fn_t = void (*)( const csv_structural_index&, const char*, block_t& ) noexcept;
+
+  /**
+   * @brief Build bitmaps for s_nWindowBlocks blocks starting with block @param first.
+   */
+  void                  index( std::size_t first ) noexcept;
+  /**
+   * @brief Set the mode of @param block, relative to the first indexed block, and of 
+   *        the following blocks when quotes are open at its end.
+   */
+  void                  decide( std::size_t block, bool at_start, bool quote_open, bool field_empty ) noexcept;
+
+  /***/
+  static void           classify_generic( const csv_structural_index& index, const char* pBlock, block_t& block ) noexcept;
+  /***/
+  static void           classify_avx2   ( const csv_structural_index& index, const char* pBlock, block_t& block ) noexcept;
+  /***/
+  static void           classify_avx512 ( const csv_structural_index& index, const char* pBlock, block_t& block ) noexcept;
+
+private:
+  classify_fn_t         m_pfnClassify;
+  char                  m_cDelimiter;
+  char                  m_cQuote;
+  char                  m_cEoL;
+  char                  m_cComment;
+  bool                  m_bComment;
+  csv_scanner           m_scanDelimiter;
+  csv_scanner           m_scanQuote;
+  csv_scanner           m_scanEoL;
+  csv_scanner           m_scanComment;
+  csv_scanner           m_scanWhitespace;
+  // false when characters with special meaning are not disjoint, so only exact mode can be used.
+  bool                  m_bSpeculate;
+
+  // Number of blocks indexed at time, 32 KB of data.
+  static constexpr std::size_t s_nWindowBlocks = 512;
+
+  const char*           m_pData;
+  std::size_t           m_nLength;
+  std::size_t           m_nFirstBlock;
+  std::vector<block_t>  m_vBlocks;
+  std::size_t           m_nFastBlocks;
+};
+
+} //inline namespace
+} // namespace
+
+#endif //CSV_STRUCTURAL_INDEX_H
@@ -26,11 +26,24 @@
 
 #include "csv_common.h"
 #include "csv_base.h"
+#include "csv_scanner.h"
+#include <vector>
+#include <cstring>
 
 namespace csv {
 inline namespace CSV_LIB_VERSION {
 
-/***/
+/**
+ * @brief csv_writer format rows in a staging buffer that is sent to the device 
+ *        when it reaches the buffer size, on flush() and on close(), so that 
+ *        there is one csv_device::send() for many rows instead of one for each 
+ *        field, quote and delimiter.
+ *        Fields parsed with quotes are kept escaped by csv_parser, so they are 
+ *        written back enclosed in quotes with only quotes not already doubled escaped. 
+ *        Any other field is checked with csv_scanner and when it contains delimiter, 
+ *        quote, eol, CR or LF it is enclosed in quotes and its quotes are doubled as 
+ *        required by RFC 4180, otherwise it is copied with no changes.
+ */
 class csv_writer : public csv_base
 {
 public:
@@ -42,27 +55,130 @@ public:
    * @param ptrEvents  events for callback events and details on each single operation. 
    *                   This parameter can be nullptr but in such case the application rely only
    *                   on return values.
+   * @param nBufferSize  staged bytes sent to the device at once, with 0 each row 
+   *                     is sent as soon as it has been formatted.
    */
-  csv_writer( const std::string& feedname, core::unique_ptr<csv_device> ptrDevice, core::unique_ptr<csv_events> ptrEvents );
+  csv_writer( const std::string& feedname, core::unique_ptr<csv_device> ptrDevice, core::unique_ptr<csv_events> ptrEvents,
+              csv_uint_t nBufferSize = to_bytes<64>::KBytes );
 
   /**
-   * @brief 
+   * @brief Send staged rows, if any, before the destruction.
+   */
+  virtual ~csv_writer();
+
+  /***/
+  constexpr inline csv_uint_t  get_buffer_size() const noexcept
+  { return m_nBufferSize; }
+
+  /**
+   * @brief Write @param out_header as first row. Delimiter, quote and eol must be 
+   *        set before this call, since they are used to check which fields need quotes.
    * 
-   * @param out_header 
    * @return true 
    * @return false 
    */
   bool open( const csv_header& out_header );
 
-  /***/
+  /**
+   * @brief Format @param row in the staging buffer.
+   *        Output columns are taken from @param row with a mapping built the first 
+   *        time @param header is used and cached by its address and revision, so 
+   *        it is built again when labels change or a new header takes the same 
+   *        address. Cached mappings are discarded by open() or clear_mappings().
+   * 
+   * @return false if staged data have been sent to the device and it failed.
+   */
   bool write( const csv_header& header, const csv_row& row );
 
+  /**
+   * @brief Send staged rows to the device and flush it.
+   * 
+   * @return false if the device failed to send data.
+   */
+  bool flush();
+
   /***/
   bool close();
 
+  /**
+   * @brief Discard cached mappings from source headers to output columns.
+   */
+  inline void clear_mappings() noexcept
+  { m_vMappings.clear(); m_nMapping = 0; }
+
 private:
+  /**
+   * @brief For each output column the index of the same label in the source 
+   *        header, or -1 when it is missing and then the field is left empty.
+   */
+  struct mapping_t {
+    const csv_header*                         header;
+    uint64_t                                  revision;    // header revision when built
+    std::size_t                               columns;     // columns in header when built
+    std::vector<csv_header::field_index_t>    indexes;
+
+    /***/
+    inline bool matches( const csv_header& source ) const noexcept
+    { return (header == &source) && (revision == source.get_revision()) && (columns == source.size()); }
+  };
+
+  /**
+   * @brief Return the mapping for @param header, building it when not cached.
+   */
+  const std::vector<csv_header::field_index_t>& _in_get_mapping( const csv_header& header );
+  /**
+   * @brief Update scanner with current delimiter, quote and eol.
+   */
+  void update_dialect() noexcept;
   /***/
   bool _in_write_field( const csv_field_t& field );
+  /**
+   * @brief Append characters in [@param pFirst,@param pLast) with each quote doubled, 
+   *        @param pQuote is the first quote in the range or @param pLast.
+   *        With @param bKeepPairs quotes already doubled are copied as they are.
+   */
+  void _in_write_escaped( const char* pFirst, const char* pQuote, const char* pLast, bool bKeepPairs );
+  /**
+   * @brief Complete current row and send staged data when the buffer is full.
+   */
+  bool _in_end_row();
+  /***/
+  bool _in_send();
+  /**
+   * @brief Search the quote in [@param pFirst,@param pLast) with memchr(), that is 
+   *        vectorized as well and faster than csv_scanner for a single character.
+   */
+  inline const char* _in_find_quote( const char* pFirst, const char* pLast ) const noexcept
+  { 
+    const void* _pQuote = memchr( pFirst, get_quote(), static_cast<std::size_t>(pLast - pFirst) );
+    return (_pQuote != nullptr)?static_cast<const char*>(_pQuote):pLast;
+  }
+  /***/
+  inline void _in_append( const void* pData, std::size_t nLength )
+  { 
+    if ( m_nTxSize + nLength > m_vTxBuffer.size() )
+      m_vTxBuffer.resize( 2 * (m_nTxSize + nLength) );
+    memcpy( &m_vTxBuffer[m_nTxSize], pData, nLength );
+    m_nTxSize += nLength;
+  }
+  /***/
+  inline void _in_append( char ch )
+  { 
+    if ( m_nTxSize == m_vTxBuffer.size() )
+      m_vTxBuffer.resize( 2 * (m_nTxSize + 1) );
+    m_vTxBuffer[m_nTxSize++] = static_cast<byte>(ch);
+  }
+
+private:
+  const csv_uint_t    m_nBufferSize;
+  std::vector<byte>   m_vTxBuffer;        // rows formatted and not yet sent,
+  csv_uint_t          m_nTxSize;          // up to m_nTxSize
+
+  std::vector<mapping_t>  m_vMappings;
+  std::size_t             m_nMapping;     // last mapping used
+
+  // Characters that require a field to be quoted.
+  csv_scanner             m_scanSpecials;
 
 };
 
@@ -0,0 +1,243 @@
+/**************************************************************************************************
+ * 
+ * Copyright 2022 https://github.com/fe-dagostino
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this 
+ * software and associated documentation files (the "Software"), to deal in the Software 
+ * without restriction, including without limitation the rights to use, copy, modify, 
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to 
+ * permit persons to whom the Software is furnished to do so, subject to the following 
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies 
+ * or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE 
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR 
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *************************************************************************************************/
+
+#ifndef CSV_DEV_COMPRESSED_H
+#define CSV_DEV_COMPRESSED_H
+
+#include "csv_common.h"
+#include "csv_device.h"
+#include "csv_dev_file.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+
+struct z_stream_s;
+struct ZSTD_DCtx_s;
+
+namespace csv {
+inline namespace CSV_LIB_VERSION {
+
+/**
+ * @brief csv_dev_compressed read gzip or zstd compressed files, detected from the
+ *        magic bytes at the beginning of the file, while other files are read as 
+ *        they are with a csv_dev_file. Compressed data are read with a csv_dev_file 
+ *        and decompressed by a background thread in a ring of buffers, so that 
+ *        decompression and parsing overlap; concatenated gzip members and zstd 
+ *        frames are supported.
+ *        Options are the same used for csv_dev_file, only openmode::read is 
+ *        supported: buffer size is the size of decompressed buffers and read_ahead 
+ *        the number of buffers decompressed in advance, at least 1.
+ *        Block compressed files, BGZF and the zstd seekable format, are detected 
+ *        from their block index: blocks are grouped in chunks of at most buffer 
+ *        size decompressed bytes, or one block if larger, decompressed in parallel 
+ *        by one thread for each core and then provided in file order; seek() is 
+ *        supported on such files, as on plain files.
+ *        gzip and BGZF requires CSV_HAS_ZLIB, zstd CSV_HAS_ZSTD.
+ */
+class csv_dev_compressed : public csv_device
+{
+public:
+  enum class codec_t : uint8_t {
+    plain,                      // not compressed
+    gzip,                       // 1F 8B
+    zstd,                       // 28 B5 2F FD
+    bgzf,                       // gzip members with BSIZE in the extra field "BC"
+    zstd_seekable               // zstd frames followed by a seek table
+  };
+
+  /**
+   * @brief csv_dev_compressed Constructs a csv_dev_compressed
+   */
+  csv_dev_compressed( std::unique_ptr<csv_dev_file_options> ptrDeviceOptions, core::unique_ptr<csv_device_events> ptrEvents = nullptr);
+  
+  /***/
+  virtual ~csv_dev_compressed();
+
+  /**
+   * \return _ok            Device open successfully or already open.
+   *                        Also a call to a opened device will return the same value.
+   * \return _wrong_call    Device options do not specify openmode::read.
+   * \return _access        Unable to access specified file.
+   * \return _no_mem        Unable to allocate buffers.
+   * \return _cfg_error     File is compressed with a codec not available.
+   */
+  virtual csv_result open() noexcept override;
+  /**
+   * \return _wrong_call    Writing is not supported.
+   */
+  virtual csv_result send(const byte* pBuffer, csv_uint_t nBufferLen) noexcept override;
+  /**
+   * \return _rx_error      Compressed data are not valid or truncated.
+   * \return _eof
+   */
+  virtual csv_result recv( byte* pBuffer, csv_uint_t& nBufferLen) noexcept override;
+  /**
+   * @brief Provide direct access to the decompressed buffer, see csv_device::acquire().
+   * \return _rx_error      Compressed data are not valid or truncated.
+   * \return _eof
+   */
+  virtual csv_result acquire( const byte*& pBuffer, csv_uint_t& nBufferLen ) noexcept override;
+  /***/
+  virtual csv_result release( csv_uint_t nBufferLen ) noexcept override;
+  /**
+   * @brief Move to @param nOffset bytes of decompressed data, following the BOM if any.
+   * \return _not_implemented   File is a gzip or zstd stream without block index.
+   * \return _rx_error          Unable to move the position in the file.
+   */
+  virtual csv_result seek( csv_uint_t nOffset ) noexcept override;
+  
+  virtual csv_result close() noexcept override;
+
+  /**
+   * \return _ok                Device is valid.
+   */
+  virtual csv_result is_valid() const noexcept override;
+
+  /**
+   * @brief rx is the amount of decompressed bytes.
+   */
+  virtual void       get_stats( csv_dev_stats& stats ) const noexcept override;
+
+  /**
+   * @brief Codec detected by open().
+   */
+  constexpr inline codec_t       get_codec() const noexcept
+  { return m_eCodec; }
+
+  /**
+   * @brief Detect compression from the magic bytes at the beginning of @param pBuffer.
+   */
+  static codec_t                 detect_codec( const byte* pBuffer, csv_uint_t nBufferLen ) noexcept;
+
+  /**
+   * @brief Check if @param codec is available in this build.
+   */
+  static bool                    is_available( codec_t codec ) noexcept;
+
+private:
+  struct block_t {
+    csv_uint_t  offset;                                 // in the compressed file
+    csv_uint_t  size;                                   // compressed bytes
+    csv_uint_t  data_size;                              // decompressed bytes
+  };
+
+  /***/
+  void                            release() noexcept;
+  /**
+   * @brief Fill m_vBlocks for BGZF or zstd seekable files, on failure the file is 
+   *        read as a stream.
+   */
+  bool                            build_index( int hFile ) noexcept;
+  /***/
+  bool                            index_bgzf( int hFile, csv_uint_t nFileSize ) noexcept;
+  /***/
+  bool                            index_zstd_seekable( int hFile, csv_uint_t nFileSize ) noexcept;
+  /**
+   * @brief Start decompression of block chunks from m_nChunk.
+   */
+  void                            start_workers() noexcept;
+  /***/
+  void                            stop_workers() noexcept;
+  /**
+   * @brief Body of threads decompressing chunks of blocks.
+   */
+  void                            decompress_blocks() noexcept;
+  /***/
+  csv_result                      on_recv_error( csv_result result ) noexcept;
+  /***/
+  bool                            init_codec() noexcept;
+  /***/
+  void                            end_codec() noexcept;
+  /**
+   * @brief Decompress from @param pIn into @param pOut.
+   * 
+   * @param nConsumed  updated with bytes consumed from @param pIn.
+   * @param nProduced  updated with bytes written in @param pOut.
+   * \return _ok        
+   * \return _rx_error  compressed data are not valid.
+   */
+  csv_result                      decode( const byte* pIn, csv_uint_t nIn, csv_uint_t& nConsumed, 
+                                          byte* pOut, csv_uint_t nOut, csv_uint_t& nProduced ) noexcept;
+  /**
+   * @brief Move to next decompressed buffer, waiting for the thread.
+   */
+  csv_result                      refresh_cache() noexcept;
+  /**
+   * @brief Same as refresh_cache() for block compressed files.
+   */
+  csv_result                      refresh_chunk() noexcept;
+  /**
+   * @brief Body of the decompression thread.
+   */
+  void                            decompress() noexcept;
+
+private:
+  std::unique_ptr<csv_dev_file>   m_ptrSource;          // file, compressed or not
+  codec_t                         m_eCodec;
+  bool                            m_bOpen;
+  bool                            m_bStreamEnd;         // last gzip member or zstd frame completed
+  z_stream_s*                     m_pZlib;
+  ZSTD_DCtx_s*                    m_pZstd;
+
+  byte*                           m_pRxBuffer;          // all buffers, one after the other
+  const byte*                     m_pRxCache;           // buffer currently consumed
+  csv_uint_t                      m_nBufSize;
+  csv_uint_t                      m_nCacheSize;
+  csv_uint_t                      m_nCursor;
+  bool                            m_bBomChecked;
+  csv_uint_t                      m_nBomSize;
+
+  // Same ring used by csv_dev_file read ahead, buffers following m_nRxCurrent,
+  // up to m_nRxReady, are decompressed and can be consumed.
+  std::vector<csv_uint_t>         m_vRxSizes;
+  std::size_t                     m_nRxCurrent;
+  std::size_t                     m_nRxReady;
+  csv_result                      m_eRxResult;          // result after the last buffer
+  bool                            m_bRxDone;
+  bool                            m_bRxStop;
+  std::mutex                      m_mtxRx;
+  std::condition_variable         m_cvRxFilled;
+  std::condition_variable         m_cvRxConsumed;
+  std::thread                     m_thDecompress;
+
+  // Block compressed files, the slot of chunk n is n % m_vSlotChunk.size() and it
+  // can be decompressed while the previous chunk in the same slot has been consumed.
+  int                             m_hFile;              // read with pread() by all workers
+  std::vector<block_t>            m_vBlocks;
+  std::vector<std::size_t>        m_vChunks;            // first block of each chunk, then m_vBlocks.size()
+  std::vector<csv_uint_t>         m_vChunkOffsets;      // decompressed offset of each chunk, then total size
+  std::vector<std::size_t>        m_vSlotChunk;         // chunk decompressed in each slot
+  std::vector<csv_result>         m_vSlotResult;
+  std::size_t                     m_nNextChunk;         // next chunk to be decompressed
+  std::size_t                     m_nChunk;             // next chunk to be consumed
+  csv_uint_t                      m_nSkip;              // bytes to skip in the next chunk after seek()
+  std::vector<std::thread>        m_vWorkers;
+
+};
+
+
+} //inline namespace
+} // namespace
+
+#endif // CSV_DEV_COMPRESSED_H
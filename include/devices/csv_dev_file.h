@@ -27,6 +27,10 @@
 #include "csv_common.h"
 #include "csv_device.h"
 #include <iostream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
 
 namespace csv {
 inline namespace CSV_LIB_VERSION {
@@ -61,14 +65,27 @@ public:
     AUTO_DETECT = 0xFF
   };
 
+  /**
+   * @brief Alignment for buffers, offsets and lengths used with direct I/O.
+   */
+  static constexpr csv_uint_t    direct_io_alignment = 4096;
+
   /**
    * File Device options.
    *
    * @param sFilename    filename.
+   * @param read_ahead   number of buffers, each one of @param buf_size bytes, filled 
+   *                     in advance by a background thread while data in the current 
+   *                     buffer are consumed, so that reading from the file and parsing 
+   *                     overlap; 0 to read synchronously when the buffer is empty.
+   * @param direct_io    read with O_DIRECT bypassing the page cache, @param buf_size 
+   *                     is then rounded up to direct_io_alignment. Ignored in write 
+   *                     mode, by csv_dev_mmap or when the file system do not support it.
    */
-  explicit csv_dev_file_options( std::string sFilename, openmode mode, csv_uint_t buf_size = to_bytes<1>::MBytes, filetype bom = filetype::PLAIN_TEXT ) noexcept
+  explicit csv_dev_file_options( std::string sFilename, openmode mode, csv_uint_t buf_size = to_bytes<1>::MBytes, filetype bom = filetype::PLAIN_TEXT, 
+                                 csv_uint_t read_ahead = 0, bool direct_io = false ) noexcept
   : csv_device_options(), m_sFilename(sFilename), m_openMode(mode), m_bom(bom),
-    m_bufSize( buf_size )
+    m_bufSize( buf_size ), m_nReadAhead( read_ahead ), m_bDirectIO( direct_io )
   {}
 
   /***/
@@ -91,11 +108,21 @@ public:
   constexpr filetype             get_bom() const noexcept
   { return m_bom; }
 
+  /***/
+  constexpr csv_uint_t           get_read_ahead() const noexcept
+  { return m_nReadAhead; }
+
+  /***/
+  constexpr bool                 get_direct_io() const noexcept
+  { return m_bDirectIO; }
+
 private:
   std::string       m_sFilename;
   const openmode    m_openMode;
   const filetype    m_bom;
   const csv_uint_t  m_bufSize;
+  const csv_uint_t  m_nReadAhead;
+  const bool        m_bDirectIO;
 };
 
 class csv_dev_file : public csv_device
@@ -123,6 +150,18 @@ public:
    * \return _rx_timedout
    */
   virtual csv_result recv( byte* pBuffer, csv_uint_t& nBufferLen) noexcept override;
+  /**
+   * @brief Provide direct access to the internal buffer, see csv_device::acquire().
+   * \return _rx_error
+   */
+  virtual csv_result acquire( const byte*& pBuffer, csv_uint_t& nBufferLen ) noexcept override;
+  /***/
+  virtual csv_result release( csv_uint_t nBufferLen ) noexcept override;
+  /**
+   * \return _wrong_call    Device is not in read mode.
+   * \return _rx_error      Unable to move the position in the file.
+   */
+  virtual csv_result seek( csv_uint_t nOffset ) noexcept override;
   
   virtual csv_result close() noexcept override;
 
@@ -136,11 +175,40 @@ public:
    */
   virtual csv_result is_valid() const noexcept override;
 
+  /**
+   * @brief Detect the Byte Order Mark at the beginning of @param pBuffer.
+   * 
+   * @param nBomSize  updated with the BOM length in bytes, zero for PLAIN_TEXT.
+   * @return detected file type or PLAIN_TEXT if there is no BOM.
+   */
+  static csv_dev_file_options::filetype  detect_bom( const byte* pBuffer, csv_uint_t nBufferLen, csv_uint_t& nBomSize ) noexcept;
+
 private:
   /***/
   csv_result                      refresh_cache() noexcept;
+  /**
+   * @brief Read up to one buffer from the file in @param pBuffer.
+   */
+  csv_result                      read_buffer( byte* pBuffer, csv_uint_t& nLength ) noexcept;
+  /**
+   * @brief Same as read_buffer() for a file opened with O_DIRECT, reading from the 
+   *        aligned offset m_nDirectOffset and discarding m_nDirectSkip bytes.
+   */
+  csv_result                      read_direct( byte* pBuffer, csv_uint_t& nLength ) noexcept;
+  /**
+   * @brief Start the thread filling buffers from current position in the file.
+   */
+  void                            start_read_ahead() noexcept;
+  /**
+   * @brief Stop the thread, buffers already filled are discarded.
+   */
+  void                            stop_read_ahead() noexcept;
+  /**
+   * @brief Body of the read ahead thread.
+   */
+  void                            read_ahead() noexcept;
   /***/
-  constexpr void                  release() noexcept;
+  void                            release() noexcept;
   /***/
   csv_dev_file_options::filetype  detect_and_skip_bom() noexcept;
   /***/
@@ -148,9 +216,32 @@ private:
 
 private:
   FILE*        m_pFile;
-  byte*        m_pRxBuffer;
+  byte*        m_pRxBuffer;        // all buffers, one after the other
+  byte*        m_pRxCache;         // buffer currently consumed
+  csv_uint_t   m_nBufSize;
   csv_uint_t   m_nCacheSize;
   csv_uint_t   m_nCursor;
+  csv_uint_t   m_nBomSize;
+
+  // With O_DIRECT file position is not used, reads start from m_nDirectOffset and 
+  // the first m_nDirectSkip bytes, BOM or data before a seek() offset, are discarded.
+  bool         m_bDirect;
+  csv_uint_t   m_nDirectOffset;
+  csv_uint_t   m_nDirectSkip;
+
+  // Read ahead, m_vRxSizes hold the length of data in each buffer. Buffers following 
+  // m_nRxCurrent, up to m_nRxReady, are filled and can be consumed; all others, but 
+  // the one currently consumed, are filled by m_thReadAhead.
+  std::vector<csv_uint_t>   m_vRxSizes;
+  std::size_t               m_nRxCurrent;
+  std::size_t               m_nRxReady;
+  csv_result                m_eRxResult;       // result after the last buffer filled
+  bool                      m_bRxDone;
+  bool                      m_bRxStop;
+  std::mutex                m_mtxRx;
+  std::condition_variable   m_cvRxFilled;
+  std::condition_variable   m_cvRxConsumed;
+  std::thread               m_thReadAhead;
 
 };
 
@@ -0,0 +1,106 @@
+/**************************************************************************************************
+ * 
+ * Copyright 2022 https://github.com/fe-dagostino
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this 
+ * software and associated documentation files (the "Software"), to deal in the Software 
+ * without restriction, including without limitation the rights to use, copy, modify, 
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to 
+ * permit persons to whom the Software is furnished to do so, subject to the following 
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies 
+ * or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE 
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR 
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *************************************************************************************************/
+
+#ifndef CSV_DEV_MMAP_H
+#define CSV_DEV_MMAP_H
+
+#include "csv_common.h"
+#include "csv_device.h"
+#include "csv_dev_file.h"
+
+namespace csv {
+inline namespace CSV_LIB_VERSION {
+
+/**
+ * @brief csv_dev_mmap map the whole file in memory in read only mode, then 
+ *        data are provided with acquire() directly from the mapped memory
+ *        without any read system call or intermediate copy. 
+ *        Options are the same used for csv_dev_file, only openmode::read is 
+ *        supported and buffer size is not used.
+ */
+class csv_dev_mmap : public csv_device
+{
+public:
+  /**
+   * @brief csv_dev_mmap Constructs a csv_dev_mmap
+   */
+  csv_dev_mmap( std::unique_ptr<csv_dev_file_options> ptrDeviceOptions, core::unique_ptr<csv_device_events> ptrEvents = nullptr);
+  
+  /***/
+  virtual ~csv_dev_mmap();
+
+  /**
+   * \return _ok            Device open successfully or already open.
+   *                        Also a call to a opened device will return the same value.
+   * \return _wrong_call    Device options do not specify openmode::read.
+   * \return _access        Unable to access specified file.
+   * \return _no_mem        Unable to map the file in memory.
+   */
+  virtual csv_result open() noexcept override;
+  /**
+   * \return _wrong_call    Writing is not supported.
+   */
+  virtual csv_result send(const byte* pBuffer, csv_uint_t nBufferLen) noexcept override;
+  /**
+   * \return _eof
+   */
+  virtual csv_result recv( byte* pBuffer, csv_uint_t& nBufferLen) noexcept override;
+  /**
+   * @brief Provide all remaining bytes in the mapped file, see csv_device::acquire().
+   * \return _eof
+   */
+  virtual csv_result acquire( const byte*& pBuffer, csv_uint_t& nBufferLen ) noexcept override;
+  /***/
+  virtual csv_result release( csv_uint_t nBufferLen ) noexcept override;
+  /**
+   * \return _eof           @param nOffset is beyond the end of the file.
+   */
+  virtual csv_result seek( csv_uint_t nOffset ) noexcept override;
+  
+  virtual csv_result close() noexcept override;
+
+  /**
+   * \return _ok                Device is valid.
+   */
+  virtual csv_result is_valid() const noexcept override;
+
+private:
+  /***/
+  void                            release() noexcept;
+  /***/
+  csv_result                      on_recv_error( csv_result result ) noexcept;
+
+private:
+  int          m_hFile;
+  const byte*  m_pData;
+  csv_uint_t   m_nSize;
+  csv_uint_t   m_nCursor;
+  csv_uint_t   m_nBomSize;
+
+};
+
+
+} //inline namespace
+} // namespace
+
+#endif // CSV_DEV_MMAP_H
@@ -0,0 +1,133 @@
+/**************************************************************************************************
+ * 
+ * Copyright 2022 https://github.com/fe-dagostino
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this 
+ * software and associated documentation files (the "Software"), to deal in the Software 
+ * without restriction, including without limitation the rights to use, copy, modify, 
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to 
+ * permit persons to whom the Software is furnished to do so, subject to the following 
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies 
+ * or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE 
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR 
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *************************************************************************************************/
+
+#ifndef CSV_DEV_RANGE_H
+#define CSV_DEV_RANGE_H
+
+#include "csv_common.h"
+#include "csv_device.h"
+#include <algorithm>
+#include <cstring>
+
+namespace csv {
+inline namespace CSV_LIB_VERSION {
+
+/**
+ * @brief Device providing a range of bytes from memory, for instance already 
+ *        mapped by csv_dev_mmap, without any copy. Used by csv_parallel_reader 
+ *        threads and to sample blocks of a file with csv_schema::infer().
+ *        Data must remain valid while the device is in use.
+ */
+class csv_dev_range : public csv_device
+{
+public:
+  /***/
+  csv_dev_range( const char* pData, csv_uint_t nLength ) noexcept
+    : csv_device( "csv_dev_range", nullptr, nullptr ),
+      m_pData( reinterpret_cast<const byte*>(pData) ), m_nLength( nLength ), m_nCursor( 0 ), m_bOpen( true )
+  {}
+
+  /***/
+  virtual csv_result open() noexcept override
+  { return csv_result::_ok; }
+  /***/
+  virtual csv_result send( [[maybe_unused]] const byte* pBuffer, [[maybe_unused]] csv_uint_t nBufferLen ) noexcept override
+  { return csv_result::_wrong_call; }
+  /***/
+  virtual csv_result recv( byte* pBuffer, csv_uint_t& nBufferLen ) noexcept override
+  {
+    const byte* _pData = nullptr;
+    csv_uint_t  _nLength = 0;
+    csv_result  _retVal = acquire( _pData, _nLength );
+    
+    nBufferLen = std::min( nBufferLen, _nLength );
+    if ( _retVal == csv_result::_ok )
+    {
+      memcpy( pBuffer, _pData, nBufferLen );
+      release( nBufferLen );
+    }
+
+    return _retVal;
+  }
+  /***/
+  virtual csv_result acquire( const byte*& pBuffer, csv_uint_t& nBufferLen ) noexcept override
+  {
+    pBuffer    = nullptr;
+    nBufferLen = 0;
+
+    if ( m_bOpen == false )
+      return csv_result::_closed;
+
+    // Same as other devices, reaching the end of data close the device.
+    if ( m_nCursor == m_nLength )
+    {
+      close();
+      return csv_result::_eof;
+    }
+
+    pBuffer    = &m_pData[m_nCursor];
+    nBufferLen = m_nLength - m_nCursor;
+    return csv_result::_ok;
+  }
+  /***/
+  virtual csv_result release( csv_uint_t nBufferLen ) noexcept override
+  { 
+    nBufferLen     = std::min( nBufferLen, m_nLength - m_nCursor );
+    m_nCursor     += nBufferLen;
+    m_devStats.rx += nBufferLen;
+    return csv_result::_ok; 
+  }
+  /***/
+  virtual csv_result seek( csv_uint_t nOffset ) noexcept override
+  {
+    if ( nOffset > m_nLength )
+      return csv_result::_eof;
+
+    m_nCursor = nOffset;
+    m_bOpen   = true;
+    return csv_result::_ok;
+  }
+  /***/
+  virtual csv_result close() noexcept override
+  {
+    if ( m_bOpen == false )
+      return csv_result::_closed;
+
+    m_bOpen = false;
+    return csv_result::_ok;
+  }
+  /***/
+  virtual csv_result is_valid() const noexcept override
+  { return (m_bOpen?csv_result::_ok:csv_result::_closed); }
+
+private:
+  const byte*  m_pData;
+  csv_uint_t   m_nLength;
+  csv_uint_t   m_nCursor;
+  bool         m_bOpen;
+};
+
+} //inline namespace
+} // namespace
+
+#endif //CSV_DEV_RANGE_H
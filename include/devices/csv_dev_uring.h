@@ -0,0 +1,200 @@
+/**************************************************************************************************
+ * 
+ * Copyright 2022 https://github.com/fe-dagostino
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this 
+ * software and associated documentation files (the "Software"), to deal in the Software 
+ * without restriction, including without limitation the rights to use, copy, modify, 
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to 
+ * permit persons to whom the Software is furnished to do so, subject to the following 
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies 
+ * or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE 
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR 
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *************************************************************************************************/
+
+#ifndef CSV_DEV_URING_H
+#define CSV_DEV_URING_H
+
+#include "csv_common.h"
+#include "csv_device.h"
+#include "csv_dev_file.h"
+
+#ifdef CSV_HAS_IO_URING
+
+#include <vector>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace csv {
+inline namespace CSV_LIB_VERSION {
+
+/**
+ * @brief csv_dev_uring read a file with Linux io_uring, keeping several reads in 
+ *        flight on a ring of buffers registered with the kernel, while completed 
+ *        buffers are provided in file order with acquire() as for csv_dev_file.
+ *        Options are the same used for csv_dev_file, only openmode::read is 
+ *        supported: buffer size is the length of each read and read_ahead is 
+ *        the number of buffers, that is reads in flight plus the one consumed, 
+ *        with a default of 4 when read_ahead is lower than 2. With direct_io 
+ *        the file is opened with O_DIRECT, as for csv_dev_file.
+ *        Available only when the library is built with CSV_HAS_IO_URING.
+ */
+class csv_dev_uring : public csv_device
+{
+public:
+  /**
+   * @brief csv_dev_uring Constructs a csv_dev_uring
+   */
+  csv_dev_uring( std::unique_ptr<csv_dev_file_options> ptrDeviceOptions, core::unique_ptr<csv_device_events> ptrEvents = nullptr);
+  
+  /***/
+  virtual ~csv_dev_uring();
+
+  /**
+   * \return _ok            Device open successfully or already open.
+   *                        Also a call to a opened device will return the same value.
+   * \return _wrong_call    Device options do not specify openmode::read.
+   * \return _access        Unable to access specified file.
+   * \return _no_mem        Unable to allocate buffers.
+   * \return _cfg_error     io_uring is not available.
+   */
+  virtual csv_result open() noexcept override;
+  /**
+   * \return _wrong_call    Writing is not supported.
+   */
+  virtual csv_result send(const byte* pBuffer, csv_uint_t nBufferLen) noexcept override;
+  /**
+   * \return _rx_error
+   * \return _eof
+   */
+  virtual csv_result recv( byte* pBuffer, csv_uint_t& nBufferLen) noexcept override;
+  /**
+   * @brief Provide direct access to the buffer currently consumed, see csv_device::acquire().
+   * \return _rx_error
+   * \return _eof
+   */
+  virtual csv_result acquire( const byte*& pBuffer, csv_uint_t& nBufferLen ) noexcept override;
+  /***/
+  virtual csv_result release( csv_uint_t nBufferLen ) noexcept override;
+  /**
+   * @brief Reads in flight are completed and discarded, then new reads start 
+   *        from @param nOffset.
+   * \return _eof           @param nOffset is beyond the end of the file.
+   */
+  virtual csv_result seek( csv_uint_t nOffset ) noexcept override;
+  
+  virtual csv_result close() noexcept override;
+
+  /**
+   * \return _ok                Device is valid.
+   */
+  virtual csv_result is_valid() const noexcept override;
+
+private:
+  enum class state_t : uint8_t {
+    free,                       // buffer not in use
+    reading,                    // read submitted and not yet completed
+    ready,                      // data available, to be consumed in order
+    failed                      // read completed with an error
+  };
+
+  /***/
+  void                            release() noexcept;
+  /***/
+  csv_result                      on_recv_error( csv_result result ) noexcept;
+  /**
+   * @brief Map submission and completion rings of a new io_uring instance.
+   */
+  bool                            setup_ring( unsigned nEntries ) noexcept;
+  /**
+   * @brief Queue a read for the bytes still missing in buffer @param nBuffer, 
+   *        that is submitted with next call to enter().
+   */
+  void                            queue_read( std::size_t nBuffer ) noexcept;
+  /**
+   * @brief Queue a read for the rest of buffer @param nBuffer after a short read, 
+   *        with direct I/O from the last whole block so that offset stay aligned.
+   */
+  void                            resume_read( std::size_t nBuffer ) noexcept;
+  /**
+   * @brief Queue next read in file order, if any, using buffer @param nBuffer.
+   */
+  void                            queue_next( std::size_t nBuffer ) noexcept;
+  /**
+   * @brief Submit queued reads and wait for at least @param nWait completions.
+   */
+  bool                            enter( unsigned nWait ) noexcept;
+  /**
+   * @brief Update buffers for all completions available.
+   */
+  void                            reap() noexcept;
+  /**
+   * @brief Wait all reads in flight, buffers are then free.
+   */
+  void                            drain() noexcept;
+  /**
+   * @brief Move to next buffer in file order, waiting for its completion.
+   */
+  csv_result                      refresh_cache() noexcept;
+
+private:
+  int                      m_hFile;
+  int                      m_hRing;
+  bool                     m_bFixed;            // buffers registered with the ring
+  bool                     m_bDirect;           // file opened with O_DIRECT
+
+  // Rings shared with the kernel.
+  void*                    m_pSqRing;
+  std::size_t              m_nSqRingSize;
+  void*                    m_pCqRing;
+  std::size_t              m_nCqRingSize;
+  io_uring_sqe*            m_pSqes;
+  std::size_t              m_nSqesSize;
+  unsigned*                m_pSqHead;
+  unsigned*                m_pSqTail;
+  unsigned                 m_nSqMask;
+  unsigned*                m_pSqArray;
+  unsigned*                m_pCqHead;
+  unsigned*                m_pCqTail;
+  unsigned                 m_nCqMask;
+  io_uring_cqe*            m_pCqes;
+  unsigned                 m_nQueued;           // reads queued and not yet submitted
+
+  // Buffers are used round robin, so file order is the same of buffer indexes.
+  byte*                    m_pRxBuffer;
+  csv_uint_t               m_nBufSize;
+  std::vector<state_t>     m_vStates;
+  std::vector<csv_uint_t>  m_vOffsets;          // file offset for each buffer
+  std::vector<csv_uint_t>  m_vLengths;          // bytes read so far in each buffer
+  std::vector<csv_uint_t>  m_vRequested;        // bytes requested for each buffer
+  std::size_t              m_nInFlight;
+  std::size_t              m_nNext;             // next buffer in file order
+  std::size_t              m_nCurrent;          // buffer currently consumed
+
+  csv_uint_t               m_nSize;
+  csv_uint_t               m_nBomSize;
+  csv_uint_t               m_nReadOffset;       // file offset for next read to queue
+  csv_uint_t               m_nSkip;             // bytes to discard in next buffer
+  const byte*              m_pCache;
+  csv_uint_t               m_nCacheSize;
+  csv_uint_t               m_nCursor;
+
+};
+
+
+} //inline namespace
+} // namespace
+
+#endif // CSV_HAS_IO_URING
+
+#endif // CSV_DEV_URING_H
@@ -107,6 +107,36 @@ public:
    * @return csv_result  
    */
   virtual csv_result recv( byte* pBuffer, csv_uint_t& iBufferLen ) = 0;
+  /**
+   * @brief Optional zero-copy alternative to recv(), give access to data already 
+   *        available in the device internal buffer without copying it. 
+   *        Data remain valid until release() is called.
+   *        Default implementation return _not_implemented and caller should 
+   *        use recv() instead.
+   * 
+   * @param pBuffer      updated with the pointer to the first available byte.
+   * @param iBufferLen   updated with the amount of bytes available at @param pBuffer. 
+   *                     If no data are available or in case of error this value 
+   *                     will be zero.
+   * @return csv_result  
+   */
+  virtual csv_result acquire( const byte*& pBuffer, csv_uint_t& iBufferLen ) noexcept
+  { pBuffer = nullptr; iBufferLen = 0; return csv_result::_not_implemented; }
+  /**
+   * @brief Return to the device @param iBufferLen bytes obtained with acquire(),
+   *        such bytes are considered consumed and next acquire() will provide 
+   *        following data.
+   */
+  virtual csv_result release( [[maybe_unused]] csv_uint_t iBufferLen ) noexcept
+  { return csv_result::_not_implemented; }
+  /**
+   * @brief Optional, move the read position to @param nOffset bytes from the beginning
+   *        of data, that is following the BOM if any. Data obtained with acquire() are 
+   *        no more valid. A closed device is opened again.
+   *        Default implementation return _not_implemented.
+   */
+  virtual csv_result seek( [[maybe_unused]] csv_uint_t nOffset ) noexcept
+  { return csv_result::_not_implemented; }
   /***/
   virtual csv_result close() = 0;
   /***/
@@ -35,6 +35,7 @@ csv_base::csv_base( const std::string& feedname )
 csv_base::csv_base( const std::string& feedname, core::unique_ptr<csv_device> ptrDevice, core::unique_ptr<csv_events> ptrEvents )
   : m_sFeedName(feedname),
     m_cDelimeter(','), m_cQuote('\"'), m_cEoL('\n'), m_cComment('#'),
+    m_bDialectChanged(true),
     m_ptrDevice( std::move(ptrDevice) ),
     m_ptrEvents( std::move(ptrEvents) ),
     m_vHeader()
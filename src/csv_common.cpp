@@ -49,6 +49,7 @@ static const std::unordered_map<csv_result, std::string> s_mapResults = {
                                                   { csv_result::_conn_timeout    , "connection timeout"       },
                                                   { csv_result::_bom_mismatch    , "BOM mismatch"             },
                                                   { csv_result::_row_items_error , "inconsistent items count" },
+                                                  { csv_result::_unknown_label   , "unknown label"            },
 
                                                   { csv_result::_wrong_protocol  , "wrong protocol"           },
                                                   { csv_result::_missing_soh     , "missing soh"              },
@@ -0,0 +1,365 @@
+/**************************************************************************************************
+ * 
+ * Copyright 2022 https://github.com/fe-dagostino
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this 
+ * software and associated documentation files (the "Software"), to deal in the Software 
+ * without restriction, including without limitation the rights to use, copy, modify, 
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to 
+ * permit persons to whom the Software is furnished to do so, subject to the following 
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies 
+ * or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE 
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR 
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *************************************************************************************************/
+
+#include "csv_numeric_column.h"
+#include "csv_scanner.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+# define CSV_NUMERIC_X86
+# include <immintrin.h>
+#endif
+
+namespace csv {
+inline namespace CSV_LIB_VERSION {
+
+/**
+ * Fields from a set of rows, where @param column may be missing.
+ */
+struct rows_source_t
+{
+  const csv_row*  pRows;
+  std::size_t     column;
+
+  inline bool get( std::size_t index, const char*& pData, std::size_t& length ) const noexcept
+  {
+    if ( column >= pRows[index].size() )
+      return false;
+
+    const csv_data_t& _data = pRows[index][column].data();
+    pData  = _data.data();
+    length = _data.length();
+    return true;
+  }
+};
+
+/**
+ * Fields stored in a csv_column_batch::column, data and offsets.
+ */
+struct column_source_t
+{
+  const char*         pData;
+  const std::size_t*  pOffsets;
+
+  inline bool get( std::size_t index, const char*& pData_, std::size_t& length ) const noexcept
+  {
+    pData_ = pData + pOffsets[index];
+    length = pOffsets[index+1] - pOffsets[index];
+    return true;
+  }
+};
+
+/**
+ * Fallback for all fields not handled by vectorized implementation.
+ */
+struct convert_generic_t
+{
+  template<typename number_t>
+  static inline bool convert( const char* pData, std::size_t length, number_t& value ) noexcept
+  { return try_parse_number( pData, length, value ); }
+};
+
+#if defined(CSV_NUMERIC_X86)
+
+/**
+ * Shuffle masks moving first N characters at the end of the register, all lanes in 
+ * front are set to zero.
+ */
+struct align_table_t
+{
+  alignas(16) int8_t  masks[17][16];
+
+  constexpr align_table_t() noexcept
+    : masks()
+  {
+    for ( int n = 0; n <= 16; ++n )
+      for ( int lane = 0; lane < 16; ++lane )
+        masks[n][lane] = (lane >= 16-n)?static_cast<int8_t>(lane-(16-n)):static_cast<int8_t>(0x80);
+  }
+};
+
+static constexpr align_table_t s_alignTable{};
+
+/**
+ * Powers of ten that are exact with a double.
+ */
+static constexpr double s_pow10[] = { 1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11, 
+                                      1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+/**
+ * Vectorized conversion with SSE4.2 for fields up to 16 digits, all other fields are 
+ * handled with convert_generic_t.
+ */
+struct convert_sse42_t
+{
+  /**
+   * Load @param length characters, reading a full register when it does not cross 
+   * a page boundary, lanes after the field are ignored.
+   */
+  __attribute__((target("sse4.2"),no_sanitize_address))
+  static inline __m128i  load( const char* pData, std::size_t length ) noexcept
+  {
+    if ( (reinterpret_cast<uintptr_t>(pData) & 4095) <= 4096-16 )
+      return _mm_loadu_si128( reinterpret_cast<const __m128i*>(pData) );
+
+    alignas(16) char _buffer[16] = {};
+    std::memcpy( _buffer, pData, length );
+    return _mm_load_si128( reinterpret_cast<const __m128i*>(_buffer) );
+  }
+
+  /**
+   * Bitmap of lanes in @param digits (characters minus '0') that are in range [0,9].
+   */
+  __attribute__((target("sse4.2")))
+  static inline uint32_t is_digit( __m128i digits ) noexcept
+  {
+    const __m128i _over = _mm_subs_epu8( digits, _mm_set1_epi8( 9 ) );
+    return static_cast<uint32_t>(_mm_movemask_epi8( _mm_cmpeq_epi8( _over, _mm_setzero_si128() ) ));
+  }
+
+  /**
+   * Move digits with @param shuffle at the end of the register, then combine pairs of 
+   * digits, pairs of 2 digits and pairs of 4 digits with multiply-add instructions.
+   */
+  __attribute__((target("sse4.2")))
+  static inline uint64_t combine( __m128i digits, __m128i shuffle ) noexcept
+  {
+    const __m128i _digits = _mm_shuffle_epi8( digits, shuffle );
+    const __m128i _2      = _mm_maddubs_epi16( _digits, _mm_setr_epi8( 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1 ) );
+    const __m128i _4      = _mm_madd_epi16( _2, _mm_setr_epi16( 100, 1, 100, 1, 100, 1, 100, 1 ) );
+    const __m128i _8      = _mm_madd_epi16( _mm_packus_epi32( _4, _4 ), _mm_setr_epi16( 10000, 1, 10000, 1, 10000, 1, 10000, 1 ) );
+
+    return static_cast<uint64_t>(static_cast<uint32_t>(_mm_extract_epi32( _8, 0 ))) * 100000000 
+         + static_cast<uint64_t>(static_cast<uint32_t>(_mm_extract_epi32( _8, 1 )));
+  }
+
+  /**
+   * Skip sign, a leading '+' is accepted as for parse_number().
+   */
+  static inline bool     sign( const char*& pData, std::size_t& length ) noexcept
+  {
+    if ( length < 2 )
+      return false;
+
+    if ( *pData == '-' )
+    {
+      ++pData; --length;
+      return true;
+    }
+
+    if ( (*pData == '+') && (pData[1] != '-') )
+    {
+      ++pData; --length;
+    }
+
+    return false;
+  }
+
+  /***/
+  __attribute__((target("sse4.2")))
+  static inline bool     convert( const char* pData, std::size_t length, int64_t& value ) noexcept
+  {
+    const char*  _pDigits  = pData;
+    std::size_t  _nDigits  = length;
+    const bool   _bNegative= sign( _pDigits, _nDigits );
+
+    if ( (_nDigits == 0) || (_nDigits > 16) )
+      return convert_generic_t::convert( pData, length, value );
+
+    const __m128i  _digits = _mm_sub_epi8( load( _pDigits, _nDigits ), _mm_set1_epi8( '0' ) );
+    const uint32_t _lanes  = (1u << _nDigits) - 1;
+
+    if ( (is_digit( _digits ) & _lanes) != _lanes )
+      return convert_generic_t::convert( pData, length, value );
+
+    const int64_t  _value  = static_cast<int64_t>(combine( _digits, _mm_load_si128( reinterpret_cast<const __m128i*>(s_alignTable.masks[_nDigits]) ) ));
+
+    value = _bNegative?-_value:_value;
+    return true;
+  }
+
+  /**
+   * Digits with an optional '.' are converted as an integer mantissa, that is exact 
+   * as a double up to 2^53, then divided by an exact power of ten so that result is 
+   * correctly rounded as with std::from_chars().
+   */
+  __attribute__((target("sse4.2")))
+  static inline bool     convert( const char* pData, std::size_t length, double& value ) noexcept
+  {
+    const char*  _pDigits  = pData;
+    std::size_t  _nChars   = length;
+    const bool   _bNegative= sign( _pDigits, _nChars );
+
+    if ( (_nChars == 0) || (_nChars > 16) )
+      return convert_generic_t::convert( pData, length, value );
+
+    const __m128i  _chars  = load( _pDigits, _nChars );
+    const __m128i  _digits = _mm_sub_epi8( _chars, _mm_set1_epi8( '0' ) );
+    const uint32_t _lanes  = (1u << _nChars) - 1;
+    const uint32_t _dot    = static_cast<uint32_t>(_mm_movemask_epi8( _mm_cmpeq_epi8( _chars, _mm_set1_epi8( '.' ) ) )) & _lanes;
+
+    if ( ((is_digit( _digits ) | _dot) & _lanes) != _lanes || (std::popcount( _dot ) > 1) || (_dot == _lanes) )
+      return convert_generic_t::convert( pData, length, value );
+
+    std::size_t _nDigits   = _nChars;
+    std::size_t _nFraction = 0;
+    __m128i     _shuffle;
+
+    if ( _dot == 0 )
+    {
+      _shuffle  = _mm_load_si128( reinterpret_cast<const __m128i*>(s_alignTable.masks[_nDigits]) );
+    }
+    else
+    {
+      const int _nDot = std::countr_zero( _dot );
+
+      --_nDigits;
+      _nFraction = _nDigits - static_cast<std::size_t>(_nDot);
+      // Digits after the dot are taken one lane ahead.
+      _shuffle   = _mm_load_si128( reinterpret_cast<const __m128i*>(s_alignTable.masks[_nDigits]) );
+      _shuffle   = _mm_sub_epi8( _shuffle, _mm_cmpgt_epi8( _shuffle, _mm_set1_epi8( static_cast<char>(_nDot-1) ) ) );
+    }
+
+    const uint64_t _mantissa = combine( _digits, _shuffle );
+    if ( _mantissa > (uint64_t(1) << 53) )
+      return convert_generic_t::convert( pData, length, value );
+
+    const double   _value = static_cast<double>(_mantissa) / s_pow10[_nFraction];
+
+    value = _bNegative?-_value:_value;
+    return true;
+  }
+};
+
+#endif
+
+/**
+ * Convert @param count fields from @param source, setting a bit in @param pErrors for 
+ * each field that is not a valid number.
+ */
+template<typename convert_t, typename number_t, typename source_t>
+__attribute__((always_inline))
+static inline std::size_t convert_fields( const source_t& source, std::size_t count, number_t* pValues, uint64_t* pErrors ) noexcept
+{
+  std::size_t _nErrors = 0;
+
+  for ( std::size_t first = 0; first < count; first += 64 )
+  {
+    const std::size_t _nLast = std::min( count, first + 64 );
+    uint64_t          _bits  = 0;
+
+    for ( std::size_t ndx = first; ndx < _nLast; ++ndx )
+    {
+      const char* _pData  = nullptr;
+      std::size_t _length = 0;
+
+      if ( (source.get( ndx, _pData, _length ) == false) || (convert_t::convert( _pData, _length, pValues[ndx] ) == false) )
+      {
+        pValues[ndx] = 0;
+        _bits       |= (uint64_t(1) << (ndx-first));
+      }
+    }
+
+    pErrors[first/64] = _bits;
+    _nErrors         += static_cast<std::size_t>(std::popcount( _bits ));
+  }
+
+  return _nErrors;
+}
+
+/***/
+template<typename number_t, typename source_t>
+static std::size_t convert_generic( const source_t& source, std::size_t count, number_t* pValues, uint64_t* pErrors ) noexcept
+{ return convert_fields<convert_generic_t>( source, count, pValues, pErrors ); }
+
+#if defined(CSV_NUMERIC_X86)
+
+/***/
+template<typename number_t, typename source_t>
+__attribute__((target("sse4.2")))
+static std::size_t convert_sse42( const source_t& source, std::size_t count, number_t* pValues, uint64_t* pErrors ) noexcept
+{ return convert_fields<convert_sse42_t>( source, count, pValues, pErrors ); }
+
+#endif
+
+template<Column_number_t number_t>
+std::size_t csv_numeric_column<number_t>::parse( const std::vector<csv_row>& rows, std::size_t column ) noexcept
+{ return convert( rows_source_t{ rows.data(), column }, rows.size() ); }
+
+template<Column_number_t number_t>
+std::size_t csv_numeric_column<number_t>::parse( const csv_row_batch& batch, std::size_t column ) noexcept
+{ return convert( rows_source_t{ batch.rows().data(), column }, batch.size() ); }
+
+template<Column_number_t number_t>
+std::size_t csv_numeric_column<number_t>::parse( const csv_column_batch::column& column ) noexcept
+{ return convert( column_source_t{ column.data(), column.offsets().data() }, column.size() ); }
+
+template<Column_number_t number_t>
+std::size_t csv_numeric_column<number_t>::parse( const csv_column_batch& batch, std::size_t column ) noexcept
+{
+  if ( column < batch.columns() )
+    return parse( batch.get_column( column ) );
+
+  resize( batch.size() );
+  std::fill( m_vValues.begin(), m_vValues.end(), number_t() );
+  std::fill( m_vErrors.begin(), m_vErrors.end(), ~uint64_t(0) );
+  if ( batch.size() % 64 )
+    m_vErrors.back() = (uint64_t(1) << (batch.size() % 64)) - 1;
+
+  m_nErrors = batch.size();
+  return m_nErrors;
+}
+
+template<Column_number_t number_t>
+void csv_numeric_column<number_t>::resize( std::size_t count ) noexcept
+{
+  m_vValues.resize( count );
+  m_vErrors.resize( (count + 63) / 64 );
+  m_nErrors = 0;
+}
+
+template<Column_number_t number_t>
+template<typename source_t>
+std::size_t csv_numeric_column<number_t>::convert( const source_t& source, std::size_t count ) noexcept
+{
+  resize( count );
+
+#if defined(CSV_NUMERIC_X86)
+  if ( csv_scanner::get_isa() >= csv_scanner::isa_t::sse42 )
+  {
+    m_nErrors = convert_sse42( source, count, m_vValues.data(), m_vErrors.data() );
+    return m_nErrors;
+  }
+#endif
+
+  m_nErrors = convert_generic( source, count, m_vValues.data(), m_vErrors.data() );
+  return m_nErrors;
+}
+
+template class csv_numeric_column<int64_t>;
+template class csv_numeric_column<double>;
+
+} //inline namespace
+} // namespace
@@ -0,0 +1,391 @@
+/**************************************************************************************************
+ * 
+ * Copyright 2022 https://github.com/fe-dagostino
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this 
+ * software and associated documentation files (the "Software"), to deal in the Software 
+ * without restriction, including without limitation the rights to use, copy, modify, 
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to 
+ * permit persons to whom the Software is furnished to do so, subject to the following 
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies 
+ * or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE 
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR 
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *************************************************************************************************/
+
+#include "csv_parallel_reader.h"
+#include "csv_reader.h"
+#include "csv_dev_range.h"
+#include <cstring>
+#include <algorithm>
+
+namespace csv {
+inline namespace CSV_LIB_VERSION {
+
+csv_parallel_reader::csv_parallel_reader( const std::string& feedname, std::unique_ptr<csv_dev_mmap> ptrDevice, core::unique_ptr<csv_events> ptrEvents,
+                                          std::size_t nThreads, order_t eOrder, csv_uint_t nRangeSize )
+  : csv_parser( feedname, std::move(ptrDevice), std::move(ptrEvents) ),
+    m_nThreads( (nThreads==0)?std::max( 1u, std::thread::hardware_concurrency() ):nThreads ),
+    m_eOrder( eOrder ), m_nRangeSize( std::max( nRangeSize, csv_uint_t(1) ) ),
+    m_bOpen( false ), m_bEnd( false ),
+    m_pData( nullptr ), m_nLength( 0 ),
+    m_nNextRange( 0 ), m_nConsumed( 0 ), m_nCurrent( 0 ), m_nCursor( 0 ),
+    m_bStop( false )
+{}
+
+csv_parallel_reader::~csv_parallel_reader()
+{
+  close();
+}
+
+bool csv_parallel_reader::open()
+{
+  if ( m_bOpen == true )
+    return true;
+
+  // All data are acquired at once and released only on close().
+  const byte* _pData   = nullptr;
+  csv_uint_t  _nLength = 0;
+  csv_result  _result  = m_ptrDevice->acquire( _pData, _nLength );
+  if ( (_result != csv_result::_ok) && (_result != csv_result::_eof) )
+  {
+    if (m_ptrEvents != nullptr) {
+      m_ptrEvents->onError( _result );
+    }
+
+    return false;
+  }
+
+  m_pData        = reinterpret_cast<const char*>(_pData);
+  m_nLength      = _nLength;
+  m_bOpen        = true;
+  m_bEnd         = false;
+  m_bStop        = false;
+  m_nRowsCounter = 0;
+
+  if (m_ptrEvents != nullptr) {
+    m_ptrEvents->onBegin();
+  }
+
+  csv_uint_t _nFirst = 0;
+  if ( get_header().empty() )
+  {
+    // Header is read with the same rules used for all other rows.
+    _nFirst = row_end( 0 );
+
+    csv_reader  _reader( feed_name(), std::make_unique<csv_dev_range>( m_pData, _nFirst ), nullptr );
+    csv_row     _row;
+
+    _reader.copy_settings( *this );
+    _reader.read( _row );
+    if ( _reader.get_header().empty() == false )
+    {
+      set_header( static_cast<const csv_row&>(_reader.get_header()) );
+
+      if (m_ptrEvents != nullptr) {
+        m_ptrEvents->onHeader( m_vHeader );
+      }
+    }
+  }
+
+  // Split remaining data in ranges starting at the beginning of a row.
+  m_vRanges.clear();
+  while ( _nFirst < m_nLength )
+  {
+    csv_uint_t _nLast = m_nLength;
+    if ( m_nLength - _nFirst > m_nRangeSize )
+    {
+      const csv_uint_t _nOffset = _nFirst + m_nRangeSize;
+      const void*      _pPrev   = memrchr( m_pData + _nFirst, get_eol(), _nOffset - _nFirst );
+      const csv_uint_t _nLine   = (_pPrev==nullptr)?_nFirst:static_cast<csv_uint_t>(static_cast<const char*>(_pPrev) - m_pData + 1);
+
+      _nLast = row_end( _nLine );
+    }
+
+    m_vRanges.emplace_back( range_t{ _nFirst, _nLast } );
+    _nFirst = _nLast;
+  }
+
+  m_vResults.clear();
+  m_vResults.resize( m_vRanges.size() );
+  m_vParsed.assign( m_vRanges.size(), false );
+  m_qParsed.clear();
+  m_nNextRange = 0;
+  m_nConsumed  = 0;
+  m_nCurrent   = m_vRanges.size();
+  m_nCursor    = 0;
+
+  try
+  {
+    for ( std::size_t ndx = 0; ndx < std::min( m_nThreads, m_vRanges.size() ); ++ndx )
+      m_vThreads.emplace_back( &csv_parallel_reader::worker, this );
+  }
+  catch ( const std::system_error& )
+  {
+    if (m_ptrEvents != nullptr) {
+      m_ptrEvents->onError( csv_result::_no_mem );
+    }
+
+    close();
+    return false;
+  }
+
+  return true;
+}
+
+bool csv_parallel_reader::read()
+{
+  csv_row* pRow = next();
+  if ( pRow == nullptr )
+    return false;
+
+  csv_unique_ptr<csv_row> ptrRow = std::make_unique<csv_row>( std::move(*pRow) );
+
+  // Invoke event interface  
+  if (m_ptrEvents != nullptr) 
+  {
+    if ( ptrRow->size() != m_vHeader.size() )
+      m_ptrEvents->onError( csv_result::_row_items_error );
+
+    csv_unique_ptr<csv_row> ptrRetRow = m_ptrEvents->onRow( m_vHeader, std::move(ptrRow) );
+
+    if ( ptrRetRow != nullptr )
+    {
+      if ( apply_filters( *ptrRetRow, get_rows() ) )  
+      {
+        m_ptrEvents->onFilteredRow( m_vHeader, std::move(ptrRetRow) );
+      }
+    }
+  }
+
+  ++m_nRowsCounter;
+  return true;
+}
+
+bool csv_parallel_reader::read( csv_row& row )
+{
+  csv_row* pRow = next();
+  if ( pRow == nullptr )
+    return false;
+
+  // As for csv_reader, providing a buffer bypass both event and filters.
+  if ( (m_ptrEvents != nullptr) && (pRow->size() != m_vHeader.size()) )
+    m_ptrEvents->onError( csv_result::_row_items_error );
+
+  // Previous content of the row will be released by parsing threads.
+  std::swap( row, *pRow );
+
+  ++m_nRowsCounter;
+  return true;
+}
+
+bool csv_parallel_reader::close()
+{
+  {
+    std::lock_guard<std::mutex> _lock( m_mtxRanges );
+    m_bStop = true;
+  }
+  m_cvWorkers.notify_all();
+
+  for ( auto& thread : m_vThreads )
+    thread.join();
+  m_vThreads.clear();
+
+  m_vResults.clear();
+  m_vRecycle.clear();
+  m_vRanges.clear();
+  m_qParsed.clear();
+
+  if ( m_bOpen == false )
+    return false;
+
+  m_bOpen = false;
+  m_ptrDevice->release( m_nLength );
+  m_ptrDevice->close();
+  m_pData   = nullptr;
+  m_nLength = 0;
+
+  return true;
+}
+
+csv_row* csv_parallel_reader::next() noexcept
+{
+  if ( (m_bOpen == false) || (m_bEnd == true) )
+    return nullptr;
+
+  while ( true )
+  {
+    if ( m_nCurrent < m_vResults.size() )
+    {
+      rows_t& _rows = m_vResults[m_nCurrent];
+      if ( m_nCursor < _rows.size() )
+        return &_rows[m_nCursor++];
+
+      // Current range has been completely returned, so parsing threads can move 
+      // forward and release its memory, avoiding to do it in the caller thread.
+      {
+        std::lock_guard<std::mutex> _lock( m_mtxRanges );
+        m_vRecycle.emplace_back( std::move(_rows) );
+        ++m_nConsumed;
+        m_nCurrent = m_vResults.size();
+      }
+      m_cvWorkers.notify_all();
+    }
+
+    if ( m_nConsumed == m_vRanges.size() )
+    {
+      finish();
+      return nullptr;
+    }
+
+    std::unique_lock<std::mutex> _lock( m_mtxRanges );
+    if ( m_eOrder == order_t::ordered )
+    {
+      m_cvReader.wait( _lock, [this]{ return m_vParsed[m_nConsumed] == true; } );
+      m_nCurrent = m_nConsumed;
+    }
+    else
+    {
+      m_cvReader.wait( _lock, [this]{ return m_qParsed.empty() == false; } );
+      m_nCurrent = m_qParsed.front();
+      m_qParsed.pop_front();
+    }
+    m_nCursor = 0;
+  }
+}
+
+void csv_parallel_reader::finish() noexcept
+{
+  m_bEnd = true;
+
+  if (m_ptrEvents != nullptr) {
+    m_ptrEvents->onEnd();
+  }
+}
+
+void csv_parallel_reader::worker() noexcept
+{
+  // Limit the number of ranges parsed in advance, so that memory do 
+  // not grow when the caller is slower than parsing threads.
+  const std::size_t _nWindow = 2 * m_nThreads;
+
+  while ( true )
+  {
+    std::size_t          _ndx = 0;
+    std::vector<rows_t>  _recycle;
+    {
+      std::unique_lock<std::mutex> _lock( m_mtxRanges );
+      m_cvWorkers.wait( _lock, [this,_nWindow]{ 
+          return m_bStop || (m_nNextRange == m_vRanges.size()) || (m_nNextRange < m_nConsumed + _nWindow); 
+        } );
+
+      if ( m_bStop || (m_nNextRange == m_vRanges.size()) )
+        return;
+
+      _ndx = m_nNextRange++;
+      _recycle.swap( m_vRecycle );
+    }
+
+    _recycle.clear();
+
+    rows_t _rows;
+    parse_range( _ndx, _rows );
+
+    {
+      std::lock_guard<std::mutex> _lock( m_mtxRanges );
+      m_vResults[_ndx] = std::move(_rows);
+      m_vParsed[_ndx]  = true;
+      m_qParsed.push_back( _ndx );
+    }
+    m_cvReader.notify_one();
+  }
+}
+
+void csv_parallel_reader::parse_range( std::size_t ndx, rows_t& rows ) noexcept
+{
+  const range_t& _range = m_vRanges[ndx];
+  csv_reader     _reader( feed_name(), std::make_unique<csv_dev_range>( m_pData + _range.first, _range.last - _range.first ), nullptr );
+
+  _reader.copy_settings( *this );
+  _reader.set_header( static_cast<const csv_row&>(get_header()) );
+
+  rows.emplace_back();
+  while ( _reader.read( rows.back() ) )
+  {
+    rows.emplace_back();
+  }
+  rows.pop_back();
+}
+
+csv_uint_t csv_parallel_reader::row_end( csv_uint_t offset ) const noexcept
+{
+  while ( offset < m_nLength )
+  {
+    const char* pFirst = m_pData + offset;
+    const char* pEoL   = static_cast<const char*>(memchr( pFirst, get_eol(), m_nLength - offset ));
+    if ( pEoL == nullptr )
+      break;
+
+    offset = static_cast<csv_uint_t>(pEoL - m_pData + 1);
+
+    // Each line start with an empty field and quotes closed, so a line can be 
+    // checked without knowing previous lines.
+    if ( (allow_comments() == false) || (is_comment( pFirst, pEoL ) == false) )
+      return offset;
+  }
+
+  return m_nLength;
+}
+
+bool csv_parallel_reader::is_comment( const char* pFirst, const char* pLast ) const noexcept
+{
+  // Same rules applied by csv_parser::parse_fields() in order to 
+  // detect when a comment start.
+  bool        _bQuoteOpen = false;
+  std::size_t _nLength    = 0;
+
+  for ( ; pFirst < pLast; ++pFirst )
+  {
+    const char _ch = *pFirst;
+
+    if ( (_ch == get_comment()) && (_nLength == 0) )
+      return true;
+
+    if ( (_ch == get_delimeter()) && (_bQuoteOpen == false) ) 
+    {
+      _nLength = 0;
+      continue;
+    }
+
+    if ( _ch == get_quote() )
+    {
+      if ( (_nLength == 0) && (_bQuoteOpen == false) )
+      { _bQuoteOpen = true; }
+      else if ( (_nLength != 0) && (_bQuoteOpen == true) )
+      { _bQuoteOpen = false; }        
+    }
+
+    if ( skip_whitespaces() && (_bQuoteOpen == false) )
+    {
+      if ( memchr( get_whitespaces().c_str(), _ch, get_whitespaces().length() ) == nullptr )
+        ++_nLength;
+    }
+    else
+    {
+      ++_nLength;
+    }
+  }
+
+  return false;
+}
+
+} //inline namespace
+} // namespace
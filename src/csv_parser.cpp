@@ -23,6 +23,8 @@
 
 #include "csv_parser.h"
 #include <cstring>
+#include <algorithm>
+#include <limits>
 
 namespace csv {
 inline namespace CSV_LIB_VERSION {
@@ -39,197 +41,328 @@ csv_parser::csv_parser( const std::string& feedname, core::unique_ptr<csv_device
     m_bSkipWhitespaces(true),
     m_bTrimAll(true),
     m_bAllowComments(false),
+    m_eEngine(engine::state_machine),
+    m_nOtherColumns(column_keep),
+    m_nTestColumns(0),
+    m_bRejectAll(false),
+    m_bColumnsChanged(false),
+    m_pRecvData( nullptr ),
+    m_bAcquire( true ),
+    m_bAcquired( false ),
     m_recvCachedBytes( 0 ),
     m_recvCacheCursor( 0 ),
+    m_nRecvOffset( 0 ),
+    m_nRowOffset( 0 ),
+    m_pRowIndex( nullptr ),
     m_nRowsCounter( 0 )
 {
 }
 
+csv_result csv_parser::parse_fields() noexcept
+{ return parse_fields( runtime_dialect( *this ) ); }
+
+csv_result csv_parser::receive() noexcept
+{
+  // Data in the cache have been consumed, so they are behind current offset.
+  m_nRecvOffset += m_recvCachedBytes;
+
+  // All data previously acquired have been consumed.
+  if ( m_bAcquired == true )
+  {
+    m_ptrDevice->release( m_recvCachedBytes );
+    m_bAcquired = false;
+  }
+
+  if ( m_bAcquire == true )
+  {
+    csv_result _result = m_ptrDevice->acquire( m_pRecvData, m_recvCachedBytes );
+    if ( _result != csv_result::_not_implemented )
+    {
+      m_bAcquired = (m_recvCachedBytes > 0);
+      return _result;
+    }
+
+    // Device do not support acquire(), so recv() will be used from now on.
+    m_bAcquire = false;
+  }
+
+  m_pRecvData       = m_recvCache.data();
+  m_recvCachedBytes = m_recvCache.size();
+  return m_ptrDevice->recv( m_recvCache.data(), m_recvCachedBytes );
+}
+
 csv_result csv_parser::parse_row( csv_row& row ) noexcept
 {
-  char          _ch{'\0'};
-  csv_result    _retVal = csv_result::_ok;
+  csv_result _retVal = parse_fields();
+
+  if ( get_header().size() != 0 )
+    row.reserve(get_header().size());
 
-  bool          _bEoL       = false;
-  bool          _bAddField  = false;
-  bool          _bSkipLine  = false;
-  bool          _bQuoted    = false;
-  bool          _bQuoteOpen = false;
+  // Fields already in the row are reused, so that reading always in the same 
+  // row (or batch) allocates memory only when a field is larger than before.
+  row.resize( m_vFields.size() );
+
+  for ( std::size_t ndx = 0; ndx < m_vFields.size(); ++ndx )
+  {
+    const field_span_t& field = m_vFields[ndx];
+
+    row[ndx].data().assign( m_sData.data()+field.offset, field.length );
+    row[ndx].hasquotes( field.quoted );
+  }
+
+  return _retVal;
+}
+
+csv_result csv_parser::parse_row( csv_row_view& row ) noexcept
+{
+  csv_result _retVal = parse_fields();
 
-  m_sData.clear();
   if ( row.empty() == false  )
     row.clear();
 
-  if ( get_header().size() != 0 )
-    row.reserve(get_header().size());
+  // No copy here, fields refer to m_sData and will be valid until next read.
+  for ( const auto& field : m_vFields )
+  {
+    row.emplace_back( std::string_view(m_sData.data()+field.offset,field.length), field.quoted );
+  }
 
-  do
+  return _retVal;
+}
+
+
+csv_result csv_parser::parse_row( csv_row_batch& batch ) noexcept
+{
+  csv_result _retVal = parse_row( batch.next() );
+
+  // Storage for the row is kept in the batch.
+  if ( _retVal != csv_result::_ok )
+    batch.pop_back();
+
+  return _retVal;
+}
+
+csv_result csv_parser::parse_row( csv_column_batch& batch ) noexcept
+{
+  csv_result _retVal = parse_fields();
+
+  if ( _retVal != csv_result::_ok )
+    return _retVal;
+
+  for ( const auto& field : m_vFields )
   {
-    if ( m_recvCacheCursor == m_recvCachedBytes )
-    {
-      m_recvCachedBytes = m_recvCache.size();
-      csv_result _result = m_ptrDevice->recv( m_recvCache.data(), m_recvCachedBytes );
-      if ( (_result != csv_result::_ok) && (m_recvCachedBytes==0) ) {
-        _retVal = _result;
-        
-        if (_result != csv_result::_eof) {
-          if (m_ptrEvents != nullptr) {
-            m_ptrEvents->onError( _result );
-          }
-        }
+    batch.append( m_sData.data()+field.offset, field.length, field.quoted );
+  }
+  batch.end_row();
 
-        break;
-      }
-      m_recvCacheCursor = 0; 
-    }
+  return _retVal;
+}
 
-    _ch = static_cast<char>(m_recvCache[m_recvCacheCursor++]);
+template<typename batch_t>
+csv_result csv_parser::parse_batch( batch_t& batch, std::size_t nMaxRows ) noexcept
+{
+  csv_result _retVal = csv_result::_ok;
 
-    // disabled by default, but different scientific data sources contains  
-    // comment starting with '#' character
-    if ( allow_comments() == true ) [[unlikely]]
-    {
-      if (_bSkipLine == true)
-      {
-        // Skip all until eol
-        if (_ch == get_eol()) {
-          _bSkipLine = false;
-        }
+  // Rows already in the batch are reused.
+  batch.clear();
 
-        continue;
-      }
-      
-      // A comment cannot be beween fields
-      if ( (_ch == get_comment()) &&  (m_sData.empty() == true)) { 
-        _bSkipLine = true; 
-        continue;
-      }
-    }
+  while ( batch.size() < nMaxRows )
+  {
+    _retVal = parse_row( batch );
+    if ( _retVal != csv_result::_ok )
+      break;
 
-    if ( (_ch == get_delimeter()) && (_bQuoteOpen == false)) {
-      _bAddField = true;
-    } else if ( _ch == get_eol() ) {
-      _bAddField = true;
-      _bEoL = true;
-    } else {
+    if ( (m_ptrEvents != nullptr) && (m_vFields.size() != m_vHeader.size()) )
+      m_ptrEvents->onError( csv_result::_row_items_error );
 
-      if (_ch == get_quote())
-      {
-        if ( (m_sData.empty() == true) && (_bQuoteOpen == false) )
-        { _bQuoteOpen = true; }
-        else if ( (m_sData.empty() == false) && (_bQuoteOpen == true) )
-        { _bQuoteOpen = false; }        
-      }
+    row_parsed();
+  }
 
-      if ( skip_whitespaces() && (_bQuoteOpen == false) )
-      {
-        // Note using memchr() instead of get_whitespaces().find_first_of(_ch) != std::string::npos )
-        // with a file of 6.8 GB benchmarks show that .find_first_of(_ch) slow down overall result for ~2 seconds.
-        // Reference file used for benckmarks can be found at the following address https://www.kaggle.com/devendra416/ddos-datasets 
-        // at 17 May 2022 its size is 6.8 GB.
-        if ( memchr( get_whitespaces().c_str(), _ch, get_whitespaces().length() ) == nullptr )
-        {
-          m_sData.push_back(_ch);
-        }
-      }
-      else
-      {
-        m_sData.push_back(_ch);
-      } 
-    } // end else
+  return _retVal;
+}
 
-    if ( _bAddField == true )
-    {
-      const char* pFirst = nullptr;
-      const char* pLast  = nullptr;
-      size_t      length = m_sData.length();
+csv_result csv_parser::seek( csv_uint_t nOffset, std::size_t nRow ) noexcept
+{
+  if ( m_bAcquired == true )
+  {
+    m_ptrDevice->release( m_recvCachedBytes );
+    m_bAcquired = false;
+  }
 
-      if (m_sData.empty()==false)
-      {
-        pFirst = m_sData.data();
-        pLast  = &pFirst[m_sData.length()-1];
+  csv_result _result = m_ptrDevice->seek( nOffset );
+  if ( _result != csv_result::_ok )
+    return _result;
 
-        trim_all( pFirst, pLast, length );
-       
-        _bQuoted = is_quoted ( pFirst, pLast, length );
-      }
+  // Data in the cache, if any, do not belong to the new position.
+  m_recvCachedBytes = m_recvCacheCursor = 0;
+  m_nRecvOffset     = m_nRowOffset      = nOffset;
+  m_nRowsCounter    = nRow;
+  m_eState          = Status::eReadRows;
 
-      // A temporary object csv_field will be instantiated with
-      // m_sData that is subject to copy constructor and then
-      // temporary object will be moved inside the container.
-      row.emplace_back( csv_field( csv_data<char,size_t>(pFirst,length), _bQuoted ) );
-      
-      m_sData.clear();
-      _bQuoted = _bAddField = _bQuoteOpen = false;
-    }
+  return csv_result::_ok;
+}
+
+void csv_parser::copy_settings( const csv_parser& parser ) noexcept
+{
+  set_delimeter   ( parser.get_delimeter()    );
+  set_quote       ( parser.get_quote()        );
+  set_eol         ( parser.get_eol()          );
+  set_comment     ( parser.get_comment()      );
+  set_whitespaces ( parser.get_whitespaces()  );
+  skip_whitespaces( parser.skip_whitespaces() );
+  trim_all        ( parser.trim_all()         );
+  allow_comments  ( parser.allow_comments()   );
+  set_engine      ( parser.get_engine()       );
+  set_projection  ( parser.get_projection()   );
+  clear_predicates();
+  for ( const auto& predicate : parser.get_predicates() )
+    add_predicate( predicate );
+}
+
+void csv_parser::update_dialect() noexcept
+{
+  m_scanUnquoted.clear();
+  m_scanUnquoted.insert( get_delimeter() );
+  m_scanUnquoted.insert( get_eol() );
+  m_scanUnquoted.insert( get_quote() );
+  if ( allow_comments() )
+    m_scanUnquoted.insert( get_comment() );
+  if ( skip_whitespaces() )
+    m_scanUnquoted.insert( get_whitespaces() );
+
+  // When quotes are open delimiter, comment and whitespaces are part of the field.
+  m_scanQuoted.clear();
+  m_scanQuoted.insert( get_eol() );
+  m_scanQuoted.insert( get_quote() );
+
+  m_dfa.build( get_delimeter(), get_quote(), get_eol(), get_comment(), allow_comments(), 
+               get_whitespaces(), skip_whitespaces() );
+
+  if ( m_eEngine == engine::structural_index )
+  {
+    m_index.set_dialect( get_delimeter(), get_quote(), get_eol(), 
+                         allow_comments()?std::string(1,get_comment()):std::string(), 
+                         skip_whitespaces()?get_whitespaces():std::string() );
+    // Data already in the cache need to be indexed again.
+    m_index.build( reinterpret_cast<const char*>(m_pRecvData), m_recvCachedBytes );
+  }
+
+  m_bDialectChanged = false;
+}
+
+void csv_parser::update_columns() noexcept
+{
+  const bool _bProject = (m_vProjectionLabels.empty() == false);
 
-  } while (_bEoL==false);
+  m_vColumnFlags.clear();
+  m_vColumnPredicates.clear();
+  m_nOtherColumns = _bProject?0:column_keep;
+  m_nTestColumns  = 0;
+  m_bRejectAll    = false;
 
-  /////////////////////////////////////////////////////////
-  // Intended to manage last data source row where line
-  // terminator (EOL) could be missed then we just got EoF.
-  if ( m_sData.empty() == false )
+  if ( _bProject || (m_vPredicates.empty() == false) )
   {
-    const char* pFirst = nullptr;
-    const char* pLast  = nullptr;
-    size_t      length = m_sData.length();
+    m_vColumnFlags.resize( m_vHeader.size(), m_nOtherColumns );
+    m_vColumnPredicates.resize( m_vHeader.size() );
 
-    if (m_sData.empty()==false)
+    for ( const auto& label : m_vProjectionLabels )
     {
-      pFirst = m_sData.data();
-      pLast  = &pFirst[m_sData.length()-1];
+      const csv_header::field_index_t _nIndex = m_vHeader.get_index( csv_data_t( label.data(), label.length() ) );
+      if ( _nIndex >= 0 )
+        m_vColumnFlags[static_cast<std::size_t>(_nIndex)] |= column_keep;
+    }
+
+    for ( std::size_t ndx = 0; ndx < m_vPredicates.size(); ++ndx )
+    {
+      const std::string&              label   = m_vPredicates[ndx].label();
+      const csv_header::field_index_t _nIndex = m_vHeader.get_index( csv_data_t( label.data(), label.length() ) );
+      if ( _nIndex >= 0 )
+      {
+        m_vColumnFlags[static_cast<std::size_t>(_nIndex)] |= column_test;
+        m_vColumnPredicates[static_cast<std::size_t>(_nIndex)].push_back( ndx );
+        m_nTestColumns = std::max( m_nTestColumns, static_cast<std::size_t>(_nIndex) + 1 );
+        continue;
+      }
 
-      trim_all( pFirst, pLast, length );
-      
-      _bQuoted = is_quoted ( pFirst, pLast, length );
+      // Column is missing in all rows.
+      if ( m_vPredicates[ndx].test( std::string_view() ) == false )
+        m_bRejectAll = true;
+
+      if ( m_ptrEvents != nullptr )
+        m_ptrEvents->onError( csv_result::_unknown_label );
     }
 
-    // A temporary object csv_field will be instantiated with
-    // m_sData that is subject to copy constructor and then
-    // temporary object will be moved inside the container.
-    row.emplace_back( csv_field( csv_data<char,size_t>(pFirst,length), _bQuoted ) );    
-    
-    m_sData.clear();  
+    if ( m_bRejectAll == true )
+      m_nTestColumns = std::numeric_limits<std::size_t>::max();
   }
 
-  return _retVal;
+  m_bColumnsChanged = false;
 }
 
-void csv_parser::trim_all( const char* & pFirst, const char* & pLast, size_t& length ) const noexcept
+bool csv_parser::select_field( std::size_t index, uint8_t flags ) noexcept
 {
-  if ( trim_all() == true )
+  field_span_t& field     = m_vFields.back();
+  bool          _bRetVal  = true;
+
+  if ( flags & column_test )
   {
-    while ( *pFirst == ' ' ) { ++pFirst; --length; }
+    const std::string_view _sField( m_sData.data()+field.offset, field.length );
 
-    if ( length > 0 ) {
-      while ( *pLast  == ' ' ) { --pLast;  --length; } 
-    } else {
-      pLast = pFirst;
+    for ( const std::size_t ndx : m_vColumnPredicates[index] )
+    {
+      if ( m_vPredicates[ndx].test( _sField ) == false )
+      {
+        _bRetVal = false;
+        break;
+      }
     }
   }
+
+  // Field copied only to check predicates.
+  if ( (flags & column_keep) == 0 )
+  {
+    field.length = 0;
+    field.quoted = false;
+  }
+
+  return _bRetVal;
 }
 
-bool csv_parser::is_quoted( const char* & pFirst, const char* & pLast, size_t& length ) const noexcept
+bool csv_parser::select_missing( std::size_t first ) const noexcept
 {
-  // The first condition consider when we have a single character that match with get_quote()
-  // in fact in such case content of the field shall be considered not quoted.
-  if ( (pFirst != pLast) && (*pFirst == get_quote()) && (*pLast == get_quote()) )
+  if ( m_bRejectAll == true )
+    return false;
+
+  for ( std::size_t index = first; index < m_nTestColumns; ++index )
   {
-    pFirst++; pLast--;
-    length -= 2;
-    return true;
+    if ( (m_vColumnFlags[index] & column_test) == 0 )
+      continue;
+
+    for ( const std::size_t ndx : m_vColumnPredicates[index] )
+    {
+      if ( m_vPredicates[ndx].test( std::string_view() ) == false )
+        return false;
+    }
   }
 
-  return false;
+  return true;
 }
 
 csv_result  csv_parser::parse( ) noexcept
-{ return parse(nullptr); }
+{ return parse(nullptr,nullptr,nullptr,nullptr,0); }
 
 csv_result  csv_parser::parse( csv_row& row ) noexcept
-{ return parse(&row); }
+{ return parse(&row,nullptr,nullptr,nullptr,0); }
+
+csv_result  csv_parser::parse( csv_row_view& row ) noexcept
+{ return parse(nullptr,&row,nullptr,nullptr,0); }
+
+csv_result  csv_parser::parse( csv_row_batch& batch, std::size_t nMaxRows ) noexcept
+{ return parse(nullptr,nullptr,&batch,nullptr,nMaxRows); }
+
+csv_result  csv_parser::parse( csv_column_batch& batch, std::size_t nMaxRows ) noexcept
+{ return parse(nullptr,nullptr,nullptr,&batch,nMaxRows); }
 
-csv_result  csv_parser::parse( csv_row* row ) noexcept
+csv_result  csv_parser::parse( csv_row* row, csv_row_view* view, csv_row_batch* batch, csv_column_batch* columns, std::size_t nMaxRows ) noexcept
 {
   csv_result    _res   = csv_result::_ok;
   bool          _bExit = false;
@@ -241,6 +374,7 @@ csv_result  csv_parser::parse( csv_row* row ) noexcept
       case Status::eStart: 
       {
         m_nRowsCounter = 0;
+        m_nRecvOffset  = m_nRowOffset = 0;
 
         if (m_ptrEvents != nullptr) {
           m_ptrEvents->onBegin();
@@ -276,6 +410,44 @@ csv_result  csv_parser::parse( csv_row* row ) noexcept
 
       case Status::eReadRows: 
       {
+        if ( (batch != nullptr) || (columns != nullptr) )
+        {
+          _res = (batch != nullptr)?parse_batch( *batch, nMaxRows ):parse_batch( *columns, nMaxRows );
+
+          const bool _bEmpty = (batch != nullptr)?batch->empty():columns->empty();
+          if ( _res == csv_result::_eof )
+          {
+            m_eState = Status::eEnd;
+            // Without rows end is processed now, otherwise with next call.
+            if ( _bEmpty )
+              break;
+          }
+
+          if ( _bEmpty == false )
+            _res = csv_result::_ok;
+
+          _bExit = true;
+          break;
+        }
+
+        if ( view != nullptr )
+        {
+          // Same as providing a buffer, both event and filters are bypassed.
+          _res = parse_row( *view );
+          if ( _res == csv_result::_ok  )
+          {
+            if ( (m_ptrEvents != nullptr) && (view->size() != m_vHeader.size()) )
+              m_ptrEvents->onError( csv_result::_row_items_error );
+
+            row_parsed();
+            _bExit = true;
+          }
+          else if ( _res == csv_result::_eof ){
+            m_eState = Status::eEnd;
+          }
+          break;
+        }
+
         csv_unique_ptr<csv_row> ptrRow = (row==nullptr)?std::make_unique<csv_row>():nullptr;
         csv_row&                rRow   = (row==nullptr)?(*ptrRow):(*row);
 
@@ -309,7 +481,7 @@ csv_result  csv_parser::parse( csv_row* row ) noexcept
             }
           }
 
-          ++m_nRowsCounter;
+          row_parsed();
           _bExit = true;
         }
         else if ( _res == csv_result::_eof ){
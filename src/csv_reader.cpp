@@ -50,6 +50,75 @@ bool csv_reader::read( csv_row& row )
   return (_res == csv_result::_ok);
 }
 
+bool csv_reader::read( csv_row_view& row ) 
+{
+  csv_result _res = parse( row );
+
+  return (_res == csv_result::_ok);
+}
+
+bool csv_reader::read_batch( csv_row_batch& batch, std::size_t nMaxRows )
+{
+  csv_result _res = parse( batch, nMaxRows );
+
+  return (_res == csv_result::_ok) && (batch.empty() == false);
+}
+
+bool csv_reader::read_batch( csv_column_batch& batch, std::size_t nMaxRows )
+{
+  csv_result _res = parse( batch, nMaxRows );
+
+  return (_res == csv_result::_ok) && (batch.empty() == false);
+}
+
+bool csv_reader::read_batch( std::size_t nMaxRows )
+{
+  if ( read_batch( m_batch, nMaxRows ) == false )
+    return false;
+
+  if ( m_ptrEvents != nullptr )
+  {
+    // Filters, if any, are applied to all rows before notification.
+    if ( m_filters.empty() == false )
+    {
+      const std::size_t _nFirstRow = get_rows() - m_batch.size();
+
+      for ( std::size_t ndx = 0; ndx < m_batch.size(); ++ndx )
+        apply_filters( m_batch[ndx], _nFirstRow + ndx );
+    }
+
+    m_ptrEvents->onRows( get_header(), m_batch.rows() );
+  }
+
+  return true;
+}
+
+bool csv_reader::seek_row( std::size_t nRow )
+{
+  const csv_row_index* _pIndex = get_row_index();
+  if ( (_pIndex == nullptr) || _pIndex->empty() )
+    return false;
+
+  // Header is not read again after seek(), so it must be known before.
+  if ( get_header().empty() && (read( m_rowView ) == false) )
+    return false;
+
+  std::size_t _nRow    = 0;
+  csv_uint_t  _nOffset = 0;
+  _pIndex->find( nRow, _nRow, _nOffset );
+
+  if ( seek( _nOffset, _nRow ) != csv_result::_ok )
+    return false;
+
+  while ( _nRow++ < nRow )
+  {
+    if ( read( m_rowView ) == false )
+      return false;
+  }
+
+  return true;
+}
+
 bool csv_reader::close()
 {
   return true; 
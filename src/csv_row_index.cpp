@@ -0,0 +1,177 @@
+/**************************************************************************************************
+ * 
+ * Copyright 2022 https://github.com/fe-dagostino
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this 
+ * software and associated documentation files (the "Software"), to deal in the Software 
+ * without restriction, including without limitation the rights to use, copy, modify, 
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to 
+ * permit persons to whom the Software is furnished to do so, subject to the following 
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies 
+ * or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE 
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR 
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *************************************************************************************************/
+
+#include "csv_row_index.h"
+#include <cstdio>
+#include <cstring>
+#include <sys/stat.h>
+
+namespace csv {
+inline namespace CSV_LIB_VERSION {
+
+/**
+ * Sidecar header, followed by offsets as LEB128 deltas.
+ */
+struct row_index_header_t
+{
+  char      magic[6];
+  uint16_t  version;
+  uint64_t  file_size;
+  int64_t   mtime_sec;
+  int64_t   mtime_nsec;
+  uint64_t  step;
+  uint64_t  rows;
+  uint64_t  count;
+};
+
+static constexpr char     s_magic[6] = { 'C', 'S', 'V', 'I', 'D', 'X' };
+static constexpr uint16_t s_version  = 1;
+
+/***/
+static bool datafile_info( const std::string& datafile, row_index_header_t& header ) noexcept
+{
+  struct stat _stat;
+  if ( stat( datafile.c_str(), &_stat ) != 0 )
+    return false;
+
+  memcpy( header.magic, s_magic, sizeof(s_magic) );
+  header.version    = s_version;
+  header.file_size  = static_cast<uint64_t>(_stat.st_size);
+  header.mtime_sec  = static_cast<int64_t>(_stat.st_mtim.tv_sec);
+  header.mtime_nsec = static_cast<int64_t>(_stat.st_mtim.tv_nsec);
+  return true;
+}
+
+csv_result csv_row_index::save( const std::string& sidecar, const std::string& datafile ) const noexcept
+{
+  row_index_header_t _header{};
+  if ( datafile_info( datafile, _header ) == false )
+    return csv_result::_access;
+
+  _header.step  = m_nStep;
+  _header.rows  = m_nRows;
+  _header.count = m_vOffsets.size();
+
+  std::vector<uint8_t> _vData;
+  _vData.reserve( m_vOffsets.size() * 3 );
+
+  csv_uint_t _nPrev = 0;
+  for ( csv_uint_t offset : m_vOffsets )
+  {
+    csv_uint_t _delta = offset - _nPrev;
+    _nPrev = offset;
+
+    while ( _delta >= 0x80 )
+    {
+      _vData.push_back( static_cast<uint8_t>(_delta | 0x80) );
+      _delta >>= 7;
+    }
+    _vData.push_back( static_cast<uint8_t>(_delta) );
+  }
+
+  FILE* pFile = fopen( sidecar.c_str(), "wb" );
+  if ( pFile == nullptr )
+    return csv_result::_access;
+
+  const bool _bWritten = (fwrite( &_header, sizeof(_header), 1, pFile ) == 1) &&
+                         (_vData.empty() || (fwrite( _vData.data(), 1, _vData.size(), pFile ) == _vData.size()));
+
+  if ( (fclose( pFile ) != 0) || (_bWritten == false) )
+    return csv_result::_access;
+
+  return csv_result::_ok;
+}
+
+csv_result csv_row_index::load( const std::string& sidecar, const std::string& datafile ) noexcept
+{
+  row_index_header_t _expected{};
+  if ( datafile_info( datafile, _expected ) == false )
+    return csv_result::_access;
+
+  FILE* pFile = fopen( sidecar.c_str(), "rb" );
+  if ( pFile == nullptr )
+    return csv_result::_access;
+
+  row_index_header_t _header{};
+  if ( fread( &_header, sizeof(_header), 1, pFile ) != 1 )
+  {
+    fclose( pFile );
+    return csv_result::_cfg_error;
+  }
+
+  if ( (memcmp( _header.magic, s_magic, sizeof(s_magic) ) != 0) || (_header.version != s_version) ||
+       (_header.file_size != _expected.file_size) || 
+       (_header.mtime_sec != _expected.mtime_sec) || (_header.mtime_nsec != _expected.mtime_nsec) ||
+       (_header.step == 0) || (_header.count > _header.rows) )
+  {
+    fclose( pFile );
+    return csv_result::_cfg_error;
+  }
+
+  std::vector<uint8_t> _vData;
+  uint8_t              _buffer[to_bytes<64>::KBytes];
+  std::size_t          _nRead = 0;
+  while ( (_nRead = fread( _buffer, 1, sizeof(_buffer), pFile )) > 0 )
+    _vData.insert( _vData.end(), _buffer, _buffer + _nRead );
+
+  fclose( pFile );
+
+  // Each offset is stored with one byte at least, so a larger count is not trusted for reserve().
+  if ( _header.count > _vData.size() )
+    return csv_result::_cfg_error;
+
+  std::vector<csv_uint_t> _vOffsets;
+  _vOffsets.reserve( _header.count );
+
+  csv_uint_t _nPrev  = 0;
+  csv_uint_t _nDelta = 0;
+  unsigned   _nShift = 0;
+
+  for ( std::size_t ndx = 0; (ndx < _vData.size()) && (_nShift < 64) && (_vOffsets.size() < _header.count); ++ndx )
+  {
+    _nDelta |= static_cast<csv_uint_t>(_vData[ndx] & 0x7F) << _nShift;
+    _nShift += 7;
+
+    if ( (_vData[ndx] & 0x80) == 0 )
+    {
+      _nPrev += _nDelta;
+      _vOffsets.push_back( _nPrev );
+      _nDelta = 0;
+      _nShift = 0;
+    }
+  }
+
+  // Offsets are not compared with the file size, since for compressed files they refer 
+  // to decompressed data; an offset past the end is reported by seek_row().
+  if ( _vOffsets.size() != _header.count )
+    return csv_result::_cfg_error;
+
+  m_nStep    = _header.step;
+  m_nRows    = _header.rows;
+  m_vOffsets = std::move(_vOffsets);
+
+  return csv_result::_ok;
+}
+
+} //inline namespace
+} // namespace
@@ -0,0 +1,334 @@
+/**************************************************************************************************
+ * 
+ * Copyright 2022 https://github.com/fe-dagostino
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this 
+ * software and associated documentation files (the "Software"), to deal in the Software 
+ * without restriction, including without limitation the rights to use, copy, modify, 
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to 
+ * permit persons to whom the Software is furnished to do so, subject to the following 
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies 
+ * or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE 
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR 
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *************************************************************************************************/
+
+#include "csv_scanner.h"
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+# define CSV_SCANNER_X86
+# include <immintrin.h>
+#endif
+
+namespace csv {
+inline namespace CSV_LIB_VERSION {
+
+/***/
+static csv_scanner::isa_t  detect_isa() noexcept
+{
+#if defined(CSV_SCANNER_X86)
+  __builtin_cpu_init();
+
+  if ( __builtin_cpu_supports("avx512bw") )
+    return csv_scanner::isa_t::avx512;
+  if ( __builtin_cpu_supports("avx2") )
+    return csv_scanner::isa_t::avx2;
+  if ( __builtin_cpu_supports("sse4.2") )
+    return csv_scanner::isa_t::sse42;
+#endif
+  return csv_scanner::isa_t::scalar;
+}
+
+/***/
+static csv_scanner::isa_t& default_isa() noexcept
+{
+  static csv_scanner::isa_t s_eIsa = detect_isa();
+  return s_eIsa;
+}
+
+csv_scanner::csv_scanner() noexcept
+{
+  clear();
+}
+
+void csv_scanner::clear() noexcept
+{
+  m_table.fill(false);
+  m_needles.fill('\0');
+  m_nNeedles = 0;
+  m_nibbleLo.fill(0);
+  m_nibbleHi.fill(0);
+  m_nNibbleGroups = 0;
+
+  update();
+}
+
+void csv_scanner::insert( char ch ) noexcept
+{
+  const uint8_t _ch = static_cast<uint8_t>(ch);
+
+  if ( m_table[_ch] == true )
+    return;
+
+  m_table[_ch] = true;
+
+  // SSE4.2 compare up to 16 characters at once, m_nNeedles greater 
+  // than m_needles.size() just disable SSE4.2 implementation.
+  if ( m_nNeedles < m_needles.size() )
+    m_needles[m_nNeedles] = ch;
+  ++m_nNeedles;
+
+  // Each distinct high nibble require its own bit, so no more than
+  // 8 groups can be represented, more groups disable nibbles implementation.
+  const uint8_t _hi = (_ch >> 4);
+  const uint8_t _lo = (_ch & 0x0F);
+  if ( m_nibbleHi[_hi] == 0 ) 
+  {
+    if ( m_nNibbleGroups < 8 )
+    {
+      // Tables are replicated on each 128 bits lane as required by vpshufb.
+      for ( std::size_t _lane = 0; _lane < m_nibbleHi.size(); _lane += 16 )
+        m_nibbleHi[_lane+_hi] = static_cast<uint8_t>(1u << m_nNibbleGroups);
+    }
+    ++m_nNibbleGroups;
+  }
+  for ( std::size_t _lane = 0; _lane < m_nibbleLo.size(); _lane += 16 )
+    m_nibbleLo[_lane+_lo] |= m_nibbleHi[_hi];
+
+  update();
+}
+
+void csv_scanner::insert( const std::string& chars ) noexcept
+{
+  for ( char ch : chars )
+    insert( ch );
+}
+
+void csv_scanner::update() noexcept
+{
+  const isa_t _isa       = default_isa();
+  const bool  _bNibbles  = (m_nNibbleGroups <= 8);
+  const bool  _bNeedles  = (m_nNeedles      <= m_needles.size());
+
+  if      ( (_isa >= isa_t::avx512) && _bNibbles )
+  { m_pfnFind = &find_avx512; m_pfnMask = &mask_avx512; }
+  else if ( (_isa >= isa_t::avx2  ) && _bNibbles )
+  { m_pfnFind = &find_avx2;   m_pfnMask = &mask_avx2;   }
+  else if ( (_isa >= isa_t::sse42 ) && _bNeedles )
+  { m_pfnFind = &find_sse42;  m_pfnMask = &mask_sse42;  }
+  else
+  { m_pfnFind = &find_scalar; m_pfnMask = &mask_scalar; }
+}
+
+csv_scanner::isa_t csv_scanner::get_isa() noexcept
+{ return default_isa(); }
+
+bool csv_scanner::set_isa( isa_t isa ) noexcept
+{
+  if ( is_supported(isa) == false )
+    return false;
+
+  default_isa() = isa;
+  return true;
+}
+
+bool csv_scanner::is_supported( isa_t isa ) noexcept
+{ return (isa <= detect_isa()); }
+
+const char* csv_scanner::isa_name( isa_t isa ) noexcept
+{
+  switch (isa)
+  {
+    case isa_t::sse42 : return "SSE4.2";
+    case isa_t::avx2  : return "AVX2";
+    case isa_t::avx512: return "AVX-512BW";
+    default:
+    break;
+  }
+
+  return "scalar";
+}
+
+const char* csv_scanner::find_scalar( const csv_scanner& scanner, const char* pFirst, const char* pLast ) noexcept
+{
+  const bool* _table = scanner.m_table.data();
+
+  while ( pFirst < pLast )
+  {
+    if ( _table[static_cast<uint8_t>(*pFirst)] )
+      return pFirst;
+    ++pFirst;
+  }
+
+  return pLast;
+}
+
+uint64_t csv_scanner::mask_scalar( const csv_scanner& scanner, const char* pBlock ) noexcept
+{
+  const bool* _table = scanner.m_table.data();
+  uint64_t    _bits  = 0;
+
+  for ( std::size_t ndx = 0; ndx < 64; ++ndx )
+    _bits |= (static_cast<uint64_t>(_table[static_cast<uint8_t>(pBlock[ndx])]) << ndx);
+
+  return _bits;
+}
+
+#if defined(CSV_SCANNER_X86)
+
+__attribute__((target("sse4.2")))
+uint64_t csv_scanner::mask_sse42( const csv_scanner& scanner, const char* pBlock ) noexcept
+{
+  const __m128i _needles  = _mm_loadu_si128( reinterpret_cast<const __m128i*>(scanner.m_needles.data()) );
+  const int     _nNeedles = static_cast<int>(scanner.m_nNeedles);
+  uint64_t      _bits     = 0;
+
+  for ( std::size_t ndx = 0; ndx < 64; ndx += 16 )
+  {
+    const __m128i _block = _mm_loadu_si128( reinterpret_cast<const __m128i*>(pBlock+ndx) );
+    const __m128i _match = _mm_cmpestrm( _needles, _nNeedles, _block, 16, 
+                                         _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_BIT_MASK );
+    _bits |= (static_cast<uint64_t>(static_cast<uint16_t>(_mm_cvtsi128_si32( _match ))) << ndx);
+  }
+
+  return _bits;
+}
+
+__attribute__((target("avx2")))
+uint64_t csv_scanner::mask_avx2( const csv_scanner& scanner, const char* pBlock ) noexcept
+{
+  const __m256i _lo   = _mm256_loadu_si256( reinterpret_cast<const __m256i*>(scanner.m_nibbleLo.data()) );
+  const __m256i _hi   = _mm256_loadu_si256( reinterpret_cast<const __m256i*>(scanner.m_nibbleHi.data()) );
+  const __m256i _0x0F = _mm256_set1_epi8( 0x0F );
+  const __m256i _zero = _mm256_setzero_si256();
+  uint64_t      _bits = 0;
+
+  for ( std::size_t ndx = 0; ndx < 64; ndx += 32 )
+  {
+    const __m256i _block = _mm256_loadu_si256( reinterpret_cast<const __m256i*>(pBlock+ndx) );
+    const __m256i _clsLo = _mm256_shuffle_epi8( _lo, _mm256_and_si256( _block, _0x0F ) );
+    const __m256i _clsHi = _mm256_shuffle_epi8( _hi, _mm256_and_si256( _mm256_srli_epi16( _block, 4 ), _0x0F ) );
+    const __m256i _match = _mm256_cmpeq_epi8( _mm256_and_si256( _clsLo, _clsHi ), _zero );
+    _bits |= (static_cast<uint64_t>(~static_cast<uint32_t>(_mm256_movemask_epi8( _match ))) << ndx);
+  }
+
+  return _bits;
+}
+
+__attribute__((target("avx512f,avx512bw")))
+uint64_t csv_scanner::mask_avx512( const csv_scanner& scanner, const char* pBlock ) noexcept
+{
+  const __m512i _lo    = _mm512_loadu_si512( scanner.m_nibbleLo.data() );
+  const __m512i _hi    = _mm512_loadu_si512( scanner.m_nibbleHi.data() );
+  const __m512i _0x0F  = _mm512_set1_epi8( 0x0F );
+  const __m512i _block = _mm512_loadu_si512( pBlock );
+  const __m512i _clsLo = _mm512_shuffle_epi8( _lo, _mm512_and_si512( _block, _0x0F ) );
+  const __m512i _clsHi = _mm512_shuffle_epi8( _hi, _mm512_and_si512( _mm512_srli_epi16( _block, 4 ), _0x0F ) );
+
+  return _mm512_test_epi8_mask( _clsLo, _clsHi );
+}
+
+__attribute__((target("sse4.2")))
+const char* csv_scanner::find_sse42( const csv_scanner& scanner, const char* pFirst, const char* pLast ) noexcept
+{
+  const __m128i _needles  = _mm_loadu_si128( reinterpret_cast<const __m128i*>(scanner.m_needles.data()) );
+  const int     _nNeedles = static_cast<int>(scanner.m_nNeedles);
+
+  while ( (pLast - pFirst) >= 16 )
+  {
+    const __m128i _block = _mm_loadu_si128( reinterpret_cast<const __m128i*>(pFirst) );
+    const int     _index = _mm_cmpestri( _needles, _nNeedles, _block, 16, 
+                                         _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_LEAST_SIGNIFICANT );
+    if ( _index < 16 )
+      return pFirst + _index;
+
+    pFirst += 16;
+  }
+
+  return find_scalar( scanner, pFirst, pLast );
+}
+
+__attribute__((target("avx2")))
+const char* csv_scanner::find_avx2( const csv_scanner& scanner, const char* pFirst, const char* pLast ) noexcept
+{
+  const __m256i _lo   = _mm256_loadu_si256( reinterpret_cast<const __m256i*>(scanner.m_nibbleLo.data()) );
+  const __m256i _hi   = _mm256_loadu_si256( reinterpret_cast<const __m256i*>(scanner.m_nibbleHi.data()) );
+  const __m256i _0x0F = _mm256_set1_epi8( 0x0F );
+  const __m256i _zero = _mm256_setzero_si256();
+
+  while ( (pLast - pFirst) >= 32 )
+  {
+    const __m256i _block = _mm256_loadu_si256( reinterpret_cast<const __m256i*>(pFirst) );
+    const __m256i _clsLo = _mm256_shuffle_epi8( _lo, _mm256_and_si256( _block, _0x0F ) );
+    const __m256i _clsHi = _mm256_shuffle_epi8( _hi, _mm256_and_si256( _mm256_srli_epi16( _block, 4 ), _0x0F ) );
+    const __m256i _match = _mm256_cmpeq_epi8( _mm256_and_si256( _clsLo, _clsHi ), _zero );
+    const uint32_t _bits = ~static_cast<uint32_t>(_mm256_movemask_epi8( _match ));
+
+    if ( _bits != 0 )
+      return pFirst + __builtin_ctz( _bits );
+
+    pFirst += 32;
+  }
+
+  return find_scalar( scanner, pFirst, pLast );
+}
+
+__attribute__((target("avx512f,avx512bw")))
+const char* csv_scanner::find_avx512( const csv_scanner& scanner, const char* pFirst, const char* pLast ) noexcept
+{
+  const __m512i _lo   = _mm512_loadu_si512( scanner.m_nibbleLo.data() );
+  const __m512i _hi   = _mm512_loadu_si512( scanner.m_nibbleHi.data() );
+  const __m512i _0x0F = _mm512_set1_epi8( 0x0F );
+
+  while ( pFirst < pLast )
+  {
+    const std::ptrdiff_t _nAvailable = (pLast - pFirst);
+    // Last block is loaded with a mask, so no bytes after pLast will be accessed.
+    const __mmask64 _valid = (_nAvailable >= 64)?~__mmask64(0):((__mmask64(1) << _nAvailable) - 1);
+    const __m512i   _block = _mm512_maskz_loadu_epi8( _valid, pFirst );
+    const __m512i   _clsLo = _mm512_shuffle_epi8( _lo, _mm512_and_si512( _block, _0x0F ) );
+    const __m512i   _clsHi = _mm512_shuffle_epi8( _hi, _mm512_and_si512( _mm512_srli_epi16( _block, 4 ), _0x0F ) );
+    const __mmask64 _bits  = _mm512_test_epi8_mask( _clsLo, _clsHi ) & _valid;
+
+    if ( _bits != 0 )
+      return pFirst + __builtin_ctzll( _bits );
+
+    pFirst += 64;
+  }
+
+  return pLast;
+}
+
+#else
+
+const char* csv_scanner::find_sse42( const csv_scanner& scanner, const char* pFirst, const char* pLast ) noexcept
+{ return find_scalar( scanner, pFirst, pLast ); }
+
+const char* csv_scanner::find_avx2( const csv_scanner& scanner, const char* pFirst, const char* pLast ) noexcept
+{ return find_scalar( scanner, pFirst, pLast ); }
+
+const char* csv_scanner::find_avx512( const csv_scanner& scanner, const char* pFirst, const char* pLast ) noexcept
+{ return find_scalar( scanner, pFirst, pLast ); }
+
+uint64_t csv_scanner::mask_sse42( const csv_scanner& scanner, const char* pBlock ) noexcept
+{ return mask_scalar( scanner, pBlock ); }
+
+uint64_t csv_scanner::mask_avx2( const csv_scanner& scanner, const char* pBlock ) noexcept
+{ return mask_scalar( scanner, pBlock ); }
+
+uint64_t csv_scanner::mask_avx512( const csv_scanner& scanner, const char* pBlock ) noexcept
+{ return mask_scalar( scanner, pBlock ); }
+
+#endif
+
+} //inline namespace
+} // namespace
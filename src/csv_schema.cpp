@@ -0,0 +1,316 @@
+/**************************************************************************************************
+ * 
+ * Copyright 2022 https://github.com/fe-dagostino
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this 
+ * software and associated documentation files (the "Software"), to deal in the Software 
+ * without restriction, including without limitation the rights to use, copy, modify, 
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to 
+ * permit persons to whom the Software is furnished to do so, subject to the following 
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies 
+ * or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE 
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR 
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *************************************************************************************************/
+
+#include "csv_schema.h"
+#include "csv_reader.h"
+#include "csv_number.h"
+#include "csv_dev_range.h"
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <unordered_set>
+
+namespace csv {
+inline namespace CSV_LIB_VERSION {
+
+/***/
+static inline bool is_digits( std::string_view value, std::size_t first, std::size_t count ) noexcept
+{
+  if ( first + count > value.length() )
+    return false;
+
+  for ( std::size_t ndx = first; ndx < first + count; ++ndx )
+    if ( (value[ndx] < '0') || (value[ndx] > '9') )
+      return false;
+
+  return true;
+}
+
+/***/
+static inline int to_int( std::string_view value, std::size_t first, std::size_t count ) noexcept
+{
+  int _value = 0;
+  for ( std::size_t ndx = first; ndx < first + count; ++ndx )
+    _value = _value * 10 + (value[ndx] - '0');
+  return _value;
+}
+
+/***/
+static inline bool is_boolean( std::string_view value ) noexcept
+{
+  bool _value = false;
+  return try_parse_bool( value.data(), value.length(), _value );
+}
+
+/**
+ * ISO 8601 date with optional time and time zone.
+ */
+static bool is_timestamp( std::string_view value ) noexcept
+{
+  // YYYY-MM-DD
+  if ( value.length() < 10 )
+    return false;
+  if ( !is_digits( value, 0, 4 ) || (value[4] != '-') || !is_digits( value, 5, 2 ) || (value[7] != '-') || !is_digits( value, 8, 2 ) )
+    return false;
+  if ( (to_int( value, 5, 2 ) < 1) || (to_int( value, 5, 2 ) > 12) || (to_int( value, 8, 2 ) < 1) || (to_int( value, 8, 2 ) > 31) )
+    return false;
+  if ( value.length() == 10 )
+    return true;
+
+  // (T| )hh:mm[:ss[.fff]]
+  if ( ((value[10] != 'T') && (value[10] != ' ')) || !is_digits( value, 11, 2 ) || (value.length() < 16) || (value[13] != ':') || !is_digits( value, 14, 2 ) )
+    return false;
+  if ( (to_int( value, 11, 2 ) > 23) || (to_int( value, 14, 2 ) > 59) )
+    return false;
+
+  std::size_t _pos = 16;
+  if ( (_pos < value.length()) && (value[_pos] == ':') )
+  {
+    if ( !is_digits( value, _pos+1, 2 ) || (to_int( value, _pos+1, 2 ) > 60) )
+      return false;
+    _pos += 3;
+
+    if ( (_pos < value.length()) && (value[_pos] == '.') )
+    {
+      const std::size_t _nFirst = ++_pos;
+      while ( (_pos < value.length()) && (value[_pos] >= '0') && (value[_pos] <= '9') )
+        ++_pos;
+      if ( _pos == _nFirst )
+        return false;
+    }
+  }
+
+  if ( _pos == value.length() )
+    return true;
+
+  // Z|(+|-)hh[:]mm
+  if ( value[_pos] == 'Z' )
+    return (_pos + 1 == value.length());
+  if ( (value[_pos] != '+') && (value[_pos] != '-') )
+    return false;
+  if ( !is_digits( value, _pos+1, 2 ) )
+    return false;
+  _pos += 3;
+  if ( (_pos < value.length()) && (value[_pos] == ':') )
+    ++_pos;
+
+  return is_digits( value, _pos, 2 ) && (_pos + 2 == value.length());
+}
+
+/**
+ * Narrowest type for both @param current and @param type.
+ */
+static inline csv_schema::type_t widen( csv_schema::type_t current, csv_schema::type_t type ) noexcept
+{
+  using type_t = csv_schema::type_t;
+
+  if ( current == type )
+    return current;
+
+  if ( ((current == type_t::integer) || (current == type_t::floating)) && 
+       ((type    == type_t::integer) || (type    == type_t::floating)) )
+    return type_t::floating;
+
+  return type_t::string;
+}
+
+/**
+ * Offset following the first eol at or after @param offset.
+ */
+static inline std::size_t next_line( const char* pData, std::size_t length, std::size_t offset, char eol ) noexcept
+{
+  if ( offset >= length )
+    return length;
+
+  const char* pEoL = static_cast<const char*>(memchr( pData + offset, eol, length - offset ));
+  return (pEoL == nullptr)?length:static_cast<std::size_t>(pEoL - pData + 1);
+}
+
+void csv_schema::add( const std::string& label, type_t type, bool nullable ) noexcept
+{
+  const int32_t _ndx = find( label );
+  if ( _ndx >= 0 )
+  {
+    m_vColumns[_ndx].type     = type;
+    m_vColumns[_ndx].nullable = nullable;
+    return;
+  }
+
+  m_vColumns.emplace_back( column_t{ label, type, nullable } );
+}
+
+int32_t csv_schema::find( std::string_view label ) const noexcept
+{
+  for ( std::size_t ndx = 0; ndx < m_vColumns.size(); ++ndx )
+    if ( m_vColumns[ndx].label == label )
+      return static_cast<int32_t>(ndx);
+
+  return -1;
+}
+
+std::vector<csv_schema::type_t> csv_schema::resolve( const csv_header& header ) const noexcept
+{
+  std::vector<type_t> _vTypes( header.size(), type_t::string );
+
+  for ( std::size_t ndx = 0; ndx < header.size(); ++ndx )
+  {
+    const int32_t _ndx = find( static_cast<std::string_view>(header.get_field(ndx).data()) );
+    if ( _ndx >= 0 )
+      _vTypes[ndx] = m_vColumns[_ndx].type;
+  }
+
+  return _vTypes;
+}
+
+const char* csv_schema::type_name( type_t type ) noexcept
+{
+  switch ( type )
+  {
+    case type_t::string    : return "string";
+    case type_t::integer   : return "integer";
+    case type_t::floating  : return "floating";
+    case type_t::boolean   : return "boolean";
+    case type_t::timestamp : return "timestamp";
+    case type_t::dictionary: return "dictionary";
+  }
+
+  return "unknown";
+}
+
+csv_schema::type_t csv_schema::classify( std::string_view value ) noexcept
+{
+  int64_t _integer  = 0;
+  double  _floating = 0;
+
+  if ( try_parse_number( value.data(), value.length(), _integer ) )
+    return type_t::integer;
+  if ( try_parse_number( value.data(), value.length(), _floating ) )
+    return type_t::floating;
+  if ( is_boolean( value ) )
+    return type_t::boolean;
+  if ( is_timestamp( value ) )
+    return type_t::timestamp;
+
+  return type_t::string;
+}
+
+csv_schema csv_schema::infer( const csv_header& header, std::span<const csv_row> rows, std::size_t nMaxDictionary ) noexcept
+{
+  csv_schema _schema;
+
+  for ( std::size_t col = 0; col < header.size(); ++col )
+  {
+    std::unordered_set<std::string_view> _setValues;
+    std::size_t                          _nValues = 0;
+    std::size_t                          _nBools  = 0;
+    bool                                 _bTyped  = false;
+    column_t                             _column{ std::string( static_cast<std::string_view>(header.get_field(col).data()) ), type_t::string, false };
+
+    for ( const auto& row : rows )
+    {
+      if ( row.size() != header.size() )
+        continue;
+
+      const std::string_view _value = static_cast<std::string_view>(row[col].data());
+      if ( _value.empty() )
+      {
+        _column.nullable = true;
+        continue;
+      }
+
+      const type_t _type = classify( _value );
+      _column.type = _bTyped?widen( _column.type, _type ):_type;
+      _bTyped      = true;
+
+      ++_nValues;
+      _nBools += is_boolean( _value )?1:0;
+      if ( _setValues.size() <= nMaxDictionary )
+        _setValues.insert( _value );
+    }
+
+    if ( _bTyped == false )
+      _column.nullable = true;
+
+    // 1 and 0 are classified as integers, they are booleans only together with true or false.
+    if ( (_column.type == type_t::string) && (_nValues > 0) && (_nBools == _nValues) )
+      _column.type = type_t::boolean;
+
+    if ( (_column.type == type_t::string) && (_nValues > 0) && 
+         (_setValues.size() <= nMaxDictionary) && (2 * _setValues.size() <= _nValues) )
+      _column.type = type_t::dictionary;
+
+    _schema.m_vColumns.push_back( std::move(_column) );
+  }
+
+  return _schema;
+}
+
+csv_schema csv_schema::infer( csv_reader& reader, std::size_t nRows, std::size_t nMaxDictionary ) noexcept
+{
+  csv_row_batch _batch;
+
+  reader.read_batch( _batch, nRows );
+
+  return infer( reader.get_header(), _batch.rows(), nMaxDictionary );
+}
+
+csv_schema csv_schema::infer( const csv_parser& parser, const char* pData, std::size_t length,
+                              std::size_t nBlocks, std::size_t nBlockSize, std::size_t nMaxDictionary ) noexcept
+{
+  std::vector<csv_row>  _vRows;
+  csv_header            _header;
+  // Same offsets for the same data.
+  std::mt19937_64       _rnd( length );
+
+  for ( std::size_t block = 0; block < std::max( nBlocks, std::size_t(1) ); ++block )
+  {
+    const std::size_t _nFirst = (block == 0)?0:next_line( pData, length, _rnd() % std::max( length, std::size_t(1) ), parser.get_eol() );
+    const std::size_t _nLast  = next_line( pData, length, std::min( length, _nFirst + nBlockSize ), parser.get_eol() );
+    if ( _nFirst >= _nLast )
+      continue;
+
+    csv_reader  _reader( "csv_schema", std::make_unique<csv_dev_range>( pData + _nFirst, static_cast<csv_uint_t>(_nLast - _nFirst) ), nullptr );
+
+    // All fields are needed, also if projection and predicates are in use.
+    _reader.copy_settings( parser );
+    _reader.set_projection( {} );
+    _reader.clear_predicates();
+    if ( block > 0 )
+      _reader.set_header( static_cast<const csv_row&>(_header) );
+
+    _vRows.emplace_back();
+    while ( _reader.read( _vRows.back() ) )
+    {
+      _vRows.emplace_back();
+    }
+    _vRows.pop_back();
+
+    if ( block == 0 )
+      _header.init( static_cast<const csv_row&>(_reader.get_header()) );
+  }
+
+  return infer( _header, _vRows, nMaxDictionary );
+}
+
+} //inline namespace
+} // namespace
@@ -0,0 +1,346 @@
+/**************************************************************************************************
+ * 
+ * Copyright 2022 https://github.com/fe-dagostino
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this 
+ * software and associated documentation files (the "Software"), to deal in the Software 
+ * without restriction, including without limitation the rights to use, copy, modify, 
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to 
+ * permit persons to whom the Software is furnished to do so, subject to the following 
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies 
+ * or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE 
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR 
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *************************************************************************************************/
+
+#include "csv_structural_index.h"
+#include <cstring>
+#include <algorithm>
+#include <bit>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+# define CSV_INDEX_X86
+# include <immintrin.h>
+#endif
+
+namespace csv {
+inline namespace CSV_LIB_VERSION {
+
+/**
+ * Prefix xor: bit N in the result is the xor of all bits from 0 up to N in @param bits, 
+ * that is 1 for each character between an opening quote (included) and a closing quote.
+ */
+static uint64_t prefix_xor_shift( uint64_t bits ) noexcept
+{
+  bits ^= (bits << 1);
+  bits ^= (bits << 2);
+  bits ^= (bits << 4);
+  bits ^= (bits << 8);
+  bits ^= (bits << 16);
+  bits ^= (bits << 32);
+  return bits;
+}
+
+#if defined(CSV_INDEX_X86)
+
+/**
+ * Carry-less multiplication by all ones compute the prefix xor with a single instruction.
+ */
+__attribute__((target("pclmul,sse2")))
+static uint64_t prefix_xor_clmul( uint64_t bits ) noexcept
+{
+  const __m128i _bits = _mm_set_epi64x( 0, static_cast<long long>(bits) );
+  const __m128i _ones = _mm_set1_epi8( static_cast<char>(0xFF) );
+  return static_cast<uint64_t>( _mm_cvtsi128_si64( _mm_clmulepi64_si128( _bits, _ones, 0 ) ) );
+}
+
+#endif
+
+#if defined(CSV_INDEX_X86)
+
+__attribute__((target("avx512f,avx512bw")))
+void csv_structural_index::classify_avx512( const csv_structural_index& index, const char* pBlock, block_t& block ) noexcept
+{
+  const __m512i _block = _mm512_loadu_si512( pBlock );
+
+  block.quote      = _mm512_cmpeq_epi8_mask( _block, _mm512_set1_epi8( index.m_cQuote     ) );
+  block.delimiter  = _mm512_cmpeq_epi8_mask( _block, _mm512_set1_epi8( index.m_cDelimiter ) );
+  block.eol        = _mm512_cmpeq_epi8_mask( _block, _mm512_set1_epi8( index.m_cEoL       ) );
+  block.comment    = index.m_bComment?_mm512_cmpeq_epi8_mask( _block, _mm512_set1_epi8( index.m_cComment ) ):0;
+  block.whitespace = index.m_scanWhitespace.mask( pBlock );
+}
+
+__attribute__((target("avx2")))
+void csv_structural_index::classify_avx2( const csv_structural_index& index, const char* pBlock, block_t& block ) noexcept
+{
+  const __m256i _quote     = _mm256_set1_epi8( index.m_cQuote     );
+  const __m256i _delimiter = _mm256_set1_epi8( index.m_cDelimiter );
+  const __m256i _eol       = _mm256_set1_epi8( index.m_cEoL       );
+  const __m256i _comment   = _mm256_set1_epi8( index.m_cComment   );
+
+  block.quote = block.delimiter = block.eol = block.comment = 0;
+  for ( std::size_t ndx = 0; ndx < 64; ndx += 32 )
+  {
+    const __m256i _block = _mm256_loadu_si256( reinterpret_cast<const __m256i*>(pBlock+ndx) );
+
+    block.quote     |= (static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8( _mm256_cmpeq_epi8( _block, _quote     ) ))) << ndx);
+    block.delimiter |= (static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8( _mm256_cmpeq_epi8( _block, _delimiter ) ))) << ndx);
+    block.eol       |= (static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8( _mm256_cmpeq_epi8( _block, _eol       ) ))) << ndx);
+    block.comment   |= (static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8( _mm256_cmpeq_epi8( _block, _comment   ) ))) << ndx);
+  }
+
+  if ( index.m_bComment == false )
+    block.comment = 0;
+  block.whitespace = index.m_scanWhitespace.mask( pBlock );
+}
+
+#endif
+
+void csv_structural_index::classify_generic( const csv_structural_index& index, const char* pBlock, block_t& block ) noexcept
+{
+  block.quote      = index.m_scanQuote.mask( pBlock );
+  block.delimiter  = index.m_scanDelimiter.mask( pBlock );
+  block.eol        = index.m_scanEoL.mask( pBlock );
+  block.comment    = index.m_scanComment.mask( pBlock );
+  block.whitespace = index.m_scanWhitespace.mask( pBlock );
+}
+
+bool csv_structural_index::has_clmul() noexcept
+{
+#if defined(CSV_INDEX_X86)
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("pclmul");
+#else
+  return false;
+#endif
+}
+
+using prefix_xor_fn_t = uint64_t (*)( uint64_t ) noexcept;
+
+/***/
+static prefix_xor_fn_t select_prefix_xor() noexcept
+{
+#if defined(CSV_INDEX_X86)
+  if ( csv_structural_index::has_clmul() )
+    return &prefix_xor_clmul;
+#endif
+  return &prefix_xor_shift;
+}
+
+static const prefix_xor_fn_t s_pfnPrefixXor = select_prefix_xor();
+
+
+csv_structural_index::csv_structural_index() noexcept
+  : m_pfnClassify(&classify_generic), 
+    m_cDelimiter(','), m_cQuote('\"'), m_cEoL('\n'), m_cComment('#'), m_bComment(false), 
+    m_bSpeculate(false), m_pData(nullptr), m_nLength(0), m_nFirstBlock(0), m_nFastBlocks(0)
+{
+}
+
+void csv_structural_index::set_dialect( char delimiter, char quote, char eol, const std::string& comments, const std::string& whitespaces ) noexcept
+{
+  m_scanDelimiter.clear();
+  m_scanDelimiter.insert( delimiter );
+  m_scanQuote.clear();
+  m_scanQuote.insert( quote );
+  m_scanEoL.clear();
+  m_scanEoL.insert( eol );
+  m_scanComment.clear();
+  m_scanComment.insert( comments );
+  // Delimiter and eol take precedence over whitespaces and a comment is always processed
+  // by csv_parser, so these characters keep only their own meaning, as the eol in the 
+  // default whitespaces. A quote that is also a whitespace is not added to the field 
+  // when closing, so it remains ambiguous.
+  std::string _whitespaces;
+  for ( char ch : whitespaces )
+  {
+    if ( (ch != delimiter) && (ch != eol) && (comments.find( ch ) == std::string::npos) )
+      _whitespaces.push_back( ch );
+  }
+  m_scanWhitespace.clear();
+  m_scanWhitespace.insert( _whitespaces );
+
+  m_cDelimiter = delimiter;
+  m_cQuote     = quote;
+  m_cEoL       = eol;
+  m_bComment   = (comments.length() == 1);
+  m_cComment   = m_bComment?comments[0]:'\0';
+
+  // Single characters are compared directly when the instruction set allow it.
+  m_pfnClassify = &classify_generic;
+#if defined(CSV_INDEX_X86)
+  if ( comments.length() <= 1 )
+  {
+    if ( csv_scanner::get_isa() >= csv_scanner::isa_t::avx512 )
+      m_pfnClassify = &classify_avx512;
+    else if ( csv_scanner::get_isa() >= csv_scanner::isa_t::avx2 )
+      m_pfnClassify = &classify_avx2;
+  }
+#endif
+
+  // Each character must have a single meaning in order to resolve quotes with bitmaps.
+  const csv_scanner* _scanners[] = { &m_scanDelimiter, &m_scanQuote, &m_scanEoL, &m_scanComment, &m_scanWhitespace };
+  m_bSpeculate = true;
+  for ( int ch = 0; ch < 256; ++ch )
+  {
+    int _nMeanings = 0;
+    for ( const csv_scanner* _scanner : _scanners )
+      _nMeanings += _scanner->contains( static_cast<char>(ch) )?1:0;
+
+    if ( _nMeanings > 1 )
+      m_bSpeculate = false;
+  }
+
+  m_vBlocks.clear();
+  m_pData       = nullptr;
+  m_nLength     = 0;
+  m_nFirstBlock = 0;
+  m_nFastBlocks = 0;
+}
+
+void csv_structural_index::build( const char* pData, std::size_t length ) noexcept
+{
+  // Bitmaps are built on demand by find(), one window at time, so that 
+  // large buffers provided by devices do not require a large index.
+  m_pData       = pData;
+  m_nLength     = length;
+  m_nFirstBlock = 0;
+  m_vBlocks.clear();
+}
+
+void csv_structural_index::index( std::size_t first ) noexcept
+{
+  const std::size_t _nBlocks = std::min( s_nWindowBlocks, (m_nLength + 63) / 64 - first );
+
+  m_vBlocks.resize( _nBlocks );
+  m_nFirstBlock = first;
+
+  for ( std::size_t ndx = 0; ndx < _nBlocks; ++ndx )
+  {
+    const std::size_t _nOffset  = (first + ndx)*64;
+    const char*       _pBlock   = m_pData + _nOffset;
+    uint64_t          _valid    = ~uint64_t(0);
+    char              _tail[64];
+
+    // Last block is copied and padded, bits after the end of data are cleared.
+    if ( (m_nLength - _nOffset) < 64 )
+    {
+      const std::size_t _nTail = m_nLength - _nOffset;
+      std::memset( _tail, 0, sizeof(_tail) );
+      std::memcpy( _tail, _pBlock, _nTail );
+      _pBlock = _tail;
+      _valid  = (uint64_t(1) << _nTail) - 1;
+    }
+
+    block_t& _block   = m_vBlocks[ndx];
+    m_pfnClassify( *this, _pBlock, _block );
+    _block.quote      &= _valid;
+    _block.delimiter  &= _valid;
+    _block.eol        &= _valid;
+    _block.whitespace &= _valid;
+    _block.comment    &= _valid;
+    _block.inside     = s_pfnPrefixXor( _block.quote );
+    _block.fast       = 0;
+    _block.mode       = mode_t::undecided;
+  }
+}
+
+void csv_structural_index::decide( std::size_t block, bool at_start, bool quote_open, bool field_empty ) noexcept
+{
+  block_t& _block = m_vBlocks[block];
+  _block.mode = mode_t::exact;
+
+  // Mask of characters inside quotes is computed from the start of the block.
+  if ( !m_bSpeculate || !at_start || (_block.comment != 0) )
+    return;
+
+  // With quotes open at the start of the block the first quote is closing.
+  const uint64_t _inside   = quote_open?~_block.inside:_block.inside;
+  const uint64_t _boundary = _block.eol | (_block.delimiter & ~_inside);
+  const uint64_t _opening  = _block.quote &  _inside;
+  const uint64_t _closing  = _block.quote & ~_inside;
+  const uint64_t _starts   = (_boundary << 1) | ((field_empty && !quote_open)?1:0);
+  const uint64_t _spaces   = _block.whitespace & ~_inside;
+
+  // Whitespaces after a closing quote are skipped, so the carry move each closing quote 
+  // to the first character after them, as for CRLF. A quote at the end of the block, or 
+  // followed by whitespaces up to the end, is lost and detected by the count.
+  const uint64_t _after    = _closing << 1;
+  const uint64_t _landing  = (((_after & _spaces) + _spaces) & ~_spaces) | (_after & ~_spaces);
+
+  // csv_parser close quotes on eol, and quotes are open only at field start, while the 
+  // closing quote must be followed by a delimiter or eol, otherwise following quotes
+  // would not have any special meaning.
+  if ( ((_block.eol & _inside) != 0) || ((_opening & ~_starts) != 0) || ((_landing & ~_boundary) != 0) || 
+       (std::popcount( _landing ) != std::popcount( _closing )) )
+    return;
+
+  // Quotes open at the end of the block are closed in the next one, that must use the mask 
+  // as well, since the opening quote is not provided to csv_parser.
+  if ( (_inside >> 63) != 0 )
+  {
+    if ( block + 1 >= m_vBlocks.size() )
+      return;
+
+    decide( block + 1, true, true, false );
+    if ( m_vBlocks[block + 1].mode != mode_t::fast )
+      return;
+  }
+
+  // When quotes are open at the start, the closing quote is provided to csv_parser.
+  _block.fast = _boundary | _spaces | (quote_open?(_block.quote & (0 - _block.quote)):0);
+  _block.mode = mode_t::fast;
+  ++m_nFastBlocks;
+}
+
+std::size_t csv_structural_index::find( std::size_t pos, bool quote_open, bool field_empty ) noexcept
+{
+  std::size_t _ndx     = (pos >> 6);
+  uint64_t    _keep    = ~uint64_t(0) << (pos & 63);
+  bool        _atStart = ((pos & 63) == 0);
+
+  const std::size_t _nBlocks = (m_nLength + 63) / 64;
+
+  while ( _ndx < _nBlocks )
+  {
+    if ( (_ndx < m_nFirstBlock) || (_ndx >= m_nFirstBlock + m_vBlocks.size()) )
+      index( _ndx );
+
+    block_t& _block = m_vBlocks[_ndx - m_nFirstBlock];
+
+    if ( _block.mode == mode_t::undecided )
+      decide( _ndx - m_nFirstBlock, _atStart, quote_open, field_empty );
+
+    uint64_t _bits = 0;
+    if ( _block.mode == mode_t::fast )
+      _bits = _block.fast;
+    else if ( quote_open )
+      _bits = _block.quote | _block.eol;
+    else
+      _bits = _block.quote | _block.delimiter | _block.eol | _block.whitespace | _block.comment;
+
+    _bits &= _keep;
+    if ( _bits != 0 )
+      return (_ndx << 6) + static_cast<std::size_t>(std::countr_zero( _bits ));
+
+    // No characters to be processed until the end of the block, so next block
+    // start with the same state, but at least one character is added to the field.
+    ++_ndx;
+    _keep       = ~uint64_t(0);
+    _atStart    = true;
+    field_empty = false;
+  }
+
+  return m_nLength;
+}
+
+} //inline namespace
+} // namespace
@@ -22,18 +22,31 @@
  *************************************************************************************************/
 
 #include "csv_writer.h"
+#include <algorithm>
 
 namespace csv {
 inline namespace CSV_LIB_VERSION {
 
 
-csv_writer::csv_writer( const std::string& feedname, core::unique_ptr<csv_device> ptrDevice, core::unique_ptr<csv_events> ptrEvents )
-  : csv_base( feedname, std::move(ptrDevice), std::move(ptrEvents) )
-{}
+csv_writer::csv_writer( const std::string& feedname, core::unique_ptr<csv_device> ptrDevice, core::unique_ptr<csv_events> ptrEvents,
+                        csv_uint_t nBufferSize )
+  : csv_base( feedname, std::move(ptrDevice), std::move(ptrEvents) ),
+    m_nBufferSize( nBufferSize ), m_nTxSize( 0 ), m_nMapping( 0 )
+{
+  // One row more than the buffer size is the usual amount staged.
+  m_vTxBuffer.resize( m_nBufferSize + to_bytes<4>::KBytes );
+}
+
+csv_writer::~csv_writer()
+{
+  _in_send();
+}
 
 bool csv_writer::open( const csv_header& header ) 
 {
   set_header( header );
+  clear_mappings();
+  update_dialect();
 
   const csv_header& _out_header = get_header();
   for ( size_t ndx = 0; ndx < _out_header.size(); ++ndx )
@@ -41,57 +54,190 @@ bool csv_writer::open( const csv_header& header )
     _in_write_field( _out_header.at(ndx) );
     
     if ( ndx < _out_header.size()-1 )
-      m_ptrDevice->send( reinterpret_cast<const byte*>(&get_delimeter()), sizeof(char) );
-    else
-      m_ptrDevice->send( reinterpret_cast<const byte*>(&get_eol()), sizeof(char) );
+      _in_append( get_delimeter() );
   }
 
-  return true;
+  return _in_end_row();
 }
 
 bool csv_writer::write( const csv_header& header, const csv_row& row ) 
 {
-  const csv_header& _out_header = get_header();
-  for ( size_t ndx = 0; ndx < _out_header.size(); ++ndx )
+  const auto&  _mapping = _in_get_mapping( header );
+  const size_t _columns = _mapping.size();
+  for ( size_t ndx = 0; ndx < _columns; ++ndx )
   {
-    const auto& _field_name = _out_header.at(ndx);
-    auto        _src_ndx    = header.get_index(_field_name);
+    const auto _src_ndx = _mapping[ndx];
     if ( _src_ndx != -1 )
     {
       _in_write_field( row.at(_src_ndx) );
     }
     
-    if ( ndx < _out_header.size()-1 )
-      m_ptrDevice->send( reinterpret_cast<const byte*>(&get_delimeter()), sizeof(char) );
-    else
-      m_ptrDevice->send( reinterpret_cast<const byte*>(&get_eol()), sizeof(char) );
+    if ( ndx < _columns-1 )
+      _in_append( get_delimeter() );
   }
 
-  return true;
+  return _in_end_row();
+}
+
+bool csv_writer::flush()
+{
+  const bool _bRetVal = _in_send();
+
+  m_ptrDevice->flush();
+
+  return _bRetVal;
 }
 
 bool csv_writer::close() 
 {
+  const bool _bRetVal = _in_send();
+
   m_ptrDevice->close();
-  return true; 
+
+  return _bRetVal; 
+}
+
+const std::vector<csv_header::field_index_t>& csv_writer::_in_get_mapping( const csv_header& header )
+{
+  // Most of the times rows come from the same source as the previous one.
+  if ( (m_nMapping < m_vMappings.size()) && m_vMappings[m_nMapping].matches( header ) )
+    return m_vMappings[m_nMapping].indexes;
+
+  for ( m_nMapping = 0; m_nMapping < m_vMappings.size(); ++m_nMapping )
+  {
+    if ( m_vMappings[m_nMapping].matches( header ) )
+      return m_vMappings[m_nMapping].indexes;
+  }
+
+  const csv_header& _out_header = get_header();
+  mapping_t         _mapping{ &header, header.get_revision(), header.size(), {} };
+
+  _mapping.indexes.reserve( _out_header.size() );
+  for ( size_t ndx = 0; ndx < _out_header.size(); ++ndx )
+    _mapping.indexes.push_back( header.get_index( _out_header.at(ndx) ) );
+
+  // A header with the same address and a different revision has been replaced.
+  m_vMappings.erase( std::remove_if( m_vMappings.begin(), m_vMappings.end(), 
+                                     [&header]( const mapping_t& mapping ){ return mapping.header == &header; } ), 
+                     m_vMappings.end() );
+  m_vMappings.push_back( std::move(_mapping) );
+  m_nMapping = m_vMappings.size() - 1;
+
+  return m_vMappings[m_nMapping].indexes;
+}
+
+void csv_writer::update_dialect() noexcept
+{
+  m_scanSpecials.clear();
+  m_scanSpecials.insert( get_delimeter() );
+  m_scanSpecials.insert( get_quote() );
+  m_scanSpecials.insert( get_eol() );
+  m_scanSpecials.insert( '\n' );
+  m_scanSpecials.insert( '\r' );
 }
 
 bool csv_writer::_in_write_field( const csv_field_t& field )
 {
-  if ( field.hasquotes() )
-    m_ptrDevice->send( reinterpret_cast<const byte*>(&get_quote()), field.data().type_size() );
+  const csv_data_t& _data = field.data();
 
-  if ( field.data().empty() == false )
+  if ( _data.empty() )
   {
-    m_ptrDevice->send( reinterpret_cast<const byte*>(field.data().data()), field.data().size() );
+    if ( field.hasquotes() )
+    {
+      _in_append( get_quote() );
+      _in_append( get_quote() );
+    }
+    return true;
   }
 
+  const char* _pFirst = _data.data();
+  const char* _pLast  = _pFirst + _data.size();
+
   if ( field.hasquotes() )
-    m_ptrDevice->send( reinterpret_cast<const byte*>(&get_quote()), field.data().type_size() );
+  {
+    // csv_parser keep quoted fields escaped, so only quotes not already doubled, 
+    // as found in malformed input, need to be escaped.
+    _in_append( get_quote() );
+    _in_write_escaped( _pFirst, _in_find_quote( _pFirst, _pLast ), _pLast, true );
+    _in_append( get_quote() );
+
+    return true;
+  }
+
+  // Fields shorter than a vector are checked here without branches, since 
+  // csv_scanner would fall back to its lookup table for them in any case.
+  const char* _pFound = _pLast;
+  if ( _data.size() < 32 )
+  {
+    bool _bSpecial = false;
+    for ( const char* _pChar = _pFirst; _pChar != _pLast; ++_pChar )
+      _bSpecial |= m_scanSpecials.contains( *_pChar );
+
+    if ( _bSpecial )
+      _pFound = m_scanSpecials.find( _pFirst, _pLast );
+  }
+  else
+  {
+    _pFound = m_scanSpecials.find( _pFirst, _pLast );
+  }
+
+  if ( _pFound == _pLast )
+  {
+    _in_append( _pFirst, _data.size() );
+  }
+  else
+  {
+    _in_append( get_quote() );
+    _in_write_escaped( _pFirst, _in_find_quote( _pFound, _pLast ), _pLast, false );
+    _in_append( get_quote() );
+  }
 
   return true;
 }
 
+void csv_writer::_in_write_escaped( const char* pFirst, const char* pQuote, const char* pLast, bool bKeepPairs )
+{
+  const char _chQuote = get_quote();
+
+  while ( pQuote != pLast )
+  {
+    _in_append( pFirst, static_cast<std::size_t>(pQuote - pFirst) + 1 );
+
+    if ( bKeepPairs && (pQuote + 1 != pLast) && (pQuote[1] == _chQuote) )
+      ++pQuote;
+
+    _in_append( _chQuote );
+
+    pFirst = pQuote + 1;
+    pQuote = _in_find_quote( pFirst, pLast );
+  }
+
+  _in_append( pFirst, static_cast<std::size_t>(pLast - pFirst) );
+}
+
+bool csv_writer::_in_end_row()
+{
+  _in_append( get_eol() );
+
+  if ( m_nTxSize < m_nBufferSize )
+    return true;
+
+  return _in_send();
+}
+
+bool csv_writer::_in_send()
+{
+  if ( m_nTxSize == 0 )
+    return true;
+
+  const csv_result _result = m_ptrDevice->send( m_vTxBuffer.data(), m_nTxSize );
+
+  // Data are dropped also on failure, the device close itself on errors.
+  m_nTxSize = 0;
+
+  return ( _result == csv_result::_ok );
+}
+
 } //inline namespace
 } // namespace
 
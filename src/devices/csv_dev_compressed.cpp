@@ -0,0 +1,1085 @@
+/**************************************************************************************************
+ * 
+ * Copyright 2022 https://github.com/fe-dagostino
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this 
+ * software and associated documentation files (the "Software"), to deal in the Software 
+ * without restriction, including without limitation the rights to use, copy, modify, 
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to 
+ * permit persons to whom the Software is furnished to do so, subject to the following 
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies 
+ * or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE 
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR 
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *************************************************************************************************/
+
+#include "csv_dev_compressed.h"
+#include <assert.h>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#ifdef CSV_HAS_ZLIB
+# include <zlib.h>
+#endif
+#ifdef CSV_HAS_ZSTD
+# include <zstd.h>
+#endif
+
+namespace csv {
+inline namespace CSV_LIB_VERSION {
+
+#define DeviceOption(p)   (static_cast<const csv_dev_file_options *>(p.get()))
+
+static constexpr std::uint8_t  __GZIP_MAGIC__[] = { 0x1F, 0x8B };
+static constexpr std::uint8_t  __ZSTD_MAGIC__[] = { 0x28, 0xB5, 0x2F, 0xFD };
+
+// zstd seekable format, seek table is a skippable frame ending with a 9 bytes footer.
+static constexpr std::uint32_t __ZSTD_SKIPPABLE_MAGIC__ = 0x184D2A5E;
+static constexpr std::uint32_t __ZSTD_SEEKABLE_MAGIC__  = 0x8F92EAB1;
+
+static inline std::uint32_t  read_le( const byte* pBuffer, std::size_t nBytes ) noexcept
+{
+  std::uint32_t _nValue = 0;
+  for ( std::size_t ndx = nBytes; ndx > 0; --ndx )
+    _nValue = (_nValue << 8) | static_cast<std::uint8_t>(pBuffer[ndx - 1]);
+  return _nValue;
+}
+
+static bool  read_at( int hFile, byte* pBuffer, csv_uint_t nLength, csv_uint_t nOffset ) noexcept
+{
+  while ( nLength > 0 )
+  {
+    ssize_t _nRead = pread( hFile, pBuffer, nLength, static_cast<off_t>(nOffset) );
+    if ( (_nRead == -1) && (errno == EINTR) )
+      continue;
+    if ( _nRead <= 0 )
+      return false;
+
+    pBuffer += _nRead;
+    nOffset += static_cast<csv_uint_t>(_nRead);
+    nLength -= static_cast<csv_uint_t>(_nRead);
+  }
+
+  return true;
+}
+
+csv_dev_compressed::csv_dev_compressed( std::unique_ptr<csv_dev_file_options> ptrDeviceOptions, core::unique_ptr<csv_device_events> ptrEvents )
+    : csv_device( "csv_dev_compressed", std::move(ptrDeviceOptions), std::move(ptrEvents) ),
+      m_eCodec(codec_t::plain), m_bOpen(false), m_bStreamEnd(false), m_pZlib(nullptr), m_pZstd(nullptr),
+      m_pRxBuffer(nullptr), m_pRxCache(nullptr), m_nBufSize(0), m_nCacheSize(0), m_nCursor(0), m_bBomChecked(false), m_nBomSize(0),
+      m_nRxCurrent(0), m_nRxReady(0), m_eRxResult(csv_result::_ok), m_bRxDone(false), m_bRxStop(false),
+      m_hFile(-1), m_nNextChunk(0), m_nChunk(0), m_nSkip(0)
+{
+  assert( csv_device::get_options() != nullptr );
+}
+
+csv_dev_compressed::~csv_dev_compressed()
+{
+  release();
+}
+
+csv_dev_compressed::codec_t  csv_dev_compressed::detect_codec( const byte* pBuffer, csv_uint_t nBufferLen ) noexcept
+{
+  if ( (nBufferLen >= sizeof(__GZIP_MAGIC__)) && (memcmp( pBuffer, __GZIP_MAGIC__, sizeof(__GZIP_MAGIC__) ) == 0) )
+    return codec_t::gzip;
+
+  if ( (nBufferLen >= sizeof(__ZSTD_MAGIC__)) && (memcmp( pBuffer, __ZSTD_MAGIC__, sizeof(__ZSTD_MAGIC__) ) == 0) )
+    return codec_t::zstd;
+
+  return codec_t::plain;
+}
+
+bool  csv_dev_compressed::is_available( codec_t codec ) noexcept
+{
+  switch ( codec )
+  {
+#ifdef CSV_HAS_ZLIB
+    case codec_t::gzip:
+    case codec_t::bgzf:
+#endif
+#ifdef CSV_HAS_ZSTD
+    case codec_t::zstd:
+    case codec_t::zstd_seekable:
+#endif
+    case codec_t::plain:
+      return true;
+
+    default:
+    break;
+  }
+
+  return false;
+}
+
+csv_result csv_dev_compressed::open() noexcept
+{
+  csv_result  _retVal = csv_result::_ok;
+
+  if ( m_bOpen )
+    return _retVal;
+
+  if ( DeviceOption(m_ptrOptions)->get_mode() != csv_dev_file_options::openmode::read )
+    return csv_result::_wrong_call;
+
+  // Magic bytes are checked before opening the file as a device, since 
+  // csv_dev_file will consume them as a BOM when there is a match.
+  byte        _rxMagic[4];
+  csv_uint_t  _nMagic = 0;
+  FILE*       _pFile  = fopen64( DeviceOption(m_ptrOptions)->get_filename().c_str(), "r" );
+  if ( _pFile != nullptr )
+  {
+    _nMagic = fread( _rxMagic, sizeof(byte), sizeof(_rxMagic), _pFile );
+    fclose( _pFile );
+  }
+  else
+  {
+    _retVal = csv_result::_access;
+  }
+
+  m_eCodec = detect_codec( _rxMagic, _nMagic );
+  if ( (_retVal == csv_result::_ok) && (is_available( m_eCodec ) == false) )
+    _retVal = csv_result::_cfg_error;
+
+  // Block compressed files are read directly from workers.
+  if ( (_retVal == csv_result::_ok) && (m_eCodec != codec_t::plain) )
+  {
+    int _hFile = ::open( DeviceOption(m_ptrOptions)->get_filename().c_str(), O_RDONLY );
+    if ( (_hFile != -1) && build_index( _hFile ) )
+      m_hFile = _hFile;
+    else if ( _hFile != -1 )
+      ::close( _hFile );
+  }
+
+  // Plain files are read with same options, while compressed data are read 
+  // synchronously since decompression already run on its own thread.
+  if ( (_retVal == csv_result::_ok) && (m_hFile == -1) )
+  {
+    const bool _bPlain = (m_eCodec == codec_t::plain);
+
+    m_ptrSource = std::make_unique<csv_dev_file>( std::make_unique<csv_dev_file_options>( DeviceOption(m_ptrOptions)->get_filename(),
+                                                                                          csv_dev_file_options::openmode::read,
+                                                                                          DeviceOption(m_ptrOptions)->get_bufsize(),
+                                                                                          csv_dev_file_options::filetype::PLAIN_TEXT,
+                                                                                          _bPlain?DeviceOption(m_ptrOptions)->get_read_ahead():0,
+                                                                                          DeviceOption(m_ptrOptions)->get_direct_io() ),
+                                                  nullptr );
+    _retVal = m_ptrSource->open();
+  }
+
+  if ( (_retVal == csv_result::_ok) && (m_hFile != -1) )
+  {
+    // Each worker has one slot, read_ahead more slots are for chunks already 
+    // decompressed and one slot for the chunk currently consumed.
+    const std::size_t _nSlots = std::max<csv_uint_t>( DeviceOption(m_ptrOptions)->get_read_ahead(), 1 ) + 
+                                std::max<unsigned>( std::thread::hardware_concurrency(), 1 ) + 1;
+
+    m_vSlotChunk.assign( _nSlots, SIZE_MAX );
+    m_vSlotResult.assign( _nSlots, csv_result::_ok );
+    m_vRxSizes.assign( _nSlots, 0 );
+    m_pRxBuffer = static_cast<byte*>( malloc( std::max<csv_uint_t>( m_nBufSize, 1 ) * _nSlots ) );
+
+    if ( m_pRxBuffer == nullptr )
+      _retVal = csv_result::_no_mem;
+  }
+  else if ( (_retVal == csv_result::_ok) && (m_eCodec != codec_t::plain) )
+  {
+    // Decompressed buffers need room at least for the longest BOM.
+    const std::size_t _nBuffers = std::max<csv_uint_t>( DeviceOption(m_ptrOptions)->get_read_ahead(), 1 ) + 1;
+
+    m_nBufSize  = std::max<csv_uint_t>( DeviceOption(m_ptrOptions)->get_bufsize(), 4 );
+    m_pRxBuffer = static_cast<byte*>( malloc( m_nBufSize * _nBuffers ) );
+
+    if ( (m_pRxBuffer == nullptr) || (init_codec() == false) )
+      _retVal = csv_result::_no_mem;
+  }
+
+  if ( _retVal != csv_result::_ok )
+  {
+    release();
+
+    if ( m_ptrEvents != nullptr )
+    {
+      m_ptrEvents->onError( this, _retVal );
+    }
+
+    return _retVal;
+  }
+
+  m_bOpen          = true;
+  m_bStreamEnd     = false;
+  m_bBomChecked    = false;
+  m_nBomSize       = 0;
+  m_nCacheSize     = 0;
+  m_nCursor        = 0;
+
+  m_devStats.rx     = 0;
+  m_devStats.tx     = 0;
+  m_devStats.errors = 0;
+
+  if ( m_ptrEvents != nullptr )
+  {
+    m_ptrEvents->onOpened( this );
+  }
+
+  if ( m_eCodec == codec_t::plain )
+  {
+    // BOM has been skipped by csv_dev_file, mismatch is detected here where events are available.
+    csv_uint_t _nBomSize = 0;
+    auto _detected_bom = csv_dev_file::detect_bom( _rxMagic, _nMagic, _nBomSize );
+    if (
+        ( DeviceOption(m_ptrOptions)->get_bom() != _detected_bom ) &&
+        ( DeviceOption(m_ptrOptions)->get_bom() != csv_dev_file_options::filetype::PLAIN_TEXT )
+      )
+    {
+      if ( m_ptrEvents != nullptr )
+      {
+        m_ptrEvents->onError( this, csv_result::_bom_mismatch );
+      }
+    }
+  }
+  else if ( m_hFile != -1 )
+  {
+    m_nChunk = 0;
+    m_nSkip  = 0;
+    start_workers();
+  }
+  else
+  {
+    const std::size_t _nBuffers = std::max<csv_uint_t>( DeviceOption(m_ptrOptions)->get_read_ahead(), 1 ) + 1;
+
+    // Thread start filling the buffer following m_nRxCurrent, that is the first one.
+    m_vRxSizes.assign( _nBuffers, 0 );
+    m_nRxCurrent = _nBuffers - 1;
+    m_nRxReady   = 0;
+    m_eRxResult  = csv_result::_ok;
+    m_bRxDone    = false;
+    m_bRxStop    = false;
+    m_pRxCache   = m_pRxBuffer + m_nRxCurrent * m_nBufSize;
+
+    m_thDecompress = std::thread( &csv_dev_compressed::decompress, this );
+  }
+
+  return _retVal;
+}
+
+csv_result csv_dev_compressed::send( [[maybe_unused]] const byte* pBuffer, [[maybe_unused]] csv_uint_t nBufferLen) noexcept
+{
+  return csv_result::_wrong_call;
+}
+
+csv_result csv_dev_compressed::recv(byte* pBuffer, csv_uint_t& nBufferLen) noexcept
+{
+  csv_result  _retVal = open();
+  if ( _retVal != csv_result::_ok )
+  {
+    nBufferLen = 0;
+    return _retVal;
+  }
+
+  if ( m_eCodec == codec_t::plain )
+  {
+    _retVal = m_ptrSource->recv( pBuffer, nBufferLen );
+    if ( (_retVal != csv_result::_ok) && (_retVal != csv_result::_rx_timedout) )
+      on_recv_error( _retVal );
+    return _retVal;
+  }
+
+  csv_uint_t _nWishedBytes  = nBufferLen;
+  csv_uint_t _nBufCursor    = 0;
+
+  while ((_nWishedBytes > 0) && (_retVal == csv_result::_ok))
+  {
+    const csv_uint_t _nAvailableBytes = m_nCacheSize - m_nCursor;
+
+    if ( _nAvailableBytes == 0 )
+    {
+      _retVal = refresh_cache();
+    }
+    else
+    {
+      const csv_uint_t _nBytes = std::min( _nAvailableBytes, _nWishedBytes );
+
+      memcpy( &pBuffer[_nBufCursor], &m_pRxCache[m_nCursor], _nBytes );
+      m_nCursor      += _nBytes;
+      _nBufCursor    += _nBytes;
+      _nWishedBytes  -= _nBytes;
+    }
+  }
+
+  // Only partial data when the end of data has been reached.
+  nBufferLen -= _nWishedBytes;
+
+  if ( (_retVal == csv_result::_eof) && (nBufferLen > 0) )
+  {
+    // Return value will be _ok and next call will be _eof
+    _retVal = csv_result::_ok;
+  }
+  else if ( _retVal != csv_result::_ok )
+  {
+    on_recv_error( _retVal );
+  }
+
+  return _retVal;
+}
+
+csv_result csv_dev_compressed::acquire( const byte*& pBuffer, csv_uint_t& nBufferLen ) noexcept
+{
+  pBuffer    = nullptr;
+  nBufferLen = 0;
+
+  csv_result  _retVal = open();
+  if ( _retVal != csv_result::_ok )
+    return _retVal;
+
+  if ( m_eCodec == codec_t::plain )
+  {
+    _retVal = m_ptrSource->acquire( pBuffer, nBufferLen );
+  }
+  else
+  {
+    if ( m_nCursor == m_nCacheSize )
+    {
+      _retVal = refresh_cache();
+    }
+
+    if ( _retVal == csv_result::_ok )
+    {
+      pBuffer    = &m_pRxCache[m_nCursor];
+      nBufferLen = m_nCacheSize - m_nCursor;
+    }
+  }
+
+  if ( (_retVal != csv_result::_ok) && (_retVal != csv_result::_rx_timedout) )
+    on_recv_error( _retVal );
+
+  return _retVal;
+}
+
+csv_result csv_dev_compressed::release( csv_uint_t nBufferLen ) noexcept
+{
+  if ( m_bOpen == false )
+    return csv_result::_closed;
+
+  if ( m_eCodec == codec_t::plain )
+    return m_ptrSource->release( nBufferLen );
+
+  m_nCursor += std::min( nBufferLen, m_nCacheSize - m_nCursor );
+
+  return csv_result::_ok;
+}
+
+csv_result csv_dev_compressed::seek( csv_uint_t nOffset ) noexcept
+{
+  csv_result  _retVal = open();
+  if ( _retVal != csv_result::_ok )
+    return _retVal;
+
+  if ( m_eCodec == codec_t::plain )
+    return m_ptrSource->seek( nOffset );
+
+  if ( m_hFile == -1 )
+    return csv_result::_not_implemented;
+
+  // BOM is known only when the first chunk has been decompressed.
+  if ( m_bBomChecked == false )
+  {
+    _retVal = refresh_cache();
+    if ( (_retVal != csv_result::_ok) && (_retVal != csv_result::_eof) )
+      return _retVal;
+  }
+
+  // Chunks decompressed in advance are discarded.
+  stop_workers();
+  m_nCacheSize = 0;
+  m_nCursor    = 0;
+
+  const csv_uint_t  _nOffset = m_nBomSize + nOffset;
+  const std::size_t _nChunks = m_vChunks.size() - 1;
+
+  // First offset is zero, so the chunk is the one before the first greater offset.
+  m_nChunk = static_cast<std::size_t>( std::upper_bound( m_vChunkOffsets.begin(), m_vChunkOffsets.end(), _nOffset ) - m_vChunkOffsets.begin() ) - 1;
+  m_nChunk = std::min( m_nChunk, _nChunks );
+  m_nSkip  = (m_nChunk < _nChunks)?(_nOffset - m_vChunkOffsets[m_nChunk]):0;
+
+  start_workers();
+
+  return csv_result::_ok;
+}
+
+csv_result csv_dev_compressed::close() noexcept
+{
+  if ( m_bOpen == false )
+    return csv_result::_closed;
+
+  release();
+
+  if ( m_ptrEvents != nullptr )
+  {
+    m_ptrEvents->onClosed( this );
+  }
+
+  return csv_result::_ok;
+}
+
+csv_result csv_dev_compressed::is_valid() const noexcept
+{
+  if ( m_bOpen == false )
+    return csv_result::_closed;
+
+  return csv_result::_ok;
+}
+
+void csv_dev_compressed::get_stats( csv_dev_stats& stats ) const noexcept
+{
+  if ( (m_eCodec == codec_t::plain) && (m_ptrSource != nullptr) )
+    m_ptrSource->get_stats( stats );
+  else
+    stats = m_devStats;
+}
+
+csv_result csv_dev_compressed::on_recv_error( csv_result result ) noexcept
+{
+  if ( m_ptrEvents != nullptr )
+  {
+    m_ptrEvents->onError( this, result );
+  }
+
+  //Close and release resources
+  close();
+
+  return result;
+}
+
+csv_result csv_dev_compressed::refresh_cache() noexcept
+{
+  csv_result  _retVal = csv_result::_ok;
+
+  m_nCursor = 0;
+
+  if ( m_hFile != -1 )
+  {
+    _retVal = refresh_chunk();
+  }
+  else
+  {
+    std::unique_lock<std::mutex> _lock( m_mtxRx );
+
+    m_cvRxFilled.wait( _lock, [this]{ return (m_nRxReady > 0) || m_bRxDone; } );
+
+    if ( m_nRxReady > 0 )
+    {
+      // Buffer consumed so far is given back to the thread.
+      m_nRxCurrent = (m_nRxCurrent + 1) % m_vRxSizes.size();
+      --m_nRxReady;
+      m_pRxCache   = m_pRxBuffer + m_nRxCurrent * m_nBufSize;
+      m_nCacheSize = m_vRxSizes[m_nRxCurrent];
+      m_cvRxConsumed.notify_one();
+    }
+    else
+    {
+      m_nCacheSize = 0;
+      _retVal      = m_eRxResult;
+    }
+  }
+
+  if ( m_nCacheSize > 0 )
+    m_devStats.rx += m_nCacheSize;
+  else if ( _retVal == csv_result::_rx_error )
+    m_devStats.errors++;
+
+  // First buffer is full unless all data are shorter, so it contains the whole BOM.
+  if ( (m_bBomChecked == false) && (m_nCacheSize > 0) )
+  {
+    m_bBomChecked = true;
+
+    auto _detected_bom = csv_dev_file::detect_bom( m_pRxCache, m_nCacheSize, m_nBomSize );
+    m_nCursor = m_nBomSize;
+    if (
+        ( DeviceOption(m_ptrOptions)->get_bom() != _detected_bom ) &&
+        ( DeviceOption(m_ptrOptions)->get_bom() != csv_dev_file_options::filetype::PLAIN_TEXT )
+      )
+    {
+      if ( m_ptrEvents != nullptr )
+      {
+        m_ptrEvents->onError( this, csv_result::_bom_mismatch );
+      }
+    }
+  }
+
+  return _retVal;
+}
+
+csv_result csv_dev_compressed::refresh_chunk() noexcept
+{
+  const std::size_t _nChunks = m_vChunks.size() - 1;
+
+  std::unique_lock<std::mutex> _lock( m_mtxRx );
+
+  // Empty chunks, as the BGZF end of file block, are skipped.
+  while ( m_nChunk < _nChunks )
+  {
+    const std::size_t _nSlot = m_nChunk % m_vSlotChunk.size();
+
+    m_cvRxFilled.wait( _lock, [this,_nSlot]{ return m_vSlotChunk[_nSlot] == m_nChunk; } );
+
+    if ( m_vSlotResult[_nSlot] != csv_result::_ok )
+    {
+      m_nCacheSize = 0;
+      return m_vSlotResult[_nSlot];
+    }
+
+    // Chunk consumed so far is given back to workers.
+    ++m_nChunk;
+    m_cvRxConsumed.notify_all();
+
+    m_pRxCache   = m_pRxBuffer + _nSlot * m_nBufSize;
+    m_nCacheSize = m_vRxSizes[_nSlot];
+    m_nCursor    = std::min( m_nSkip, m_nCacheSize );
+    m_nSkip      = 0;
+
+    if ( m_nCursor < m_nCacheSize )
+      return csv_result::_ok;
+  }
+
+  m_nCacheSize = 0;
+  m_nCursor    = 0;
+
+  return csv_result::_eof;
+}
+
+void csv_dev_compressed::decompress() noexcept
+{
+  const csv_uint_t  _nBufSize = m_nBufSize;
+  const std::size_t _nBuffers = m_vRxSizes.size();
+
+  // Source is closed when the end of file is reached and must not be read again.
+  bool              _bSourceEnd = false;
+
+  std::unique_lock<std::mutex> _lock( m_mtxRx );
+
+  while ( true )
+  {
+    // All buffers but the one currently consumed can be filled.
+    m_cvRxConsumed.wait( _lock, [this,_nBuffers]{ return m_bRxStop || (m_nRxReady < _nBuffers - 1); } );
+    if ( m_bRxStop )
+      break;
+
+    // Index do not change while decompressing, see csv_dev_file::read_ahead().
+    const std::size_t _nBuffer = (m_nRxCurrent + 1 + m_nRxReady) % _nBuffers;
+    byte*             _pOut    = m_pRxBuffer + _nBuffer * _nBufSize;
+
+    _lock.unlock();
+
+    csv_result  _result    = csv_result::_ok;
+    csv_uint_t  _nLength   = 0;
+    while ( (_nLength < _nBufSize) && (_result == csv_result::_ok) )
+    {
+      const byte* _pIn       = nullptr;
+      csv_uint_t  _nIn       = 0;
+      csv_uint_t  _nConsumed = 0;
+      csv_uint_t  _nProduced = 0;
+
+      _result = _bSourceEnd?csv_result::_eof:m_ptrSource->acquire( _pIn, _nIn );
+      if ( _result == csv_result::_eof )
+      {
+        _bSourceEnd = true;
+
+        // Decoder can still hold data, then the stream must be complete.
+        if ( m_bStreamEnd )
+          break;
+
+        _result = decode( nullptr, 0, _nConsumed, _pOut + _nLength, _nBufSize - _nLength, _nProduced );
+        if ( (_result == csv_result::_ok) && (_nProduced == 0) && (m_bStreamEnd == false) )
+          _result = csv_result::_rx_error;
+        else if ( (_result == csv_result::_ok) && (_nProduced == 0) )
+          _result = csv_result::_eof;
+      }
+      else if ( _result == csv_result::_ok )
+      {
+        _result = decode( _pIn, _nIn, _nConsumed, _pOut + _nLength, _nBufSize - _nLength, _nProduced );
+        m_ptrSource->release( _nConsumed );
+      }
+
+      _nLength += _nProduced;
+    }
+
+    _lock.lock();
+
+    if ( _nLength > 0 )
+    {
+      m_vRxSizes[_nBuffer] = _nLength;
+      ++m_nRxReady;
+      m_cvRxFilled.notify_one();
+    }
+
+    if ( (_result != csv_result::_ok) || (_nLength == 0) )
+    {
+      m_eRxResult = (_result == csv_result::_ok)?csv_result::_eof:_result;
+      m_bRxDone   = true;
+      m_cvRxFilled.notify_one();
+      break;
+    }
+  }
+}
+
+bool csv_dev_compressed::init_codec() noexcept
+{
+  switch ( m_eCodec )
+  {
+#ifdef CSV_HAS_ZLIB
+    case codec_t::gzip:
+    {
+      m_pZlib = static_cast<z_stream_s*>( calloc( 1, sizeof(z_stream_s) ) );
+      // 32 enable gzip and zlib header detection.
+      if ( (m_pZlib != nullptr) && (inflateInit2( m_pZlib, 15 + 32 ) != Z_OK) )
+      {
+        free( m_pZlib );
+        m_pZlib = nullptr;
+      }
+      return (m_pZlib != nullptr);
+    }; break;
+#endif
+#ifdef CSV_HAS_ZSTD
+    case codec_t::zstd:
+    {
+      m_pZstd = ZSTD_createDCtx();
+      return (m_pZstd != nullptr);
+    }; break;
+#endif
+    default:
+    break;
+  }
+
+  return false;
+}
+
+void csv_dev_compressed::end_codec() noexcept
+{
+#ifdef CSV_HAS_ZLIB
+  if ( m_pZlib != nullptr )
+  {
+    inflateEnd( m_pZlib );
+    free( m_pZlib );
+    m_pZlib = nullptr;
+  }
+#endif
+#ifdef CSV_HAS_ZSTD
+  if ( m_pZstd != nullptr )
+  {
+    ZSTD_freeDCtx( m_pZstd );
+    m_pZstd = nullptr;
+  }
+#endif
+}
+
+csv_result csv_dev_compressed::decode( [[maybe_unused]] const byte* pIn, [[maybe_unused]] csv_uint_t nIn, csv_uint_t& nConsumed, 
+                                       [[maybe_unused]] byte* pOut, [[maybe_unused]] csv_uint_t nOut, csv_uint_t& nProduced ) noexcept
+{
+  nConsumed = 0;
+  nProduced = 0;
+
+  // Data following the end of a gzip member or a zstd frame start a new one.
+  if ( nIn > 0 )
+    m_bStreamEnd = false;
+
+  switch ( m_eCodec )
+  {
+#ifdef CSV_HAS_ZLIB
+    case codec_t::gzip:
+    {
+      m_pZlib->next_in   = const_cast<Bytef*>( reinterpret_cast<const Bytef*>(pIn) );
+      m_pZlib->avail_in  = static_cast<uInt>( std::min<csv_uint_t>( nIn, UINT32_MAX ) );
+      m_pZlib->next_out  = reinterpret_cast<Bytef*>(pOut);
+      m_pZlib->avail_out = static_cast<uInt>( std::min<csv_uint_t>( nOut, UINT32_MAX ) );
+
+      const uInt _nAvailIn  = m_pZlib->avail_in;
+      const uInt _nAvailOut = m_pZlib->avail_out;
+      const int  _iRetVal   = inflate( m_pZlib, Z_NO_FLUSH );
+
+      nConsumed = _nAvailIn  - m_pZlib->avail_in;
+      nProduced = _nAvailOut - m_pZlib->avail_out;
+
+      if ( _iRetVal == Z_STREAM_END )
+      {
+        m_bStreamEnd = true;
+        inflateReset( m_pZlib );
+      }
+      // Z_BUF_ERROR only means that no progress was possible.
+      else if ( (_iRetVal != Z_OK) && (_iRetVal != Z_BUF_ERROR) )
+      {
+        return csv_result::_rx_error;
+      }
+    }; break;
+#endif
+#ifdef CSV_HAS_ZSTD
+    case codec_t::zstd:
+    {
+      ZSTD_inBuffer  _input  = { pIn , nIn , 0 };
+      ZSTD_outBuffer _output = { pOut, nOut, 0 };
+
+      const size_t _nRetVal = ZSTD_decompressStream( m_pZstd, &_output, &_input );
+      if ( ZSTD_isError( _nRetVal ) )
+        return csv_result::_rx_error;
+
+      nConsumed    = _input.pos;
+      nProduced    = _output.pos;
+      // Zero when a frame is completely decoded and flushed.
+      m_bStreamEnd = (_nRetVal == 0);
+    }; break;
+#endif
+    default:
+      return csv_result::_rx_error;
+  }
+
+  return csv_result::_ok;
+}
+
+bool csv_dev_compressed::build_index( int hFile ) noexcept
+{
+  struct stat64  _stat;
+  if ( fstat64( hFile, &_stat ) != 0 )
+    return false;
+
+  const csv_uint_t _nFileSize = static_cast<csv_uint_t>(_stat.st_size);
+  bool             _bIndexed  = false;
+
+  m_vBlocks.clear();
+  switch ( m_eCodec )
+  {
+    case codec_t::gzip:
+      _bIndexed = index_bgzf( hFile, _nFileSize );
+      if ( _bIndexed )
+        m_eCodec = codec_t::bgzf;
+    break;
+
+    case codec_t::zstd:
+      _bIndexed = index_zstd_seekable( hFile, _nFileSize );
+      if ( _bIndexed )
+        m_eCodec = codec_t::zstd_seekable;
+    break;
+
+    default:
+    break;
+  }
+
+  if ( (_bIndexed == false) || m_vBlocks.empty() )
+  {
+    m_vBlocks.clear();
+    return false;
+  }
+
+  // Consecutive blocks are grouped up to the buffer size, that is also the 
+  // minimum amount of data decompressed by a worker at once.
+  const csv_uint_t _nChunkSize = std::max<csv_uint_t>( DeviceOption(m_ptrOptions)->get_bufsize(), 4 );
+  csv_uint_t       _nOffset    = 0;
+  csv_uint_t       _nSize      = 0;
+
+  m_vChunks.clear();
+  m_vChunkOffsets.clear();
+  m_nBufSize = 0;
+  for ( std::size_t ndx = 0; ndx < m_vBlocks.size(); ++ndx )
+  {
+    if ( m_vChunks.empty() || (_nSize + m_vBlocks[ndx].data_size > _nChunkSize) )
+    {
+      m_nBufSize = std::max( m_nBufSize, _nSize );
+      m_vChunks.push_back( ndx );
+      m_vChunkOffsets.push_back( _nOffset );
+      _nSize = 0;
+    }
+
+    _nSize   += m_vBlocks[ndx].data_size;
+    _nOffset += m_vBlocks[ndx].data_size;
+  }
+  m_nBufSize = std::max( m_nBufSize, _nSize );
+  m_vChunks.push_back( m_vBlocks.size() );
+  m_vChunkOffsets.push_back( _nOffset );
+
+  return true;
+}
+
+bool csv_dev_compressed::index_bgzf( int hFile, csv_uint_t nFileSize ) noexcept
+{
+  byte               _rxHeader[12];
+  std::vector<byte>  _vExtra;
+  csv_uint_t         _nOffset = 0;
+
+  // Each member must have the BC subfield with the member size, the 
+  // decompressed size is in the last 4 bytes of the member.
+  while ( _nOffset < nFileSize )
+  {
+    if ( read_at( hFile, _rxHeader, sizeof(_rxHeader), _nOffset ) == false )
+      return false;
+
+    if ( (memcmp( _rxHeader, __GZIP_MAGIC__, sizeof(__GZIP_MAGIC__) ) != 0) || 
+         (_rxHeader[2] != 0x08) || ((_rxHeader[3] & 0x04) == 0) )
+      return false;
+
+    const csv_uint_t _nExtra = read_le( &_rxHeader[10], 2 );
+    csv_uint_t       _nSize  = 0;
+
+    _vExtra.resize( _nExtra );
+    if ( read_at( hFile, _vExtra.data(), _nExtra, _nOffset + sizeof(_rxHeader) ) == false )
+      return false;
+
+    for ( csv_uint_t ndx = 0; ndx + 4 <= _nExtra; ndx += 4 + read_le( &_vExtra[ndx + 2], 2 ) )
+    {
+      if ( (_vExtra[ndx] == 'B') && (_vExtra[ndx + 1] == 'C') && (read_le( &_vExtra[ndx + 2], 2 ) == 2) && (ndx + 6 <= _nExtra) )
+      {
+        _nSize = read_le( &_vExtra[ndx + 4], 2 ) + 1;
+        break;
+      }
+    }
+
+    // Header, extra field and 8 bytes trailer with CRC32 and ISIZE.
+    if ( (_nSize < sizeof(_rxHeader) + _nExtra + 8) || (_nOffset + _nSize > nFileSize) )
+      return false;
+
+    byte _rxSize[4];
+    if ( read_at( hFile, _rxSize, sizeof(_rxSize), _nOffset + _nSize - sizeof(_rxSize) ) == false )
+      return false;
+
+    m_vBlocks.push_back( { _nOffset, _nSize, read_le( _rxSize, 4 ) } );
+    _nOffset += _nSize;
+  }
+
+  return true;
+}
+
+bool csv_dev_compressed::index_zstd_seekable( int hFile, csv_uint_t nFileSize ) noexcept
+{
+  // Footer: number of frames, seek table descriptor and magic number.
+  byte  _rxFooter[9];
+
+  if ( (nFileSize < 8 + sizeof(_rxFooter)) || (read_at( hFile, _rxFooter, sizeof(_rxFooter), nFileSize - sizeof(_rxFooter) ) == false) )
+    return false;
+
+  const csv_uint_t  _nFrames     = read_le( &_rxFooter[0], 4 );
+  const std::uint8_t _nDescriptor = static_cast<std::uint8_t>(_rxFooter[4]);
+  // Each entry has compressed and decompressed size, then an optional checksum.
+  const csv_uint_t  _nEntrySize  = ((_nDescriptor & 0x80) != 0)?12:8;
+  const csv_uint_t  _nTableSize  = _nFrames * _nEntrySize;
+
+  if ( (read_le( &_rxFooter[5], 4 ) != __ZSTD_SEEKABLE_MAGIC__) || ((_nDescriptor & 0x7C) != 0) || 
+       (8 + _nTableSize + sizeof(_rxFooter) > nFileSize) )
+    return false;
+
+  const csv_uint_t  _nTableOffset = nFileSize - sizeof(_rxFooter) - _nTableSize - 8;
+  std::vector<byte> _vTable( 8 + _nTableSize );
+
+  if ( (read_at( hFile, _vTable.data(), _vTable.size(), _nTableOffset ) == false) || 
+       (read_le( &_vTable[0], 4 ) != __ZSTD_SKIPPABLE_MAGIC__) || 
+       (read_le( &_vTable[4], 4 ) != _nTableSize + sizeof(_rxFooter)) )
+    return false;
+
+  csv_uint_t _nOffset = 0;
+  for ( csv_uint_t ndx = 0; ndx < _nFrames; ++ndx )
+  {
+    const byte* _pEntry = &_vTable[8 + ndx * _nEntrySize];
+
+    m_vBlocks.push_back( { _nOffset, read_le( &_pEntry[0], 4 ), read_le( &_pEntry[4], 4 ) } );
+    _nOffset += m_vBlocks.back().size;
+  }
+
+  // Frames are followed by the seek table.
+  return (_nOffset == _nTableOffset);
+}
+
+void csv_dev_compressed::start_workers() noexcept
+{
+  const std::size_t _nChunks  = m_vChunks.size() - 1;
+  const std::size_t _nWorkers = std::min<std::size_t>( std::max<unsigned>( std::thread::hardware_concurrency(), 1 ), 
+                                                       _nChunks - std::min( m_nChunk, _nChunks ) );
+
+  std::fill( m_vSlotChunk.begin(), m_vSlotChunk.end(), SIZE_MAX );
+  m_nNextChunk = m_nChunk;
+  m_bRxStop    = false;
+
+  for ( std::size_t ndx = 0; ndx < _nWorkers; ++ndx )
+    m_vWorkers.emplace_back( &csv_dev_compressed::decompress_blocks, this );
+}
+
+void csv_dev_compressed::stop_workers() noexcept
+{
+  if ( m_vWorkers.empty() )
+    return;
+
+  {
+    std::lock_guard<std::mutex> _lock( m_mtxRx );
+    m_bRxStop = true;
+  }
+  m_cvRxConsumed.notify_all();
+
+  for ( std::thread& worker : m_vWorkers )
+    worker.join();
+  m_vWorkers.clear();
+
+  m_bRxStop = false;
+}
+
+void csv_dev_compressed::decompress_blocks() noexcept
+{
+  const std::size_t _nChunks = m_vChunks.size() - 1;
+  const std::size_t _nSlots  = m_vSlotChunk.size();
+  std::vector<byte> _vIn;
+
+  // Each worker has its own decoder.
+#ifdef CSV_HAS_ZLIB
+  z_stream          _zlib;
+  memset( &_zlib, 0, sizeof(_zlib) );
+  const bool        _bZlib = (m_eCodec == codec_t::bgzf) && (inflateInit2( &_zlib, 15 + 16 ) == Z_OK);
+#endif
+#ifdef CSV_HAS_ZSTD
+  ZSTD_DCtx*        _pZstd = (m_eCodec == codec_t::zstd_seekable)?ZSTD_createDCtx():nullptr;
+#endif
+
+  std::unique_lock<std::mutex> _lock( m_mtxRx );
+
+  while ( true )
+  {
+    // Slot is free when the chunk previously in the same slot has been consumed.
+    m_cvRxConsumed.wait( _lock, [this,_nChunks,_nSlots]{ return m_bRxStop || (m_nNextChunk >= _nChunks) || (m_nNextChunk + 1 < m_nChunk + _nSlots); } );
+    if ( m_bRxStop || (m_nNextChunk >= _nChunks) )
+      break;
+
+    const std::size_t _nChunk = m_nNextChunk++;
+    const std::size_t _nSlot  = _nChunk % _nSlots;
+
+    _lock.unlock();
+
+    const block_t&    _first   = m_vBlocks[m_vChunks[_nChunk]];
+    const block_t&    _last    = m_vBlocks[m_vChunks[_nChunk + 1] - 1];
+    const csv_uint_t  _nIn     = _last.offset + _last.size - _first.offset;
+    const csv_uint_t  _nOut    = m_vChunkOffsets[_nChunk + 1] - m_vChunkOffsets[_nChunk];
+    [[maybe_unused]] byte* _pOut = m_pRxBuffer + _nSlot * m_nBufSize;
+    csv_result        _result  = csv_result::_rx_error;
+
+    try {
+      _vIn.resize( _nIn );
+    } catch ( ... ) {
+      _vIn.clear();
+      _result = csv_result::_no_mem;
+    }
+
+    if ( (_vIn.size() == _nIn) && read_at( m_hFile, _vIn.data(), _nIn, _first.offset ) )
+    {
+      switch ( m_eCodec )
+      {
+#ifdef CSV_HAS_ZLIB
+        case codec_t::bgzf:
+        {
+          // Each block is a gzip member with known sizes.
+          csv_uint_t _nLength = 0;
+          _result = _bZlib?csv_result::_ok:csv_result::_no_mem;
+          for ( std::size_t ndx = m_vChunks[_nChunk]; (ndx < m_vChunks[_nChunk + 1]) && (_result == csv_result::_ok); ++ndx )
+          {
+            _zlib.next_in   = reinterpret_cast<Bytef*>( _vIn.data() + (m_vBlocks[ndx].offset - _first.offset) );
+            _zlib.avail_in  = static_cast<uInt>( m_vBlocks[ndx].size );
+            _zlib.next_out  = reinterpret_cast<Bytef*>( _pOut + _nLength );
+            _zlib.avail_out = static_cast<uInt>( m_vBlocks[ndx].data_size );
+
+            if ( (inflate( &_zlib, Z_FINISH ) != Z_STREAM_END) || (_zlib.avail_out != 0) )
+              _result = csv_result::_rx_error;
+
+            _nLength += m_vBlocks[ndx].data_size;
+            inflateReset( &_zlib );
+          }
+        }; break;
+#endif
+#ifdef CSV_HAS_ZSTD
+        case codec_t::zstd_seekable:
+        {
+          // Frames are decompressed in a single call.
+          if ( _pZstd == nullptr )
+            _result = csv_result::_no_mem;
+          else if ( ZSTD_decompressDCtx( _pZstd, _pOut, _nOut, _vIn.data(), _nIn ) == _nOut )
+            _result = csv_result::_ok;
+        }; break;
+#endif
+        default:
+        break;
+      }
+    }
+
+    _lock.lock();
+
+    m_vRxSizes[_nSlot]    = _nOut;
+    m_vSlotResult[_nSlot] = _result;
+    m_vSlotChunk[_nSlot]  = _nChunk;
+    m_cvRxFilled.notify_one();
+  }
+
+  _lock.unlock();
+
+#ifdef CSV_HAS_ZLIB
+  if ( _bZlib )
+    inflateEnd( &_zlib );
+#endif
+#ifdef CSV_HAS_ZSTD
+  ZSTD_freeDCtx( _pZstd );
+#endif
+}
+
+void csv_dev_compressed::release() noexcept
+{
+  // Thread is using source, codec and buffers.
+  if ( m_thDecompress.joinable() )
+  {
+    {
+      std::lock_guard<std::mutex> _lock( m_mtxRx );
+      m_bRxStop = true;
+    }
+    m_cvRxConsumed.notify_one();
+    m_thDecompress.join();
+  }
+
+  stop_workers();
+  if ( m_hFile != -1 )
+  {
+    ::close( m_hFile );
+    m_hFile = -1;
+  }
+  m_vBlocks.clear();
+  m_vChunks.clear();
+  m_vChunkOffsets.clear();
+  m_vSlotChunk.clear();
+  m_vSlotResult.clear();
+
+  m_vRxSizes.clear();
+  m_nRxReady = 0;
+  m_bRxDone  = false;
+
+  // Stats of plain files are kept by the source.
+  if ( (m_eCodec == codec_t::plain) && (m_ptrSource != nullptr) )
+    m_ptrSource->get_stats( m_devStats );
+  m_ptrSource.reset();
+  end_codec();
+
+  if ( m_pRxBuffer != nullptr )
+  {
+    free( m_pRxBuffer );
+    m_pRxBuffer = nullptr;
+  }
+  m_pRxCache   = nullptr;
+
+  m_nCacheSize = 0;
+  m_nCursor    = 0;
+  m_bOpen      = false;
+}
+
+
+} //inline namespace
+} // namespace
@@ -25,6 +25,12 @@
 #include <assert.h>
 #include <cstring>
 #include <fstream>
+#include <algorithm>
+#include <cstdlib>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
 
 namespace csv {
 inline namespace CSV_LIB_VERSION {
@@ -62,7 +68,9 @@ static std::uint8_t __BOM__[][5] = {
 
 csv_dev_file::csv_dev_file( std::unique_ptr<csv_dev_file_options> ptrDeviceOptions, core::unique_ptr<csv_device_events> ptrEvents )
     : csv_device( "csv_dev_file", std::move(ptrDeviceOptions), std::move(ptrEvents) ),
-      m_pFile(nullptr), m_pRxBuffer(nullptr), m_nCacheSize(0), m_nCursor(0)
+      m_pFile(nullptr), m_pRxBuffer(nullptr), m_pRxCache(nullptr), m_nBufSize(0), m_nCacheSize(0), m_nCursor(0), m_nBomSize(0),
+      m_bDirect(false), m_nDirectOffset(0), m_nDirectSkip(0),
+      m_nRxCurrent(0), m_nRxReady(0), m_eRxResult(csv_result::_ok), m_bRxDone(false), m_bRxStop(false)
 {
   assert( csv_device::get_options() != nullptr );
 }
@@ -72,25 +80,53 @@ csv_dev_file::~csv_dev_file()
   release();
 }
 
-csv_dev_file_options::filetype  csv_dev_file::detect_and_skip_bom() noexcept
+csv_dev_file_options::filetype  csv_dev_file::detect_bom( const byte* pBuffer, csv_uint_t nBufferLen, csv_uint_t& nBomSize ) noexcept
 {
-  csv_dev_file_options::filetype _retVal = csv_dev_file_options::filetype::PLAIN_TEXT;
-  byte                           _rxBOM[4];
-  size_t                         _bom_size = fread( _rxBOM, sizeof(byte), 4, m_pFile );
+  nBomSize = 0;
 
   for ( uint8_t ndx = 1; ndx < static_cast<uint8_t>(csv_dev_file_options::filetype::MAX_VALUE); ++ndx )
   { 
-    if ( __BOM__[ndx][0] <= _bom_size )
-      if (memcmp ( _rxBOM, &__BOM__[ndx][1], __BOM__[ndx][0] ) == 0)
+    if ( __BOM__[ndx][0] <= nBufferLen )
+      if (memcmp ( pBuffer, &__BOM__[ndx][1], __BOM__[ndx][0] ) == 0)
       { 
-        _retVal = static_cast<csv_dev_file_options::filetype>(ndx); 
-        fseeko64( m_pFile, __BOM__[ndx][0], SEEK_SET );
-        break;
+        nBomSize = __BOM__[ndx][0];
+        return static_cast<csv_dev_file_options::filetype>(ndx); 
       }
   }
 
-  if ( _retVal == csv_dev_file_options::filetype::PLAIN_TEXT )
-    fseeko64( m_pFile, 0, SEEK_SET );
+  return csv_dev_file_options::filetype::PLAIN_TEXT;
+}
+
+csv_dev_file_options::filetype  csv_dev_file::detect_and_skip_bom() noexcept
+{
+  byte                           _rxBOM[4];
+  size_t                         _bom_size = 0;
+  csv_uint_t                     _skip     = 0;
+
+  if ( m_bDirect )
+  {
+    // Only a whole block can be read, BOM is skipped with the first buffer.
+    ssize_t _nRead = pread( fileno( m_pFile ), m_pRxBuffer, csv_dev_file_options::direct_io_alignment, 0 );
+    _bom_size = (_nRead > 0)?std::min( static_cast<size_t>(_nRead), sizeof(_rxBOM) ):0;
+    memcpy( _rxBOM, m_pRxBuffer, _bom_size );
+  }
+  else
+  {
+    _bom_size = fread( _rxBOM, sizeof(byte), 4, m_pFile );
+  }
+
+  csv_dev_file_options::filetype _retVal   = detect_bom( _rxBOM, _bom_size, _skip );
+
+  if ( m_bDirect )
+  {
+    m_nDirectOffset = 0;
+    m_nDirectSkip   = _skip;
+  }
+  else
+  {
+    fseeko64( m_pFile, static_cast<off64_t>(_skip), SEEK_SET );
+  }
+  m_nBomSize = _skip;
 
   return _retVal;
 }
@@ -129,8 +165,27 @@ csv_result csv_dev_file::open() noexcept
   if ( m_pFile != nullptr )
     return _retVal;
 
-  m_pFile        = fopen64( DeviceOption(m_ptrOptions)->get_filename().c_str(), 
-                          ((DeviceOption(m_ptrOptions)->get_mode()==csv_dev_file_options::openmode::write)?"w":"r") );
+  const bool _bRead = (DeviceOption(m_ptrOptions)->get_mode()==csv_dev_file_options::openmode::read);
+
+  // O_DIRECT is not available with fopen(), then the descriptor is still wrapped 
+  // in a FILE but data are read with pread(). File systems without direct I/O 
+  // support are opened as usual.
+  m_bDirect      = false;
+  m_pFile        = nullptr;
+  if ( _bRead && DeviceOption(m_ptrOptions)->get_direct_io() )
+  {
+    int _hFile = ::open( DeviceOption(m_ptrOptions)->get_filename().c_str(), O_RDONLY | O_DIRECT );
+    if ( _hFile != -1 )
+    {
+      m_pFile   = fdopen( _hFile, "r" );
+      m_bDirect = (m_pFile != nullptr);
+      if ( m_pFile == nullptr )
+        ::close( _hFile );
+    }
+  }
+
+  if ( m_pFile == nullptr )
+    m_pFile      = fopen64( DeviceOption(m_ptrOptions)->get_filename().c_str(), (_bRead==false)?"w":"r" );
   if ( m_pFile == nullptr  )
   {
     release();
@@ -146,14 +201,25 @@ csv_result csv_dev_file::open() noexcept
   }
 
   // Note that using an raw pointer instead of a smart pointer increase performances for the cached methods.
+  // With read ahead there is one more buffer, the one currently consumed.
+  // Buffers are aligned as required by direct I/O.
+  m_nBufSize     = DeviceOption(m_ptrOptions)->get_bufsize();
+  if ( m_bDirect )
+    m_nBufSize   = (std::max<csv_uint_t>( m_nBufSize, 1 ) + csv_dev_file_options::direct_io_alignment - 1) & ~(csv_dev_file_options::direct_io_alignment - 1);
+
   m_pRxBuffer    = nullptr;
-  if (DeviceOption(m_ptrOptions)->get_mode()==csv_dev_file_options::openmode::read)
-    m_pRxBuffer  = new(std::nothrow) byte[DeviceOption(m_ptrOptions)->get_bufsize()]; 
+  if ( _bRead )
+  {
+    void* _pBuffer = nullptr;
+    if ( posix_memalign( &_pBuffer, csv_dev_file_options::direct_io_alignment, m_nBufSize * (DeviceOption(m_ptrOptions)->get_read_ahead() + 1) ) == 0 )
+      m_pRxBuffer  = static_cast<byte*>(_pBuffer);
+  }
+  m_pRxCache     = m_pRxBuffer;
 
   m_nCacheSize   = 0;
   m_nCursor      = 0;
 
-  if ( (m_pRxBuffer == nullptr) && (DeviceOption(m_ptrOptions)->get_mode()==csv_dev_file_options::openmode::read) )
+  if ( (m_pRxBuffer == nullptr) && _bRead )
   {
     release();
 
@@ -221,6 +287,9 @@ csv_result csv_dev_file::open() noexcept
           m_ptrEvents->onError( this, csv_result::_bom_mismatch );
         }
       }      
+
+      if ( DeviceOption(m_ptrOptions)->get_read_ahead() > 0 )
+        start_read_ahead();
     }; break;
   }
 
@@ -299,7 +368,7 @@ csv_result csv_dev_file::recv(byte* pBuffer, csv_uint_t& nBufferLen) noexcept
     // amount of data in the cache.
     else if ( _nAvailableBytes < _nWishedBytes )
     {
-      memcpy( &pBuffer[_nBufCursor], &m_pRxBuffer[m_nCursor], _nAvailableBytes );
+      memcpy( &pBuffer[_nBufCursor], &m_pRxCache[m_nCursor], _nAvailableBytes );
       m_nCursor      += _nAvailableBytes;
       _nBufCursor    += _nAvailableBytes;
       _nWishedBytes  -= _nAvailableBytes;      
@@ -307,7 +376,7 @@ csv_result csv_dev_file::recv(byte* pBuffer, csv_uint_t& nBufferLen) noexcept
     // Check if there are enough bytes in the internal buffer to satisfy the request
     else if ( _nAvailableBytes >= _nWishedBytes )
     {
-      memcpy( &pBuffer[_nBufCursor], &m_pRxBuffer[m_nCursor], _nWishedBytes );
+      memcpy( &pBuffer[_nBufCursor], &m_pRxCache[m_nCursor], _nWishedBytes );
       m_nCursor     += _nWishedBytes;
       _nWishedBytes -= _nWishedBytes;
     }
@@ -340,28 +409,273 @@ csv_result csv_dev_file::recv(byte* pBuffer, csv_uint_t& nBufferLen) noexcept
   return _retVal;
 }
 
-csv_result csv_dev_file::refresh_cache() noexcept
+csv_result csv_dev_file::acquire( const byte*& pBuffer, csv_uint_t& nBufferLen ) noexcept
 {
-  m_nCacheSize = fread( m_pRxBuffer, 1, DeviceOption(m_ptrOptions)->get_bufsize(), m_pFile );
-  m_nCursor    = 0;
+  pBuffer    = nullptr;
+  nBufferLen = 0;
 
-  if ( m_nCacheSize > 0 )
+  // Do not allow call to acquire() when not in reading mode
+  if ( DeviceOption(m_ptrOptions)->get_mode() != csv_dev_file_options::openmode::read )
+    return csv_result::_wrong_call;
+
+  csv_result  _retVal = open();
+  if ( _retVal != csv_result::_ok )
+    return _retVal;
+
+  if ( m_nCursor == m_nCacheSize )
   {
-    m_devStats.rx += m_nCacheSize;
+    _retVal = refresh_cache();
   }
-  else if ( feof( m_pFile ) != 0 )
+
+  if ( _retVal == csv_result::_ok )
   {
-    return csv_result::_eof;
+    pBuffer    = &m_pRxCache[m_nCursor];
+    nBufferLen = m_nCacheSize - m_nCursor;
+  }
+  else if ( _retVal != csv_result::_rx_timedout )
+  {
+    if ( m_ptrEvents != nullptr )
+    {
+      m_ptrEvents->onError( this, _retVal );
+    }    
+
+    //Close and release resources
+    close();
+  }
+
+  return _retVal;
+}
+
+csv_result csv_dev_file::release( csv_uint_t nBufferLen ) noexcept
+{
+  if ( m_pFile == nullptr )
+    return csv_result::_closed;
+
+  m_nCursor += std::min( nBufferLen, m_nCacheSize - m_nCursor );
+
+  return csv_result::_ok;
+}
+
+csv_result csv_dev_file::seek( csv_uint_t nOffset ) noexcept
+{
+  if ( DeviceOption(m_ptrOptions)->get_mode() != csv_dev_file_options::openmode::read )
+    return csv_result::_wrong_call;
+
+  csv_result  _retVal = open();
+  if ( _retVal != csv_result::_ok )
+    return _retVal;
+
+  // Cache and buffers read in advance are discarded, next read will start from the new position.
+  stop_read_ahead();
+  m_nCacheSize = 0;
+  m_nCursor    = 0;
+
+  if ( m_bDirect )
+  {
+    m_nDirectOffset = (m_nBomSize + nOffset) & ~(csv_dev_file_options::direct_io_alignment - 1);
+    m_nDirectSkip   = (m_nBomSize + nOffset) &  (csv_dev_file_options::direct_io_alignment - 1);
   }
-  else if ( ferror( m_pFile ) != 0 )
+  else if ( fseeko64( m_pFile, static_cast<off64_t>(m_nBomSize + nOffset), SEEK_SET ) != 0 )
   {
     m_devStats.errors++;
     return csv_result::_rx_error;
   }
 
+  if ( DeviceOption(m_ptrOptions)->get_read_ahead() > 0 )
+    start_read_ahead();
+
   return csv_result::_ok;
 }
 
+csv_result csv_dev_file::refresh_cache() noexcept
+{
+  csv_result  _retVal = csv_result::_ok;
+
+  m_nCursor = 0;
+
+  if ( m_vRxSizes.empty() )
+  {
+    m_nCacheSize = m_nBufSize;
+    _retVal      = read_buffer( m_pRxBuffer, m_nCacheSize );
+  }
+  else
+  {
+    std::unique_lock<std::mutex> _lock( m_mtxRx );
+
+    m_cvRxFilled.wait( _lock, [this]{ return (m_nRxReady > 0) || m_bRxDone; } );
+
+    if ( m_nRxReady > 0 )
+    {
+      // Buffer consumed so far is given back to the thread.
+      m_nRxCurrent = (m_nRxCurrent + 1) % m_vRxSizes.size();
+      --m_nRxReady;
+      m_pRxCache   = m_pRxBuffer + m_nRxCurrent * m_nBufSize;
+      m_nCacheSize = m_vRxSizes[m_nRxCurrent];
+      m_cvRxConsumed.notify_one();
+    }
+    else
+    {
+      m_nCacheSize = 0;
+      _retVal      = m_eRxResult;
+    }
+  }
+
+  if ( m_nCacheSize > 0 )
+    m_devStats.rx += m_nCacheSize;
+  else if ( _retVal == csv_result::_rx_error )
+    m_devStats.errors++;
+
+  return _retVal;
+}
+
+csv_result csv_dev_file::read_buffer( byte* pBuffer, csv_uint_t& nLength ) noexcept
+{
+  if ( m_bDirect )
+    return read_direct( pBuffer, nLength );
+
+  nLength = fread( pBuffer, 1, nLength, m_pFile );
+
+  if ( nLength > 0 )
+    return csv_result::_ok;
+
+  if ( feof( m_pFile ) != 0 )
+    return csv_result::_eof;
+
+  if ( ferror( m_pFile ) != 0 )
+    return csv_result::_rx_error;
+
+  return csv_result::_ok;
+}
+
+csv_result csv_dev_file::read_direct( byte* pBuffer, csv_uint_t& nLength ) noexcept
+{
+  constexpr csv_uint_t _nMask  = csv_dev_file_options::direct_io_alignment - 1;
+  csv_uint_t           _nTotal = 0;
+
+  // Offset is left unaligned only by the last read at the end of the file.
+  while ( ((m_nDirectOffset & _nMask) == 0) && (_nTotal < nLength) )
+  {
+    ssize_t _nRead = -1;
+
+    // Buffer, offset and length are aligned.
+    do {
+      _nRead = pread( fileno( m_pFile ), pBuffer + _nTotal, nLength - _nTotal, static_cast<off_t>(m_nDirectOffset + _nTotal) );
+    } while ( (_nRead == -1) && (errno == EINTR) );
+
+    if ( _nRead < 0 )
+    {
+      nLength = 0;
+      return csv_result::_rx_error;
+    }
+
+    if ( _nRead == 0 )
+      break;
+
+    _nTotal += static_cast<csv_uint_t>(_nRead);
+    if ( (_nTotal & _nMask) == 0 )
+      continue;
+
+    // A short read ends at any offset only at the end of the file, otherwise data 
+    // following the last whole block are read again from an aligned offset.
+    struct stat _stat;
+    if ( fstat( fileno( m_pFile ), &_stat ) != 0 )
+    {
+      nLength = 0;
+      return csv_result::_rx_error;
+    }
+
+    if ( static_cast<off_t>(m_nDirectOffset + _nTotal) >= _stat.st_size )
+      break;
+
+    _nTotal &= ~_nMask;
+  }
+
+  nLength          = _nTotal;
+  m_nDirectOffset += nLength;
+
+  if ( m_nDirectSkip > 0 )
+  {
+    // Skip is less than a block, so only the last block can be completely discarded.
+    const csv_uint_t _nSkip = std::min( m_nDirectSkip, nLength );
+    memmove( pBuffer, pBuffer + _nSkip, nLength - _nSkip );
+    nLength      -= _nSkip;
+    m_nDirectSkip = 0;
+  }
+
+  return (nLength > 0)?csv_result::_ok:csv_result::_eof;
+}
+
+void csv_dev_file::start_read_ahead() noexcept
+{
+  const std::size_t _nBuffers = DeviceOption(m_ptrOptions)->get_read_ahead() + 1;
+
+  // Thread start filling the buffer following m_nRxCurrent, that is the first one.
+  m_vRxSizes.assign( _nBuffers, 0 );
+  m_nRxCurrent = _nBuffers - 1;
+  m_nRxReady   = 0;
+  m_eRxResult  = csv_result::_ok;
+  m_bRxDone    = false;
+  m_bRxStop    = false;
+  m_pRxCache   = m_pRxBuffer + m_nRxCurrent * m_nBufSize;
+
+  m_thReadAhead = std::thread( &csv_dev_file::read_ahead, this );
+}
+
+void csv_dev_file::stop_read_ahead() noexcept
+{
+  if ( m_thReadAhead.joinable() == false )
+    return;
+
+  {
+    std::lock_guard<std::mutex> _lock( m_mtxRx );
+    m_bRxStop = true;
+  }
+  m_cvRxConsumed.notify_one();
+  m_thReadAhead.join();
+
+  m_vRxSizes.clear();
+  m_nRxReady = 0;
+  m_bRxDone  = false;
+  m_pRxCache = m_pRxBuffer;
+}
+
+void csv_dev_file::read_ahead() noexcept
+{
+  const csv_uint_t  _nBufSize = m_nBufSize;
+  const std::size_t _nBuffers = m_vRxSizes.size();
+
+  std::unique_lock<std::mutex> _lock( m_mtxRx );
+
+  while ( true )
+  {
+    // All buffers but the one currently consumed can be filled.
+    m_cvRxConsumed.wait( _lock, [this,_nBuffers]{ return m_bRxStop || (m_nRxReady < _nBuffers - 1); } );
+    if ( m_bRxStop )
+      break;
+
+    // Index do not change while reading, since the consumer can only take buffers 
+    // already filled and so both m_nRxCurrent and m_nRxReady are updated.
+    const std::size_t _nBuffer = (m_nRxCurrent + 1 + m_nRxReady) % _nBuffers;
+
+    _lock.unlock();
+    csv_uint_t _nLength = _nBufSize;
+    csv_result _result  = read_buffer( m_pRxBuffer + _nBuffer * _nBufSize, _nLength );
+    _lock.lock();
+
+    if ( (_result != csv_result::_ok) || (_nLength == 0) )
+    {
+      m_eRxResult = _result;
+      m_bRxDone   = true;
+      m_cvRxFilled.notify_one();
+      break;
+    }
+
+    m_vRxSizes[_nBuffer] = _nLength;
+    ++m_nRxReady;
+    m_cvRxFilled.notify_one();
+  }
+}
+
 csv_result csv_dev_file::close() noexcept
 {
   if ( m_pFile == nullptr )
@@ -395,8 +709,11 @@ csv_result csv_dev_file::is_valid() const noexcept
   return csv_result::_ok;
 }
 
-constexpr void csv_dev_file::release() noexcept
+void csv_dev_file::release() noexcept
 {
+  // Thread is using both file and buffers.
+  stop_read_ahead();
+
   if( m_pFile != nullptr ) 
   {
     fclose(m_pFile);
@@ -405,9 +722,10 @@ constexpr void csv_dev_file::release() noexcept
 
   if ( m_pRxBuffer != nullptr )
   {
-    delete [] m_pRxBuffer;
+    free( m_pRxBuffer );
     m_pRxBuffer = nullptr;
   }
+  m_pRxCache = nullptr;
 
   m_nCacheSize = 0;
   m_nCursor    = 0;
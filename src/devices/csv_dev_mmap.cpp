@@ -0,0 +1,259 @@
+/**************************************************************************************************
+ * 
+ * Copyright 2022 https://github.com/fe-dagostino
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this 
+ * software and associated documentation files (the "Software"), to deal in the Software 
+ * without restriction, including without limitation the rights to use, copy, modify, 
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to 
+ * permit persons to whom the Software is furnished to do so, subject to the following 
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies 
+ * or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE 
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR 
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *************************************************************************************************/
+
+#include "csv_dev_mmap.h"
+#include <assert.h>
+#include <cstring>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace csv {
+inline namespace CSV_LIB_VERSION {
+
+#define DeviceOption(p)   (static_cast<const csv_dev_file_options *>(p.get()))
+
+
+csv_dev_mmap::csv_dev_mmap( std::unique_ptr<csv_dev_file_options> ptrDeviceOptions, core::unique_ptr<csv_device_events> ptrEvents )
+    : csv_device( "csv_dev_mmap", std::move(ptrDeviceOptions), std::move(ptrEvents) ),
+      m_hFile(-1), m_pData(nullptr), m_nSize(0), m_nCursor(0), m_nBomSize(0)
+{
+  assert( csv_device::get_options() != nullptr );
+}
+
+csv_dev_mmap::~csv_dev_mmap()
+{
+  release();
+}
+
+csv_result csv_dev_mmap::open() noexcept
+{
+  csv_result  _retVal = csv_result::_ok;
+
+  if ( m_hFile != -1 )
+    return _retVal;
+
+  if ( DeviceOption(m_ptrOptions)->get_mode() != csv_dev_file_options::openmode::read )
+    return csv_result::_wrong_call;
+
+  struct stat _stat;
+
+  m_hFile = ::open( DeviceOption(m_ptrOptions)->get_filename().c_str(), O_RDONLY );
+  if ( (m_hFile == -1) || (fstat( m_hFile, &_stat ) != 0) )
+  {
+    release();
+
+    _retVal = csv_result::_access;
+
+    if ( m_ptrEvents != nullptr )
+    {
+      m_ptrEvents->onError( this, _retVal );
+    }
+
+    return _retVal;
+  }
+
+  m_nSize   = static_cast<csv_uint_t>(_stat.st_size);
+  m_nCursor = 0;
+
+  // An empty file cannot be mapped, but it is still a valid file.
+  if ( m_nSize > 0 )
+  {
+    void* _pData = mmap( nullptr, m_nSize, PROT_READ, MAP_PRIVATE, m_hFile, 0 );
+    if ( _pData == MAP_FAILED )
+    {
+      release();
+
+      _retVal = csv_result::_no_mem;
+
+      if ( m_ptrEvents != nullptr )
+      {
+        m_ptrEvents->onError( this, _retVal );
+      }
+
+      return _retVal;
+    }
+
+    // Hints are not mandatory, so errors are ignored.
+    madvise( _pData, m_nSize, MADV_SEQUENTIAL );
+    madvise( _pData, m_nSize, MADV_WILLNEED   );
+
+    m_pData = static_cast<const byte*>(_pData);
+  }
+
+  if ( m_ptrEvents != nullptr )
+  {
+    m_ptrEvents->onOpened( this );
+  }
+
+  ///////////////////////////////
+  // Detect BOM
+  csv_uint_t _bom_size     = 0;
+  auto       _detected_bom = csv_dev_file::detect_bom( m_pData, std::min( m_nSize, csv_uint_t(4) ), _bom_size );
+  if (
+      ( DeviceOption(m_ptrOptions)->get_bom() != _detected_bom ) &&
+      ( DeviceOption(m_ptrOptions)->get_bom() != csv_dev_file_options::filetype::PLAIN_TEXT )
+    )
+  {
+    if ( m_ptrEvents != nullptr )
+    {
+      m_ptrEvents->onError( this, csv_result::_bom_mismatch );
+    }
+  }      
+  m_nCursor  = _bom_size;
+  m_nBomSize = _bom_size;
+
+  m_devStats.rx     = 0;
+  m_devStats.tx     = 0;
+  m_devStats.errors = 0;
+
+  return _retVal;
+}
+
+csv_result csv_dev_mmap::send( [[maybe_unused]] const byte* pBuffer, [[maybe_unused]] csv_uint_t iBufferLen) noexcept
+{
+  // Only reading is supported
+  return csv_result::_wrong_call;
+}
+
+csv_result csv_dev_mmap::recv(byte* pBuffer, csv_uint_t& nBufferLen) noexcept
+{
+  const byte* _pData   = nullptr;
+  csv_uint_t  _nLength = 0;
+  csv_result  _retVal  = acquire( _pData, _nLength );
+
+  if ( _retVal != csv_result::_ok )
+  {
+    nBufferLen = 0;
+    return _retVal;
+  }
+
+  nBufferLen = std::min( nBufferLen, _nLength );
+  memcpy( pBuffer, _pData, nBufferLen );
+
+  return release( nBufferLen );
+}
+
+csv_result csv_dev_mmap::acquire( const byte*& pBuffer, csv_uint_t& nBufferLen ) noexcept
+{
+  pBuffer    = nullptr;
+  nBufferLen = 0;
+
+  csv_result  _retVal = open();
+  if ( _retVal != csv_result::_ok )
+    return _retVal;
+
+  if ( m_nCursor == m_nSize )
+    return on_recv_error( csv_result::_eof );
+
+  pBuffer    = &m_pData[m_nCursor];
+  nBufferLen = m_nSize - m_nCursor;
+
+  return _retVal;
+}
+
+csv_result csv_dev_mmap::release( csv_uint_t nBufferLen ) noexcept
+{
+  if ( m_hFile == -1 )
+    return csv_result::_closed;
+
+  nBufferLen     = std::min( nBufferLen, m_nSize - m_nCursor );
+  m_nCursor     += nBufferLen;
+  m_devStats.rx += nBufferLen;
+
+  return csv_result::_ok;
+}
+
+csv_result csv_dev_mmap::seek( csv_uint_t nOffset ) noexcept
+{
+  csv_result  _retVal = open();
+  if ( _retVal != csv_result::_ok )
+    return _retVal;
+
+  if ( nOffset > m_nSize - m_nBomSize )
+    return csv_result::_eof;
+
+  m_nCursor = m_nBomSize + nOffset;
+
+  return csv_result::_ok;
+}
+
+csv_result csv_dev_mmap::on_recv_error( csv_result result ) noexcept
+{
+  if ( m_ptrEvents != nullptr )
+  {
+    m_ptrEvents->onError( this, result );
+  }
+
+  //Close and release resources
+  close();
+
+  return result;
+}
+
+csv_result csv_dev_mmap::close() noexcept
+{
+  if ( m_hFile == -1 )
+    return csv_result::_closed;
+
+  release();
+
+  if ( m_ptrEvents != nullptr )
+  {
+    m_ptrEvents->onClosed( this );
+  }
+
+  return csv_result::_ok;
+}
+
+csv_result csv_dev_mmap::is_valid() const noexcept
+{
+  if ( m_hFile == -1 )
+    return csv_result::_closed;
+
+  return csv_result::_ok;
+}
+
+void csv_dev_mmap::release() noexcept
+{
+  if ( m_pData != nullptr )
+  {
+    munmap( const_cast<byte*>(m_pData), m_nSize );
+    m_pData = nullptr;
+  }
+
+  if( m_hFile != -1 ) 
+  {
+    ::close(m_hFile);
+    m_hFile = -1;
+  }
+
+  m_nSize   = 0;
+  m_nCursor = 0;
+}
+
+
+} //inline namespace
+} // namespace
@@ -0,0 +1,627 @@
+/**************************************************************************************************
+ * 
+ * Copyright 2022 https://github.com/fe-dagostino
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this 
+ * software and associated documentation files (the "Software"), to deal in the Software 
+ * without restriction, including without limitation the rights to use, copy, modify, 
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to 
+ * permit persons to whom the Software is furnished to do so, subject to the following 
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies 
+ * or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE 
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR 
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *************************************************************************************************/
+
+#include "csv_dev_uring.h"
+
+#ifdef CSV_HAS_IO_URING
+
+#include <assert.h>
+#include <cstring>
+#include <cstdlib>
+#include <cerrno>
+#include <atomic>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+namespace csv {
+inline namespace CSV_LIB_VERSION {
+
+#define DeviceOption(p)   (static_cast<const csv_dev_file_options *>(p.get()))
+
+static constexpr std::size_t  npos = static_cast<std::size_t>(-1);
+
+
+csv_dev_uring::csv_dev_uring( std::unique_ptr<csv_dev_file_options> ptrDeviceOptions, core::unique_ptr<csv_device_events> ptrEvents )
+    : csv_device( "csv_dev_uring", std::move(ptrDeviceOptions), std::move(ptrEvents) ),
+      m_hFile(-1), m_hRing(-1), m_bFixed(false), m_bDirect(false),
+      m_pSqRing(nullptr), m_nSqRingSize(0), m_pCqRing(nullptr), m_nCqRingSize(0), m_pSqes(nullptr), m_nSqesSize(0),
+      m_pSqHead(nullptr), m_pSqTail(nullptr), m_nSqMask(0), m_pSqArray(nullptr), 
+      m_pCqHead(nullptr), m_pCqTail(nullptr), m_nCqMask(0), m_pCqes(nullptr), m_nQueued(0),
+      m_pRxBuffer(nullptr), m_nBufSize(0), m_nInFlight(0), m_nNext(0), m_nCurrent(npos),
+      m_nSize(0), m_nBomSize(0), m_nReadOffset(0), m_nSkip(0), m_pCache(nullptr), m_nCacheSize(0), m_nCursor(0)
+{
+  assert( csv_device::get_options() != nullptr );
+}
+
+csv_dev_uring::~csv_dev_uring()
+{
+  release();
+}
+
+csv_result csv_dev_uring::open() noexcept
+{
+  csv_result  _retVal = csv_result::_ok;
+
+  if ( m_hFile != -1 )
+    return _retVal;
+
+  if ( DeviceOption(m_ptrOptions)->get_mode() != csv_dev_file_options::openmode::read )
+    return csv_result::_wrong_call;
+
+  struct stat _stat;
+
+  // File systems without direct I/O support are opened as usual.
+  m_bDirect = false;
+  if ( DeviceOption(m_ptrOptions)->get_direct_io() )
+  {
+    m_hFile   = ::open( DeviceOption(m_ptrOptions)->get_filename().c_str(), O_RDONLY | O_DIRECT );
+    m_bDirect = (m_hFile != -1);
+  }
+  if ( m_hFile == -1 )
+    m_hFile = ::open( DeviceOption(m_ptrOptions)->get_filename().c_str(), O_RDONLY );
+  if ( (m_hFile == -1) || (fstat( m_hFile, &_stat ) != 0) )
+  {
+    release();
+
+    _retVal = csv_result::_access;
+
+    if ( m_ptrEvents != nullptr )
+    {
+      m_ptrEvents->onError( this, _retVal );
+    }
+
+    return _retVal;
+  }
+
+  m_nSize = static_cast<csv_uint_t>(_stat.st_size);
+
+  // At least two buffers are needed to overlap reads with parsing.
+  const std::size_t _nReadAhead = DeviceOption(m_ptrOptions)->get_read_ahead();
+  const std::size_t _nBuffers   = (_nReadAhead < 2)?4:_nReadAhead;
+
+  // Buffers are aligned as required for direct I/O.
+  m_nBufSize = std::max<csv_uint_t>( DeviceOption(m_ptrOptions)->get_bufsize(), 1 );
+  if ( m_bDirect )
+    m_nBufSize = (m_nBufSize + csv_dev_file_options::direct_io_alignment - 1) & ~(csv_dev_file_options::direct_io_alignment - 1);
+
+  void* _pBuffer = nullptr;
+  if ( posix_memalign( &_pBuffer, csv_dev_file_options::direct_io_alignment, m_nBufSize * _nBuffers ) != 0 )
+  {
+    release();
+
+    _retVal = csv_result::_no_mem;
+
+    if ( m_ptrEvents != nullptr )
+    {
+      m_ptrEvents->onError( this, _retVal );
+    }
+
+    return _retVal;
+  }
+  m_pRxBuffer = static_cast<byte*>(_pBuffer);
+
+  if ( setup_ring( static_cast<unsigned>(_nBuffers) ) == false )
+  {
+    release();
+
+    _retVal = csv_result::_cfg_error;
+
+    if ( m_ptrEvents != nullptr )
+    {
+      m_ptrEvents->onError( this, _retVal );
+    }
+
+    return _retVal;
+  }
+
+  // Registered buffers save mapping pages for each read, but they are limited 
+  // by RLIMIT_MEMLOCK, so plain reads are used when registration fails.
+  std::vector<struct iovec> _vIovecs( _nBuffers );
+  for ( std::size_t ndx = 0; ndx < _nBuffers; ++ndx )
+  {
+    _vIovecs[ndx].iov_base = m_pRxBuffer + ndx * m_nBufSize;
+    _vIovecs[ndx].iov_len  = m_nBufSize;
+  }
+  m_bFixed = (syscall( __NR_io_uring_register, m_hRing, IORING_REGISTER_BUFFERS, _vIovecs.data(), static_cast<unsigned>(_nBuffers) ) == 0);
+
+  m_vStates.assign   ( _nBuffers, state_t::free );
+  m_vOffsets.assign  ( _nBuffers, 0 );
+  m_vLengths.assign  ( _nBuffers, 0 );
+  m_vRequested.assign( _nBuffers, 0 );
+
+  if ( m_ptrEvents != nullptr )
+  {
+    m_ptrEvents->onOpened( this );
+  }
+
+  ///////////////////////////////
+  // Detect BOM
+  // With direct I/O only a whole block can be read, in a buffer not yet in use.
+  byte       _rxBOM[4];
+  byte*      _pBOM         = m_bDirect?m_pRxBuffer:_rxBOM;
+  ssize_t    _nRead        = pread( m_hFile, _pBOM, m_bDirect?csv_dev_file_options::direct_io_alignment:sizeof(_rxBOM), 0 );
+  csv_uint_t _bom_size     = 0;
+  auto       _detected_bom = csv_dev_file::detect_bom( _pBOM, (_nRead > 0)?std::min( static_cast<csv_uint_t>(_nRead), csv_uint_t(4) ):0, _bom_size );
+  if (
+      ( DeviceOption(m_ptrOptions)->get_bom() != _detected_bom ) &&
+      ( DeviceOption(m_ptrOptions)->get_bom() != csv_dev_file_options::filetype::PLAIN_TEXT )
+    )
+  {
+    if ( m_ptrEvents != nullptr )
+    {
+      m_ptrEvents->onError( this, csv_result::_bom_mismatch );
+    }
+  }      
+  m_nBomSize = _bom_size;
+
+  m_devStats.rx     = 0;
+  m_devStats.tx     = 0;
+  m_devStats.errors = 0;
+
+  // All buffers are immediately in flight.
+  m_nReadOffset = m_bDirect?0:m_nBomSize;
+  m_nSkip       = m_bDirect?m_nBomSize:0;
+  m_nNext       = 0;
+  m_nCurrent    = npos;
+  for ( std::size_t ndx = 0; ndx < _nBuffers; ++ndx )
+    queue_next( ndx );
+  enter( 0 );
+
+  return _retVal;
+}
+
+csv_result csv_dev_uring::send( [[maybe_unused]] const byte* pBuffer, [[maybe_unused]] csv_uint_t iBufferLen) noexcept
+{
+  // Only reading is supported
+  return csv_result::_wrong_call;
+}
+
+csv_result csv_dev_uring::recv(byte* pBuffer, csv_uint_t& nBufferLen) noexcept
+{
+  const byte* _pData   = nullptr;
+  csv_uint_t  _nLength = 0;
+  csv_result  _retVal  = acquire( _pData, _nLength );
+
+  if ( _retVal != csv_result::_ok )
+  {
+    nBufferLen = 0;
+    return _retVal;
+  }
+
+  nBufferLen = std::min( nBufferLen, _nLength );
+  memcpy( pBuffer, _pData, nBufferLen );
+
+  return release( nBufferLen );
+}
+
+csv_result csv_dev_uring::acquire( const byte*& pBuffer, csv_uint_t& nBufferLen ) noexcept
+{
+  pBuffer    = nullptr;
+  nBufferLen = 0;
+
+  csv_result  _retVal = open();
+  if ( _retVal != csv_result::_ok )
+    return _retVal;
+
+  if ( m_nCursor == m_nCacheSize )
+  {
+    _retVal = refresh_cache();
+    if ( _retVal != csv_result::_ok )
+      return on_recv_error( _retVal );
+  }
+
+  pBuffer    = &m_pCache[m_nCursor];
+  nBufferLen = m_nCacheSize - m_nCursor;
+
+  return _retVal;
+}
+
+csv_result csv_dev_uring::release( csv_uint_t nBufferLen ) noexcept
+{
+  if ( m_hFile == -1 )
+    return csv_result::_closed;
+
+  m_nCursor += std::min( nBufferLen, m_nCacheSize - m_nCursor );
+
+  return csv_result::_ok;
+}
+
+csv_result csv_dev_uring::seek( csv_uint_t nOffset ) noexcept
+{
+  csv_result  _retVal = open();
+  if ( _retVal != csv_result::_ok )
+    return _retVal;
+
+  if ( nOffset > m_nSize - m_nBomSize )
+    return csv_result::_eof;
+
+  // Data already read are discarded.
+  drain();
+  std::fill( m_vStates.begin(), m_vStates.end(), state_t::free );
+  m_nNext       = 0;
+  m_nCurrent    = npos;
+  m_nCacheSize  = 0;
+  m_nCursor     = 0;
+  m_nReadOffset = m_nBomSize + nOffset;
+  m_nSkip       = 0;
+
+  // Direct reads start from the block containing nOffset.
+  if ( m_bDirect )
+  {
+    m_nSkip        = m_nReadOffset & (csv_dev_file_options::direct_io_alignment - 1);
+    m_nReadOffset -= m_nSkip;
+  }
+
+  for ( std::size_t ndx = 0; ndx < m_vStates.size(); ++ndx )
+    queue_next( ndx );
+  enter( 0 );
+
+  return csv_result::_ok;
+}
+
+csv_result csv_dev_uring::on_recv_error( csv_result result ) noexcept
+{
+  if ( m_ptrEvents != nullptr )
+  {
+    m_ptrEvents->onError( this, result );
+  }
+
+  //Close and release resources
+  close();
+
+  return result;
+}
+
+csv_result csv_dev_uring::close() noexcept
+{
+  if ( m_hFile == -1 )
+    return csv_result::_closed;
+
+  release();
+
+  if ( m_ptrEvents != nullptr )
+  {
+    m_ptrEvents->onClosed( this );
+  }
+
+  return csv_result::_ok;
+}
+
+csv_result csv_dev_uring::is_valid() const noexcept
+{
+  if ( m_hFile == -1 )
+    return csv_result::_closed;
+
+  return csv_result::_ok;
+}
+
+bool csv_dev_uring::setup_ring( unsigned nEntries ) noexcept
+{
+  struct io_uring_params _params;
+  memset( &_params, 0, sizeof(_params) );
+
+  m_hRing = static_cast<int>(syscall( __NR_io_uring_setup, nEntries, &_params ));
+  if ( m_hRing < 0 )
+  {
+    m_hRing = -1;
+    return false;
+  }
+
+  m_nSqRingSize = _params.sq_off.array + _params.sq_entries * sizeof(unsigned);
+  m_nCqRingSize = _params.cq_off.cqes  + _params.cq_entries * sizeof(struct io_uring_cqe);
+
+  // With IORING_FEAT_SINGLE_MMAP both rings are in the same mapping.
+  if ( _params.features & IORING_FEAT_SINGLE_MMAP )
+    m_nSqRingSize = m_nCqRingSize = std::max( m_nSqRingSize, m_nCqRingSize );
+
+  m_pSqRing = mmap( nullptr, m_nSqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_hRing, IORING_OFF_SQ_RING );
+  if ( m_pSqRing == MAP_FAILED )
+  {
+    m_pSqRing = nullptr;
+    return false;
+  }
+
+  if ( _params.features & IORING_FEAT_SINGLE_MMAP )
+  {
+    m_pCqRing = m_pSqRing;
+  }
+  else
+  {
+    m_pCqRing = mmap( nullptr, m_nCqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_hRing, IORING_OFF_CQ_RING );
+    if ( m_pCqRing == MAP_FAILED )
+    {
+      m_pCqRing = nullptr;
+      return false;
+    }
+  }
+
+  m_nSqesSize = _params.sq_entries * sizeof(struct io_uring_sqe);
+  void* _pSqes = mmap( nullptr, m_nSqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_hRing, IORING_OFF_SQES );
+  if ( _pSqes == MAP_FAILED )
+    return false;
+  m_pSqes = static_cast<struct io_uring_sqe*>(_pSqes);
+
+  byte* _pSq = static_cast<byte*>(m_pSqRing);
+  byte* _pCq = static_cast<byte*>(m_pCqRing);
+
+  m_pSqHead  = reinterpret_cast<unsigned*>( _pSq + _params.sq_off.head  );
+  m_pSqTail  = reinterpret_cast<unsigned*>( _pSq + _params.sq_off.tail  );
+  m_nSqMask  = *reinterpret_cast<unsigned*>( _pSq + _params.sq_off.ring_mask );
+  m_pSqArray = reinterpret_cast<unsigned*>( _pSq + _params.sq_off.array );
+  m_pCqHead  = reinterpret_cast<unsigned*>( _pCq + _params.cq_off.head  );
+  m_pCqTail  = reinterpret_cast<unsigned*>( _pCq + _params.cq_off.tail  );
+  m_nCqMask  = *reinterpret_cast<unsigned*>( _pCq + _params.cq_off.ring_mask );
+  m_pCqes    = reinterpret_cast<struct io_uring_cqe*>( _pCq + _params.cq_off.cqes );
+  m_nQueued  = 0;
+
+  return true;
+}
+
+void csv_dev_uring::queue_read( std::size_t nBuffer ) noexcept
+{
+  // Only this thread write the tail, the kernel read it when entering.
+  const unsigned         _nTail = *m_pSqTail;
+  const unsigned         _nSqe  = _nTail & m_nSqMask;
+  struct io_uring_sqe*   _pSqe  = &m_pSqes[_nSqe];
+
+  memset( _pSqe, 0, sizeof(*_pSqe) );
+  _pSqe->opcode    = m_bFixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+  _pSqe->fd        = m_hFile;
+  _pSqe->addr      = reinterpret_cast<uint64_t>( m_pRxBuffer + nBuffer * m_nBufSize + m_vLengths[nBuffer] );
+  // Direct reads length is rounded up to the block, the buffer is large enough 
+  // and the read is completed anyway at the end of the file.
+  csv_uint_t _nLength = m_vRequested[nBuffer] - m_vLengths[nBuffer];
+  if ( m_bDirect )
+    _nLength = (_nLength + csv_dev_file_options::direct_io_alignment - 1) & ~(csv_dev_file_options::direct_io_alignment - 1);
+
+  _pSqe->len       = static_cast<uint32_t>( _nLength );
+  _pSqe->off       = m_vOffsets[nBuffer] + m_vLengths[nBuffer];
+  _pSqe->buf_index = m_bFixed ? static_cast<uint16_t>(nBuffer) : 0;
+  _pSqe->user_data = nBuffer;
+
+  m_pSqArray[_nSqe] = _nSqe;
+  std::atomic_ref<unsigned>( *m_pSqTail ).store( _nTail + 1, std::memory_order_release );
+
+  m_vStates[nBuffer] = state_t::reading;
+  ++m_nInFlight;
+  ++m_nQueued;
+}
+
+void csv_dev_uring::resume_read( std::size_t nBuffer ) noexcept
+{
+  constexpr csv_uint_t _nMask = csv_dev_file_options::direct_io_alignment - 1;
+
+  if ( m_bDirect && ((m_vLengths[nBuffer] & _nMask) != 0) )
+  {
+    struct stat _stat;
+    if ( fstat( m_hFile, &_stat ) != 0 )
+    {
+      m_vStates[nBuffer] = state_t::failed;
+      return;
+    }
+
+    // A short read ends at any offset only when the file has been truncated after 
+    // open(), otherwise data following the last whole block are read again.
+    if ( static_cast<off_t>(m_vOffsets[nBuffer] + m_vLengths[nBuffer]) >= _stat.st_size )
+    {
+      m_vStates[nBuffer] = state_t::ready;
+      return;
+    }
+
+    m_vLengths[nBuffer] &= ~_nMask;
+  }
+
+  queue_read( nBuffer );
+}
+
+void csv_dev_uring::queue_next( std::size_t nBuffer ) noexcept
+{
+  if ( m_nReadOffset >= m_nSize )
+  {
+    m_vStates[nBuffer] = state_t::free;
+    return;
+  }
+
+  m_vOffsets  [nBuffer] = m_nReadOffset;
+  m_vLengths  [nBuffer] = 0;
+  m_vRequested[nBuffer] = std::min( m_nBufSize, m_nSize - m_nReadOffset );
+  m_nReadOffset        += m_vRequested[nBuffer];
+
+  queue_read( nBuffer );
+}
+
+bool csv_dev_uring::enter( unsigned nWait ) noexcept
+{
+  while ( true )
+  {
+    const long _nRes = syscall( __NR_io_uring_enter, m_hRing, m_nQueued, nWait, (nWait > 0)?IORING_ENTER_GETEVENTS:0, nullptr, 0 );
+    if ( _nRes >= 0 )
+    {
+      m_nQueued -= std::min( m_nQueued, static_cast<unsigned>(_nRes) );
+      return true;
+    }
+
+    if ( errno != EINTR )
+      return false;
+  }
+}
+
+void csv_dev_uring::reap() noexcept
+{
+  unsigned        _nHead = *m_pCqHead;
+  const unsigned  _nTail = std::atomic_ref<unsigned>( *m_pCqTail ).load( std::memory_order_acquire );
+
+  for ( ; _nHead != _nTail; ++_nHead )
+  {
+    const struct io_uring_cqe& _cqe     = m_pCqes[_nHead & m_nCqMask];
+    const std::size_t          _nBuffer = static_cast<std::size_t>(_cqe.user_data);
+
+    --m_nInFlight;
+
+    if ( (_cqe.res == -EAGAIN) || (_cqe.res == -EINTR) )
+    {
+      queue_read( _nBuffer );
+    }
+    else if ( _cqe.res < 0 )
+    {
+      m_vStates[_nBuffer] = state_t::failed;
+    }
+    else
+    {
+      // A short read is completed with a new request, while no data means that 
+      // the file has been truncated after open().
+      m_vLengths[_nBuffer] += static_cast<csv_uint_t>(_cqe.res);
+      if ( (_cqe.res > 0) && (m_vLengths[_nBuffer] < m_vRequested[_nBuffer]) )
+        resume_read( _nBuffer );
+      else
+        m_vStates[_nBuffer] = state_t::ready;
+    }
+  }
+
+  std::atomic_ref<unsigned>( *m_pCqHead ).store( _nHead, std::memory_order_release );
+}
+
+void csv_dev_uring::drain() noexcept
+{
+  while ( m_nInFlight > 0 )
+  {
+    if ( enter( 1 ) == false )
+      break;
+    reap();
+  }
+}
+
+csv_result csv_dev_uring::refresh_cache() noexcept
+{
+  // Buffer consumed so far is used for next read in file order.
+  if ( m_nCurrent != npos )
+  {
+    queue_next( m_nCurrent );
+    m_nCurrent = npos;
+  }
+
+  const std::size_t _nBuffer = m_nNext;
+
+  while ( m_vStates[_nBuffer] == state_t::reading )
+  {
+    if ( enter( 1 ) == false )
+    {
+      m_devStats.errors++;
+      return csv_result::_rx_error;
+    }
+    reap();
+  }
+
+  if ( m_nQueued > 0 )
+    enter( 0 );
+
+  m_nCacheSize = 0;
+  m_nCursor    = 0;
+
+  switch ( m_vStates[_nBuffer] )
+  {
+    case state_t::failed:
+      m_devStats.errors++;
+      return csv_result::_rx_error;
+
+    case state_t::ready:
+      if ( m_vLengths[_nBuffer] > 0 )
+        break;
+      [[fallthrough]];
+
+    default:
+      return csv_result::_eof;
+  }
+
+  m_nCurrent      = _nBuffer;
+  m_nNext         = (_nBuffer + 1) % m_vStates.size();
+
+  // BOM or data before a seek() offset are discarded.
+  const csv_uint_t _nSkip = std::min( m_nSkip, m_vLengths[_nBuffer] );
+  m_nSkip         = 0;
+  m_pCache        = m_pRxBuffer + _nBuffer * m_nBufSize + _nSkip;
+  m_nCacheSize    = m_vLengths[_nBuffer] - _nSkip;
+  m_devStats.rx  += m_nCacheSize;
+
+  return (m_nCacheSize > 0)?csv_result::_ok:csv_result::_eof;
+}
+
+void csv_dev_uring::release() noexcept
+{
+  // Kernel could still write in buffers for reads in flight.
+  if ( m_hRing != -1 )
+  {
+    if ( (m_pSqes != nullptr) && (m_pCqRing != nullptr) )
+      drain();
+
+    if ( m_pSqes != nullptr )
+      munmap( m_pSqes, m_nSqesSize );
+    if ( (m_pCqRing != nullptr) && (m_pCqRing != m_pSqRing) )
+      munmap( m_pCqRing, m_nCqRingSize );
+    if ( m_pSqRing != nullptr )
+      munmap( m_pSqRing, m_nSqRingSize );
+
+    ::close( m_hRing );
+    m_hRing = -1;
+  }
+
+  m_pSqes     = nullptr;
+  m_pSqRing   = nullptr;
+  m_pCqRing   = nullptr;
+  m_bFixed    = false;
+  m_bDirect   = false;
+  m_nQueued   = 0;
+  m_nInFlight = 0;
+
+  if ( m_pRxBuffer != nullptr )
+  {
+    free( m_pRxBuffer );
+    m_pRxBuffer = nullptr;
+  }
+
+  if( m_hFile != -1 ) 
+  {
+    ::close(m_hFile);
+    m_hFile = -1;
+  }
+
+  m_vStates.clear();
+  m_nSize      = 0;
+  m_nCurrent   = npos;
+  m_nNext      = 0;
+  m_pCache     = nullptr;
+  m_nCacheSize = 0;
+  m_nCursor    = 0;
+}
+
+
+} //inline namespace
+} // namespace
+
+#endif // CSV_HAS_IO_URING
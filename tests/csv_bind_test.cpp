@@ -0,0 +1,220 @@
+/**************************************************************************************************
+ * 
+ * Copyright 2022 https://github.com/fe-dagostino
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this 
+ * software and associated documentation files (the "Software"), to deal in the Software 
+ * without restriction, including without limitation the rights to use, copy, modify, 
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to 
+ * permit persons to whom the Software is furnished to do so, subject to the following 
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies 
+ * or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE 
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR 
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *************************************************************************************************/
+
+#include "csv_test_utils.h"
+#include "csv_bind.h"
+#include <tuple>
+
+using namespace csv;
+using namespace csv_test;
+
+namespace {
+
+/***/
+struct trade
+{
+  int64_t           id     = -1;
+  int               qty    = -1;
+  double            price  = -1;
+  bool              flag   = false;
+  std::string       symbol = "none";
+  csv_data_t        note;
+  std::string_view  view   = "none";
+};
+
+/***/
+csv_bind<trade> make_bind()
+{
+  csv_bind<trade> _bind;
+  _bind.column<&trade::id>( "id" )
+       .column<&trade::qty>( "qty" )
+       .column<&trade::price>( "price" )
+       .column<&trade::flag>( "flag" )
+       .column<&trade::symbol>( "symbol" )
+       .column<&trade::note>( "note" )
+       .column<&trade::view>( "view" );
+  return _bind;
+}
+
+/***/
+std::unique_ptr<csv_reader> make_reader( const temp_file& file )
+{ return std::make_unique<csv_reader>( "test", std::make_unique<csv_dev_file>( file_options( file.path(), 64 ), nullptr ), nullptr ); }
+
+} // namespace
+
+TEST( csv_bind_test, every_member_kind )
+{
+  temp_file       file( "bind.csv", "symbol,id,qty,price,flag,note,view\n"
+                                    "AAA,1,10,2.5,1,first,v1\n"
+                                    "BBB,2,-3,1e3,0,,v2\n"
+                                    "\"C,C\",3,+4,-.5,true,\"x\"\"y\",v3\n"
+                                    "D,4,5,6,False,y,v4\n" );
+  auto            reader = make_reader( file );
+  csv_bind<trade> bind   = make_bind();
+  trade           item;
+
+  ASSERT_EQ( 7u, bind.size() );
+  EXPECT_FALSE( bind.resolved() );
+
+  const std::vector<std::tuple<int64_t,int,double,bool,std::string,std::string,std::string>> expected = {
+    { 1, 10, 2.5,    true,  "AAA", "first",  "v1" },
+    { 2, -3, 1000.0, false, "BBB", "",       "v2" },
+    { 3, 4,  -0.5,   true,  "C,C", "x\"\"y", "v3" },
+    { 4, 5,  6.0,    false, "D",   "y",      "v4" },
+  };
+
+  for ( const auto& [id, qty, price, flag, symbol, note, view] : expected )
+  {
+    ASSERT_TRUE( reader->read( bind, item ) );
+    EXPECT_TRUE( bind.resolved() );
+    EXPECT_EQ( 0u, bind.errors() ) << "id " << id;
+    EXPECT_EQ( id,     item.id );
+    EXPECT_EQ( qty,    item.qty );
+    EXPECT_DOUBLE_EQ( price, item.price );
+    EXPECT_EQ( flag,   item.flag );
+    EXPECT_EQ( symbol, item.symbol );
+    EXPECT_EQ( note,   std::string_view( item.note.data(), item.note.length() ) );
+    // Valid until next read.
+    EXPECT_EQ( view,   item.view );
+  }
+  EXPECT_FALSE( reader->read( bind, item ) );
+}
+
+TEST( csv_bind_test, invalid_fields_are_not_modified )
+{
+  temp_file       file( "invalid.csv", "id,qty,price,flag,symbol\n"
+                                       "x,99999999999,abc,yes,S\n"
+                                       "7,1.5,2,TRUE,T\n" );
+  auto            reader = make_reader( file );
+  csv_bind<trade> bind   = make_bind();
+  trade           item;
+
+  ASSERT_TRUE( reader->read( bind, item ) );
+  // note and view are not part of the header, id, qty, price and flag are not valid.
+  EXPECT_EQ( 6u, bind.errors() );
+  EXPECT_EQ( -1,     item.id );
+  EXPECT_EQ( -1,     item.qty );
+  EXPECT_EQ( -1.0,   item.price );
+  EXPECT_FALSE( item.flag );
+  EXPECT_EQ( "S",    item.symbol );
+  EXPECT_EQ( "none", item.view );
+
+  ASSERT_TRUE( reader->read( bind, item ) );
+  EXPECT_EQ( 3u, bind.errors() );
+  EXPECT_EQ( 7,      item.id );
+  EXPECT_EQ( -1,     item.qty );
+  EXPECT_EQ( 2.0,    item.price );
+  EXPECT_TRUE( item.flag );
+  EXPECT_EQ( "T",    item.symbol );
+}
+
+TEST( csv_bind_test, unknown_label_is_an_error_for_each_row )
+{
+  temp_file       file( "unknown.csv", "id,qty\n1,2\n3,4\n5,6\n" );
+  auto            reader = make_reader( file );
+  csv_bind<trade> bind;
+  trade           item;
+
+  bind.column<&trade::id>( "id" ).column<&trade::qty>( "qty" ).column<&trade::price>( "unknown" );
+
+  std::size_t rows = 0;
+  while ( reader->read( bind, item ) )
+  {
+    ++rows;
+    EXPECT_EQ( 1u, bind.errors() );
+    EXPECT_EQ( static_cast<int64_t>(2*rows-1), item.id );
+    EXPECT_EQ( static_cast<int>(2*rows), item.qty );
+    EXPECT_EQ( -1.0, item.price );
+  }
+  EXPECT_EQ( 3u, rows );
+
+  EXPECT_FALSE( bind.resolve( reader->get_header() ) );
+}
+
+TEST( csv_bind_test, short_rows_leave_members_untouched )
+{
+  temp_file       file( "short.csv", "id,qty,symbol\n1,2,A\n3\n4,5,B\n" );
+  auto            reader = make_reader( file );
+  csv_bind<trade> bind;
+  trade           item;
+
+  bind.column<&trade::id>( "id" ).column<&trade::qty>( "qty" ).column<&trade::symbol>( "symbol" );
+
+  ASSERT_TRUE( reader->read( bind, item ) );
+  EXPECT_EQ( 0u, bind.errors() );
+
+  ASSERT_TRUE( reader->read( bind, item ) );
+  EXPECT_EQ( 2u, bind.errors() );
+  EXPECT_EQ( 3,   item.id );
+  EXPECT_EQ( 2,   item.qty );
+  EXPECT_EQ( "A", item.symbol );
+
+  ASSERT_TRUE( reader->read( bind, item ) );
+  EXPECT_EQ( 0u, bind.errors() );
+  EXPECT_EQ( 4,   item.id );
+  EXPECT_EQ( 5,   item.qty );
+  EXPECT_EQ( "B", item.symbol );
+}
+
+TEST( csv_bind_test, reset_resolve_a_new_header )
+{
+  temp_file       first( "first.csv",   "id,qty\n1,2\n" );
+  temp_file       second( "second.csv", "qty,other,id\n3,x,4\n" );
+  csv_bind<trade> bind;
+  trade           item;
+
+  bind.column<&trade::id>( "id" ).column<&trade::qty>( "qty" );
+
+  ASSERT_TRUE( make_reader( first )->read( bind, item ) );
+  EXPECT_EQ( 1, item.id );
+  EXPECT_EQ( 2, item.qty );
+
+  // Indexes from the first header are still in use.
+  ASSERT_TRUE( make_reader( second )->read( bind, item ) );
+  EXPECT_EQ( 1u, bind.errors() );
+  EXPECT_EQ( 3, item.id );
+
+  bind.reset();
+  EXPECT_FALSE( bind.resolved() );
+  ASSERT_TRUE( make_reader( second )->read( bind, item ) );
+  EXPECT_TRUE( bind.resolved() );
+  EXPECT_EQ( 0u, bind.errors() );
+  EXPECT_EQ( 4, item.id );
+  EXPECT_EQ( 3, item.qty );
+}
+
+TEST( csv_bind_test, assign_from_csv_row )
+{
+  temp_file       file( "row.csv", "flag,price\nTrue,1.25\n" );
+  auto            reader = make_reader( file );
+  csv_bind<trade> bind;
+  trade           item;
+  csv_row         row;
+
+  bind.column<&trade::flag>( "flag" ).column<&trade::price>( "price" );
+  ASSERT_TRUE( reader->read( row ) );
+  ASSERT_TRUE( bind.resolve( reader->get_header() ) );
+  EXPECT_TRUE( bind.assign( row, item ) );
+  EXPECT_TRUE( item.flag );
+  EXPECT_EQ( 1.25, item.price );
+}
@@ -0,0 +1,154 @@
+/**************************************************************************************************
+ * 
+ * Copyright 2022 https://github.com/fe-dagostino
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this 
+ * software and associated documentation files (the "Software"), to deal in the Software 
+ * without restriction, including without limitation the rights to use, copy, modify, 
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to 
+ * permit persons to whom the Software is furnished to do so, subject to the following 
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies 
+ * or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE 
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR 
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *************************************************************************************************/
+
+#include "csv_field.h"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <limits>
+#include <string>
+
+using namespace csv;
+
+namespace {
+
+/***/
+csv_data_t data( const std::string& text )
+{ return csv_data_t( text.data(), text.length() ); }
+
+} // namespace
+
+TEST( csv_data_test, to_long_ignore_leading_whitespaces_and_trailing_characters )
+{
+  EXPECT_EQ(  42, data( "42"       ).to_long() );
+  EXPECT_EQ( -42, data( "-42"      ).to_long() );
+  EXPECT_EQ(  42, data( "+42"      ).to_long() );
+  EXPECT_EQ(  42, data( " \t42"    ).to_long() );
+  EXPECT_EQ(  12, data( "12abc"    ).to_long() );
+  EXPECT_EQ(  12, data( "12.7"     ).to_long() );
+  EXPECT_EQ( -42, data( "  -42 "   ).to_long() );
+}
+
+TEST( csv_data_test, to_long_return_zero_on_error )
+{
+  EXPECT_EQ( 0, data( ""                       ).to_long() );
+  EXPECT_EQ( 0, data( "   "                    ).to_long() );
+  EXPECT_EQ( 0, data( "abc"                    ).to_long() );
+  EXPECT_EQ( 0, data( "+"                      ).to_long() );
+  EXPECT_EQ( 0, data( "-"                      ).to_long() );
+  EXPECT_EQ( 0, data( "+-5"                    ).to_long() );
+  EXPECT_EQ( 0, data( "--5"                    ).to_long() );
+  EXPECT_EQ( 0, data( "99999999999999999999"   ).to_long() );
+  EXPECT_EQ( 0, data( "-99999999999999999999"  ).to_long() );
+  EXPECT_EQ( std::numeric_limits<long>::max(), data( std::to_string( std::numeric_limits<long>::max() ) ).to_long() );
+  EXPECT_EQ( std::numeric_limits<long>::min(), data( std::to_string( std::numeric_limits<long>::min() ) ).to_long() );
+}
+
+TEST( csv_data_test, to_ulong_do_not_wrap_negative_numbers )
+{
+  EXPECT_EQ( 42ul, data( "42"   ).to_ulong() );
+  EXPECT_EQ( 42ul, data( "+42"  ).to_ulong() );
+  EXPECT_EQ( 42ul, data( " 42x" ).to_ulong() );
+  EXPECT_EQ( 0ul,  data( "-1"   ).to_ulong() );
+  EXPECT_EQ( 0ul,  data( " -1"  ).to_ulong() );
+  EXPECT_EQ( 0ul,  data( "+-1"  ).to_ulong() );
+  EXPECT_EQ( 0ul,  data( ""     ).to_ulong() );
+  EXPECT_EQ( 0ul,  data( "99999999999999999999999" ).to_ulong() );
+  EXPECT_EQ( std::numeric_limits<unsigned long>::max(), data( std::to_string( std::numeric_limits<unsigned long>::max() ) ).to_ulong() );
+}
+
+TEST( csv_data_test, to_double_accept_decimal_numbers_only )
+{
+  EXPECT_DOUBLE_EQ(  1.5,    data( "1.5"     ).to_double() );
+  EXPECT_DOUBLE_EQ(  1.5,    data( "+1.5"    ).to_double() );
+  EXPECT_DOUBLE_EQ( -0.25,   data( " \t-.25" ).to_double() );
+  EXPECT_DOUBLE_EQ(  1200.0, data( "1.2e3"   ).to_double() );
+  EXPECT_DOUBLE_EQ(  1.5,    data( "1.5kg"   ).to_double() );
+
+  // Hexadecimal input is no longer converted, only the leading zero is.
+  EXPECT_DOUBLE_EQ(  0.0,    data( "0x1A"    ).to_double() );
+  EXPECT_DOUBLE_EQ(  0.0,    data( "0x1p3"   ).to_double() );
+  EXPECT_DOUBLE_EQ(  0.0,    data( ""        ).to_double() );
+  EXPECT_DOUBLE_EQ(  0.0,    data( "+-1.5"   ).to_double() );
+  EXPECT_DOUBLE_EQ(  0.0,    data( "e5"      ).to_double() );
+  EXPECT_DOUBLE_EQ(  0.0,    data( "1e400"   ).to_double() );
+}
+
+TEST( csv_data_test, try_as_require_the_whole_field )
+{
+  int64_t  _long   = 0;
+  uint32_t _uint   = 0;
+  double   _double = 0;
+
+  EXPECT_TRUE ( data( "-42"  ).try_as( _long ) );   EXPECT_EQ( -42, _long );
+  EXPECT_TRUE ( data( "+42"  ).try_as( _long ) );   EXPECT_EQ(  42, _long );
+  EXPECT_TRUE ( data( "7"    ).try_as( _uint ) );   EXPECT_EQ(  7u, _uint );
+  EXPECT_TRUE ( data( "2.5"  ).try_as( _double ) ); EXPECT_DOUBLE_EQ( 2.5, _double );
+  EXPECT_TRUE ( data( "-1e3" ).try_as( _double ) ); EXPECT_DOUBLE_EQ( -1000.0, _double );
+}
+
+TEST( csv_data_test, try_as_do_not_modify_value_on_error )
+{
+  for ( const char* text : { "", " 1", "1 ", "+", "+-5", "12abc", "0x10", "1.5", "99999999999999999999" } )
+  {
+    int64_t _value = 7;
+    EXPECT_FALSE( data( text ).try_as( _value ) ) << "'" << text << "'";
+    EXPECT_EQ( 7, _value ) << "'" << text << "'";
+  }
+
+  for ( const char* text : { "-1", "4294967296", "1.0" } )
+  {
+    uint32_t _value = 7;
+    EXPECT_FALSE( data( text ).try_as( _value ) ) << "'" << text << "'";
+    EXPECT_EQ( 7u, _value ) << "'" << text << "'";
+  }
+
+  for ( const char* text : { "", "0x1A", "1.5.2", "1e400", " 1.5", "inf " } )
+  {
+    double _value = 7;
+    EXPECT_FALSE( data( text ).try_as( _value ) ) << "'" << text << "'";
+    EXPECT_DOUBLE_EQ( 7.0, _value ) << "'" << text << "'";
+  }
+}
+
+TEST( csv_data_test, as_return_default_value_on_error )
+{
+  EXPECT_EQ( 42,  data( "42"   ).as<int>() );
+  EXPECT_EQ( 0,   data( "4x"   ).as<int>() );
+  EXPECT_EQ( -1,  data( "4x"   ).as<int>( -1 ) );
+  EXPECT_EQ( -1,  data( ""     ).as<int>( -1 ) );
+  EXPECT_EQ( 9u,  data( "-1"   ).as<unsigned>( 9 ) );
+  EXPECT_DOUBLE_EQ( 0.5, data( "0x1" ).as<double>( 0.5 ) );
+  EXPECT_DOUBLE_EQ( 3.0, data( "3"   ).as<double>( 0.5 ) );
+}
+
+TEST( csv_data_test, field_match_data )
+{
+  for ( const char* text : { "42", "-42", "+42", " 42", "42 ", "", "+-5", "1.5", "99999999999999999999" } )
+  {
+    const csv_field_t field( data( text ), false );
+    int64_t           _field = 7;
+    int64_t           _data  = 7;
+    EXPECT_EQ( data( text ).try_as( _data ), field.try_as( _field ) ) << "'" << text << "'";
+    EXPECT_EQ( _data, _field ) << "'" << text << "'";
+  }
+}
@@ -0,0 +1,280 @@
+/**************************************************************************************************
+ * 
+ * Copyright 2022 https://github.com/fe-dagostino
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this 
+ * software and associated documentation files (the "Software"), to deal in the Software 
+ * without restriction, including without limitation the rights to use, copy, modify, 
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to 
+ * permit persons to whom the Software is furnished to do so, subject to the following 
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies 
+ * or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE 
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR 
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *************************************************************************************************/
+
+#include "csv_test_utils.h"
+#include "csv_dev_mmap.h"
+#include "csv_dev_compressed.h"
+#ifdef CSV_HAS_IO_URING
+# include "csv_dev_uring.h"
+#endif
+#include <atomic>
+#include <sys/syscall.h>
+
+using namespace csv;
+using namespace csv_test;
+
+namespace {
+
+/**
+ * Reads of more than one block are reported shorter and not aligned while set, 
+ * as it may happen for a read interrupted by a signal.
+ */
+std::atomic<bool>        s_bShortReads{ false };
+std::atomic<std::size_t> s_nShortReads{ 0 };
+
+/***/
+ssize_t short_pread( int fd, void* buf, size_t count, off_t offset )
+{
+  const ssize_t _nRead = syscall( SYS_pread64, fd, buf, count, offset );
+
+  if ( s_bShortReads && (_nRead == static_cast<ssize_t>(count)) && (count > 4096) )
+  {
+    const std::size_t _nShort = ++s_nShortReads;
+    return _nRead - 1 - static_cast<ssize_t>(_nShort % 4000);
+  }
+
+  return _nRead;
+}
+
+} // namespace
+
+/**
+ * pread() used by csv_dev_file for O_DIRECT is replaced in this executable.
+ */
+extern "C" ssize_t pread( int fd, void* buf, size_t count, off_t offset )
+{ return short_pread( fd, buf, count, offset ); }
+/***/
+extern "C" ssize_t pread64( int fd, void* buf, size_t count, off64_t offset )
+{ return short_pread( fd, buf, count, offset ); }
+
+namespace {
+
+/**
+ * Buffer sizes smaller than a row, than a field and than a BOM are all valid.
+ */
+const csv_uint_t s_buffers[] = { 1, 3, 17, 4096 };
+
+/***/
+rows_t read_device( core::unique_ptr<csv_device> ptrDevice )
+{
+  csv_reader reader( "test", std::move(ptrDevice), nullptr );
+  return read_rows( reader );
+}
+
+/***/
+rows_t expected_rows( const std::string& content )
+{
+  temp_file file( "expected.csv", content );
+  return read_device( std::make_unique<csv_dev_file>( file_options( file.path() ), nullptr ) );
+}
+
+} // namespace
+
+TEST( csv_device_test, bom_is_skipped )
+{
+  const std::string content  = random_csv( 2, 50 );
+  const rows_t      expected = expected_rows( content );
+  temp_file         file( "bom.csv", "\xEF\xBB\xBF" + content );
+
+  for ( csv_uint_t nBufferSize : s_buffers )
+  {
+    EXPECT_EQ( expected, read_device( std::make_unique<csv_dev_file>( file_options( file.path(), nBufferSize ), nullptr ) ) ) << "file buffer " << nBufferSize;
+    EXPECT_EQ( expected, read_device( std::make_unique<csv_dev_mmap>( file_options( file.path(), nBufferSize ), nullptr ) ) ) << "mmap buffer " << nBufferSize;
+  }
+}
+
+TEST( csv_device_test, mmap_match_file )
+{
+  const std::string content  = random_csv( 3, 200 );
+  const rows_t      expected = expected_rows( content );
+  temp_file         file( "mmap.csv", content );
+  temp_file         empty( "empty.csv", "" );
+
+  EXPECT_EQ( expected, read_device( std::make_unique<csv_dev_mmap>( file_options( file.path() ), nullptr ) ) );
+  EXPECT_TRUE( read_device( std::make_unique<csv_dev_mmap>( file_options( empty.path() ), nullptr ) ).empty() );
+}
+
+TEST( csv_device_test, file_with_small_buffers )
+{
+  const std::string content  = random_csv( 1, 200 );
+  const rows_t      expected = expected_rows( content );
+  temp_file         file( "file.csv", content );
+
+  ASSERT_FALSE( expected.empty() );
+  for ( csv_uint_t nBufferSize : s_buffers )
+  {
+    for ( csv_uint_t nReadAhead : { 0, 1, 3 } )
+    {
+      EXPECT_EQ( expected, read_device( std::make_unique<csv_dev_file>( file_options( file.path(), nBufferSize, nReadAhead ), nullptr ) ) )
+        << "buffer " << nBufferSize << " read ahead " << nReadAhead;
+    }
+  }
+}
+
+#ifdef CSV_HAS_IO_URING
+TEST( csv_device_test, uring_with_small_buffers )
+{
+  const std::string content  = random_csv( 4, 200 );
+  const rows_t      expected = expected_rows( content );
+  temp_file         file( "uring.csv", content );
+
+  for ( csv_uint_t nBufferSize : s_buffers )
+  {
+    for ( csv_uint_t nReadAhead : { 0, 1, 8 } )
+    {
+      EXPECT_EQ( expected, read_device( std::make_unique<csv_dev_uring>( file_options( file.path(), nBufferSize, nReadAhead ), nullptr ) ) )
+        << "buffer " << nBufferSize << " read ahead " << nReadAhead;
+    }
+  }
+}
+#endif
+
+TEST( csv_device_test, direct_io_with_small_buffers )
+{
+  const std::string content  = random_csv( 7, 200 );
+  const rows_t      expected = expected_rows( content );
+  temp_file         file( "direct.csv", content );
+
+  for ( csv_uint_t nBufferSize : s_buffers )
+  {
+    for ( csv_uint_t nReadAhead : { 0, 2 } )
+    {
+      EXPECT_EQ( expected, read_device( std::make_unique<csv_dev_file>( file_options( file.path(), nBufferSize, nReadAhead, true ), nullptr ) ) )
+        << "file buffer " << nBufferSize << " read ahead " << nReadAhead;
+#ifdef CSV_HAS_IO_URING
+      EXPECT_EQ( expected, read_device( std::make_unique<csv_dev_uring>( file_options( file.path(), nBufferSize, nReadAhead, true ), nullptr ) ) )
+        << "uring buffer " << nBufferSize << " read ahead " << nReadAhead;
+#endif
+    }
+  }
+}
+
+TEST( csv_device_test, direct_io_resume_short_reads )
+{
+  const std::string content  = random_csv( 9, 3000 );
+  const rows_t      expected = expected_rows( content );
+  temp_file         file( "short.csv", content );
+
+  struct short_reads_t {
+    short_reads_t()  { s_nShortReads = 0; s_bShortReads = true; }
+    ~short_reads_t() { s_bShortReads = false; }
+  };
+
+  for ( csv_uint_t nBufferSize : { 8192, 65536 } )
+  {
+    for ( csv_uint_t nReadAhead : { 0, 2 } )
+    {
+      rows_t rows;
+      {
+        short_reads_t _short;
+        rows = read_device( std::make_unique<csv_dev_file>( file_options( file.path(), nBufferSize, nReadAhead, true ), nullptr ) );
+      }
+      EXPECT_GT( s_nShortReads.load(), 0u ) << "buffer " << nBufferSize << " read ahead " << nReadAhead;
+      EXPECT_EQ( expected, rows ) << "buffer " << nBufferSize << " read ahead " << nReadAhead;
+    }
+  }
+}
+
+TEST( csv_device_test, compressed_with_small_buffers )
+{
+  const std::string content  = random_csv( 5, 400 );
+  const rows_t      expected = expected_rows( content );
+  std::vector<std::pair<std::string,std::string>> files = { { "plain", content } };
+
+#ifdef CSV_HAS_ZLIB
+  files.push_back( { "gzip",        gzip( content ) } );
+  files.push_back( { "gzip members", gzip( content.substr( 0, 1000 ) ) + gzip( content.substr( 1000 ) ) } );
+#endif
+#ifdef CSV_HAS_ZSTD
+  files.push_back( { "zstd",          zstd( content ) } );
+#endif
+
+  for ( const auto& [codec, data] : files )
+  {
+    temp_file file( "compressed.csv", data );
+
+    for ( csv_uint_t nBufferSize : s_buffers )
+    {
+      for ( csv_uint_t nReadAhead : { 0, 2 } )
+      {
+        EXPECT_EQ( expected, read_device( std::make_unique<csv_dev_compressed>( file_options( file.path(), nBufferSize, nReadAhead ), nullptr ) ) )
+          << codec << " buffer " << nBufferSize << " read ahead " << nReadAhead;
+      }
+    }
+  }
+}
+
+#ifdef CSV_HAS_ZLIB
+TEST( csv_device_test, truncated_stream_is_an_error )
+{
+  const std::string content = random_csv( 6, 400 );
+  const std::string data    = gzip( content );
+  temp_file         file( "truncated.csv.gz", data.substr( 0, data.size() / 2 ) );
+
+  csv_dev_compressed device( file_options( file.path(), 4096 ), nullptr );
+  ASSERT_EQ( csv_result::_ok, device.open() );
+
+  csv_result  result = csv_result::_ok;
+  std::size_t bytes  = 0;
+  while ( result == csv_result::_ok )
+  {
+    byte       buffer[4096];
+    csv_uint_t length = sizeof(buffer);
+    result = device.recv( buffer, length );
+    bytes += (result == csv_result::_ok)?length:0;
+  }
+
+  EXPECT_EQ( csv_result::_rx_error, result );
+  EXPECT_LT( bytes, content.size() );
+}
+#endif
+
+#if defined(CSV_HAS_ZLIB) || defined(CSV_HAS_ZSTD)
+TEST( csv_device_test, block_compressed_with_small_buffers )
+{
+  const std::string content  = random_csv( 8, 400 );
+  const rows_t      expected = expected_rows( content );
+  std::vector<std::pair<std::string,std::string>> files;
+
+#ifdef CSV_HAS_ZLIB
+  files.push_back( { "bgzf",        bgzf( content, 700 ) } );
+#endif
+#ifdef CSV_HAS_ZSTD
+  files.push_back( { "zstd seekable", zstd_seekable( content, 900 ) } );
+#endif
+
+  for ( const auto& [codec, data] : files )
+  {
+    temp_file file( "compressed.csv", data );
+
+    for ( csv_uint_t nBufferSize : s_buffers )
+    {
+      for ( csv_uint_t nReadAhead : { 0, 2 } )
+      {
+        EXPECT_EQ( expected, read_device( std::make_unique<csv_dev_compressed>( file_options( file.path(), nBufferSize, nReadAhead ), nullptr ) ) )
+          << codec << " buffer " << nBufferSize << " read ahead " << nReadAhead;
+      }
+    }
+  }
+}
+#endif
@@ -0,0 +1,242 @@
+/**************************************************************************************************
+ * 
+ * Copyright 2022 https://github.com/fe-dagostino
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this 
+ * software and associated documentation files (the "Software"), to deal in the Software 
+ * without restriction, including without limitation the rights to use, copy, modify, 
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to 
+ * permit persons to whom the Software is furnished to do so, subject to the following 
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies 
+ * or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE 
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR 
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *************************************************************************************************/
+
+#include "csv_test_utils.h"
+#include "csv_numeric_column.h"
+#include "csv_number.h"
+#include "csv_scanner.h"
+#include <bit>
+
+using namespace csv;
+using namespace csv_test;
+
+namespace {
+
+const csv_scanner::isa_t s_isas[] = { csv_scanner::isa_t::scalar, csv_scanner::isa_t::sse42 };
+
+/**
+ * Restore the default instruction set at the end of each test.
+ */
+class csv_numeric_column_test : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  { m_eIsa = csv_scanner::get_isa(); }
+  void TearDown() override
+  { csv_scanner::set_isa( m_eIsa ); }
+
+  csv_scanner::isa_t  m_eIsa;
+};
+
+/***/
+std::string digits( std::mt19937& rnd, std::size_t count )
+{
+  std::string _digits;
+  for ( std::size_t ndx = 0; ndx < count; ++ndx )
+    _digits += static_cast<char>('0' + rnd() % 10);
+  return _digits;
+}
+
+/**
+ * Random field around the limits of the vectorized conversion: signs, dots, 16 and 17 
+ * digits, mantissas over 2^53, exponents and invalid characters.
+ */
+std::string random_number( std::mt19937& rnd )
+{
+  static const char*        s_signs[]    = { "", "", "", "-", "+", "+-", "--", "-+" };
+  static const char*        s_specials[] = { "", ".", "-", "+", "+.", "-.", "inf", "-nan", " 1", "1 ", "1a", "0x1F", 
+                                             "12.3.4", "-.5", "5.", "-0", "+0.0", "00012", "9007199254740993", 
+                                             "9007199254740992", "900719925474099.3", "1e", "1e+", "e5" };
+  static const std::size_t  s_lengths[]  = { 1, 2, 7, 8, 9, 14, 15, 16, 16, 17, 17, 18, 19, 20 };
+
+  std::string _number;
+  switch ( rnd() % 8 )
+  {
+    case 0:   return s_specials[rnd() % std::size(s_specials)];
+    case 1:
+    case 2:   _number = digits( rnd, s_lengths[rnd() % std::size(s_lengths)] ); break;
+    case 3:
+    case 4:   
+      _number = digits( rnd, s_lengths[rnd() % std::size(s_lengths)] );
+      _number.insert( rnd() % (_number.length() + 1), 1, '.' );
+      break;
+    case 5:
+      // Mantissa over 2^53 with 16 digits.
+      _number = std::to_string( (uint64_t(1) << 53) + rnd() % 900000000000000ull );
+      if ( rnd() % 2 )
+        _number.insert( rnd() % (_number.length() + 1), 1, '.' );
+      break;
+    case 6:
+      _number = digits( rnd, 1 + rnd() % 10 ) + "." + digits( rnd, rnd() % 6 ) + ((rnd() % 2)?"e":"E") + s_signs[rnd() % 5] + digits( rnd, 1 + rnd() % 3 );
+      break;
+    case 7:
+      _number = digits( rnd, 1 + rnd() % 17 );
+      _number[rnd() % _number.length()] = "x. e+-/:"[rnd() % 8];
+      break;
+  }
+
+  return s_signs[rnd() % std::size(s_signs)] + _number;
+}
+
+/**
+ * Expected result for each field, as with try_parse_number().
+ */
+template<typename number_t>
+void check_column( const csv_numeric_column<number_t>& column, const std::vector<std::string>& fields, const std::string& context )
+{
+  std::size_t _nErrors = 0;
+
+  ASSERT_EQ( fields.size(), column.size() ) << context;
+  for ( std::size_t ndx = 0; ndx < fields.size(); ++ndx )
+  {
+    number_t   _expected = 0;
+    const bool _valid    = try_parse_number( fields[ndx].data(), fields[ndx].length(), _expected );
+
+    _nErrors += _valid?0:1;
+    EXPECT_EQ( !_valid, column.error( ndx ) ) << context << " field '" << fields[ndx] << "'";
+    if constexpr ( std::is_same_v<number_t,double> )
+      EXPECT_EQ( std::bit_cast<uint64_t>(_valid?_expected:0.0), std::bit_cast<uint64_t>(column[ndx]) ) << context << " field '" << fields[ndx] << "'";
+    else
+      EXPECT_EQ( _valid?_expected:0, column[ndx] ) << context << " field '" << fields[ndx] << "'";
+  }
+  EXPECT_EQ( _nErrors, column.error_count() ) << context;
+}
+
+} // namespace
+
+TEST_F( csv_numeric_column_test, match_try_parse_number )
+{
+  constexpr std::size_t s_nCapacity = 16 * 1024 * 1024;
+
+  for ( uint32_t seed = 1; seed <= 4; ++seed )
+  {
+    std::mt19937             rnd( seed );
+    std::vector<std::string> fields;
+    csv_column_batch         batch;
+
+    // Buffers are kept by clear(), so that data do not move while the column is filled.
+    const std::string        _reserve( s_nCapacity, 'x' );
+    batch.append( _reserve.data(), _reserve.length(), false );
+    batch.end_row();
+    batch.clear();
+
+    fields.push_back( "" );
+    batch.append( nullptr, 0, false );
+    batch.end_row();
+    const char* pData = batch.get_column( 0 ).data();
+
+    for ( std::size_t row = 0; row < 20000; ++row )
+    {
+      const std::string _number = random_number( rnd );
+
+      // Place the field so that it ends at a page boundary.
+      if ( rnd() % 8 == 0 )
+      {
+        const std::size_t _nEnd    = batch.get_column( 0 ).offsets().back() + _number.length();
+        const std::string _padding( (4096 - (reinterpret_cast<uintptr_t>(pData) + _nEnd) % 4096) % 4096, 'x' );
+
+        fields.push_back( _padding );
+        batch.append( _padding.data(), _padding.length(), false );
+        batch.end_row();
+      }
+
+      fields.push_back( _number );
+      batch.append( _number.data(), _number.length(), false );
+      batch.end_row();
+    }
+    ASSERT_EQ( pData, batch.get_column( 0 ).data() );
+
+    for ( csv_scanner::isa_t isa : s_isas )
+    {
+      if ( csv_scanner::set_isa( isa ) == false )
+        continue;
+
+      const std::string           context = "seed " + std::to_string( seed ) + " isa " + csv_scanner::isa_name( isa );
+      csv_numeric_column<int64_t> integers;
+      csv_numeric_column<double>  doubles;
+
+      integers.parse( batch, 0 );
+      doubles.parse( batch, 0 );
+      check_column( integers, fields, context );
+      check_column( doubles,  fields, context );
+    }
+  }
+}
+
+TEST_F( csv_numeric_column_test, missing_fields_are_errors )
+{
+  temp_file file( "numbers.csv", "a,b\n1,2\n3\n,4\nx,5.5\n-6,+7\n" );
+
+  for ( csv_scanner::isa_t isa : s_isas )
+  {
+    if ( csv_scanner::set_isa( isa ) == false )
+      continue;
+
+    std::vector<csv_row> rows;
+    {
+      csv_reader reader( "test", std::make_unique<csv_dev_file>( file_options( file.path() ), nullptr ), nullptr );
+      csv_row    row;
+      while ( reader.read( row ) )
+        rows.push_back( std::move( row ) );
+    }
+    ASSERT_EQ( 5u, rows.size() );
+
+    csv_row_batch    row_batch;
+    csv_column_batch column_batch;
+    {
+      csv_reader reader( "test", std::make_unique<csv_dev_file>( file_options( file.path() ), nullptr ), nullptr );
+      ASSERT_TRUE( reader.read_batch( row_batch, 100 ) );
+    }
+    {
+      csv_reader reader( "test", std::make_unique<csv_dev_file>( file_options( file.path() ), nullptr ), nullptr );
+      ASSERT_TRUE( reader.read_batch( column_batch, 100 ) );
+    }
+
+    csv_numeric_column<int64_t> column;
+    const std::vector<int64_t>  values = { 2, 0, 4, 0, 7 };
+
+    // Short row "3" has no field for column 1 and "5.5" is not an integer.
+    EXPECT_EQ( 2u, column.parse( row_batch, 1 ) );
+    EXPECT_EQ( values, column.values() );
+    EXPECT_EQ( 2u, column.parse( column_batch, 1 ) );
+    EXPECT_EQ( values, column.values() );
+    EXPECT_EQ( 2u, column.parse( rows, 1 ) );
+    EXPECT_EQ( values, column.values() );
+    EXPECT_EQ( 2u, column.error_count() );
+    for ( std::size_t ndx = 0; ndx < values.size(); ++ndx )
+      EXPECT_EQ( (ndx == 1) || (ndx == 3), column.error( ndx ) ) << "row " << ndx;
+
+    // Column missing in all rows.
+    EXPECT_EQ( 5u, column.parse( rows, 2 ) );
+    EXPECT_EQ( 5u, column.parse( row_batch, 2 ) );
+    EXPECT_EQ( 5u, column.parse( column_batch, 2 ) );
+    EXPECT_EQ( 5u, column.error_count() );
+    EXPECT_EQ( std::vector<int64_t>( 5, 0 ), column.values() );
+    for ( std::size_t ndx = 0; ndx < 5; ++ndx )
+      EXPECT_TRUE( column.error( ndx ) ) << "row " << ndx;
+
+    csv_numeric_column<double> doubles;
+    EXPECT_EQ( 2u, doubles.parse( column_batch, 0 ) );
+    EXPECT_EQ( (std::vector<double>{ 1, 3, 0, 0, -6 }), doubles.values() );
+  }
+}
@@ -0,0 +1,443 @@
+/**************************************************************************************************
+ * 
+ * Copyright 2022 https://github.com/fe-dagostino
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this 
+ * software and associated documentation files (the "Software"), to deal in the Software 
+ * without restriction, including without limitation the rights to use, copy, modify, 
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to 
+ * permit persons to whom the Software is furnished to do so, subject to the following 
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies 
+ * or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE 
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR 
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *************************************************************************************************/
+
+#include "csv_test_utils.h"
+#include "csv_dev_mmap.h"
+#include "csv_parallel_reader.h"
+#include "csv_scanner.h"
+#include "csv_dialect.h"
+#include "csv_dfa.h"
+#include "csv_structural_index.h"
+
+using namespace csv;
+using namespace csv_test;
+
+namespace {
+
+/**
+ * Runtime dialect applied to csv_reader.
+ */
+struct dialect_t
+{
+  char        delimiter;
+  char        quote;
+  bool        allow_comments;
+  bool        skip_whitespaces;
+  bool        trim_all;
+};
+
+const dialect_t s_dialects[] = {
+  { ',', '"',  false, true,  true  },     // default settings, eol is part of whitespaces
+  { ',', '"',  true,  false, false },
+  { ';', '\'', true,  true,  false },
+};
+
+/***/
+void apply( csv_parser& parser, const dialect_t& dialect )
+{
+  parser.set_delimeter   ( dialect.delimiter        );
+  parser.set_quote       ( dialect.quote            );
+  parser.allow_comments  ( dialect.allow_comments   );
+  parser.skip_whitespaces( dialect.skip_whitespaces );
+  parser.trim_all        ( dialect.trim_all         );
+}
+
+/***/
+rows_t read_file( const std::string& filename, const dialect_t& dialect, csv_parser::engine eEngine, csv_uint_t nBufferSize )
+{
+  csv_reader reader( "test", std::make_unique<csv_dev_file>( file_options( filename, nBufferSize ), nullptr ), nullptr );
+  apply( reader, dialect );
+  reader.set_engine( eEngine );
+  return read_rows( reader );
+}
+
+/***/
+rows_t parse( const std::string& content )
+{
+  temp_file file( "parse.csv", content );
+  return read_file( file.path(), s_dialects[0], csv_parser::engine::state_machine, to_bytes<64>::KBytes );
+}
+
+/**
+ * Restore the default instruction set at the end of each test.
+ */
+class csv_parser_test : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  { m_eIsa = csv_scanner::get_isa(); }
+  void TearDown() override
+  { csv_scanner::set_isa( m_eIsa ); }
+
+  csv_scanner::isa_t  m_eIsa;
+};
+
+} // namespace
+
+TEST_F( csv_parser_test, engines_match_state_machine )
+{
+  const csv_scanner::isa_t isas[]    = { csv_scanner::isa_t::scalar, csv_scanner::isa_t::sse42, 
+                                         csv_scanner::isa_t::avx2,   csv_scanner::isa_t::avx512 };
+  const csv_uint_t         buffers[] = { 64, 1000, to_bytes<64>::KBytes };
+
+  for ( uint32_t seed = 1; seed <= 12; ++seed )
+  {
+    for ( const dialect_t& dialect : s_dialects )
+    {
+      temp_file file( "engines.csv", random_csv( seed, 300, dialect.delimiter, dialect.quote ) );
+
+      csv_scanner::set_isa( csv_scanner::isa_t::scalar );
+      const rows_t expected = read_file( file.path(), dialect, csv_parser::engine::state_machine, to_bytes<64>::KBytes );
+      ASSERT_FALSE( expected.empty() );
+
+      for ( csv_scanner::isa_t isa : isas )
+      {
+        if ( csv_scanner::set_isa( isa ) == false )
+          continue;
+
+        for ( csv_uint_t nBufferSize : buffers )
+        {
+          EXPECT_EQ( expected, read_file( file.path(), dialect, csv_parser::engine::state_machine, nBufferSize ) )
+            << "state_machine seed " << seed << " delimiter " << dialect.delimiter << " " << csv_scanner::isa_name( isa ) << " buffer " << nBufferSize;
+          EXPECT_EQ( expected, read_file( file.path(), dialect, csv_parser::engine::structural_index, nBufferSize ) )
+            << "structural_index seed " << seed << " delimiter " << dialect.delimiter << " " << csv_scanner::isa_name( isa ) << " buffer " << nBufferSize;
+        }
+      }
+    }
+  }
+}
+
+TEST_F( csv_parser_test, structural_index_resolve_quotes_with_default_whitespaces )
+{
+  std::string data = "id,name,note\n";
+  for ( std::size_t row = 0; row < 2000; ++row )
+    data += std::to_string( row ) + ", name " + std::to_string( row % 7 ) + "\t,\"quoted, with delimiter\"" + ((row % 3 == 0)?" \t\r\n":"\r\n");
+
+  const csv_scanner::isa_t isas[] = { csv_scanner::isa_t::scalar, csv_scanner::isa_t::sse42, 
+                                      csv_scanner::isa_t::avx2,   csv_scanner::isa_t::avx512 };
+
+  for ( csv_scanner::isa_t isa : isas )
+  {
+    if ( csv_scanner::set_isa( isa ) == false )
+      continue;
+
+    // Same walk done by csv_parser, bulk characters make the field not empty.
+    const csv_dfa         dfa( ',', '"', '\n', '#', false, csv_dialect<>::whitespaces(), true );
+    csv_structural_index  index;
+    index.set_dialect( ',', '"', '\n', std::string(), csv_dialect<>::whitespaces() );
+    index.build( data.data(), data.size() );
+
+    uint8_t      state = csv_dfa::start;
+    std::size_t  rows  = 0;
+    for ( std::size_t pos = 0; ; )
+    {
+      const std::size_t next = index.find( pos, (state == csv_dfa::quoted), (state == csv_dfa::start) );
+      if ( (next != pos) && (state == csv_dfa::start) )
+        state = csv_dfa::data;
+      if ( next == data.size() )
+        break;
+
+      const uint8_t action = dfa.next( state, data[next] );
+      rows += (action & csv_dfa::end_row)?1:0;
+      state = (action & csv_dfa::state_mask);
+      pos   = next + 1;
+    }
+
+    EXPECT_EQ( 2001u, rows ) << "isa " << static_cast<int>(isa);
+    EXPECT_GT( index.fast_blocks(), 0u ) << "isa " << static_cast<int>(isa);
+
+    temp_file file( "fast.csv", data );
+    EXPECT_EQ( read_file( file.path(), s_dialects[0], csv_parser::engine::state_machine,    to_bytes<64>::KBytes ),
+               read_file( file.path(), s_dialects[0], csv_parser::engine::structural_index, to_bytes<64>::KBytes ) ) << "isa " << static_cast<int>(isa);
+  }
+}
+
+TEST_F( csv_parser_test, row_view_match_rows )
+{
+  for ( uint32_t seed = 1; seed <= 6; ++seed )
+  {
+    temp_file    file( "views.csv", random_csv( seed, 500, ',', '"', false ) );
+    const rows_t expected = read_file( file.path(), s_dialects[0], csv_parser::engine::state_machine, to_bytes<64>::KBytes );
+
+    {
+      csv_reader   reader( "test", std::make_unique<csv_dev_file>( file_options( file.path(), 256 ), nullptr ), nullptr );
+      csv_row_view view;
+      rows_t       rows;
+      while ( reader.read( view ) )
+      {
+        csv_row row;
+        view.to_row( row );
+        if ( rows.empty() )
+          rows.push_back( to_row( reader.get_header() ) );
+        rows.push_back( to_row( row ) );
+      }
+      EXPECT_EQ( expected, rows ) << "csv_row_view seed " << seed;
+    }
+  }
+}
+
+TEST_F( csv_parser_test, parallel_reader_match_reader )
+{
+  for ( uint32_t seed = 1; seed <= 4; ++seed )
+  {
+    temp_file    file( "parallel.csv", random_csv( seed, 3000, ',', '"' ) );
+    const rows_t expected = read_file( file.path(), s_dialects[0], csv_parser::engine::state_machine, to_bytes<64>::KBytes );
+
+    for ( std::size_t nThreads : { 1, 3 } )
+    {
+      csv_parallel_reader reader( "test", std::make_unique<csv_dev_mmap>( file_options( file.path() ), nullptr ), nullptr, 
+                                  nThreads, csv_parallel_reader::order_t::ordered, to_bytes<4>::KBytes );
+      ASSERT_TRUE( reader.open() );
+      EXPECT_EQ( expected, read_rows( reader ) ) << "seed " << seed << " threads " << nThreads;
+      reader.close();
+    }
+  }
+}
+
+TEST_F( csv_parser_test, compile_time_dialect_match_runtime )
+{
+  for ( uint32_t seed = 1; seed <= 8; ++seed )
+  {
+    temp_file file( "dialect.csv", random_csv( seed, 300, ';', '\'' ) );
+
+    csv_reader_t<csv_dialect<';','\'','\n','#',true,true,false>> reader( "test", std::make_unique<csv_dev_file>( file_options( file.path(), 100 ), nullptr ), nullptr );
+    EXPECT_EQ( read_file( file.path(), s_dialects[2], csv_parser::engine::state_machine, to_bytes<64>::KBytes ), read_rows( reader ) ) << "seed " << seed;
+  }
+}
+
+TEST_F( csv_parser_test, compile_time_dialect_cannot_be_changed )
+{
+  using dialect_t = csv_dialect<';','\'','\n','#',true,true,false>;
+  temp_file file( "fixed.csv", random_csv( 5, 300, ';', '\'' ) );
+
+  csv_reader_t<dialect_t> reader( "test", std::make_unique<csv_dev_file>( file_options( file.path(), 100 ), nullptr ), nullptr );
+  csv_parser&             parser = reader;
+  parser.set_delimeter( ',' );
+  parser.set_quote( '"' );
+  parser.set_comment( '!' );
+  parser.allow_comments( false );
+  parser.skip_whitespaces( false );
+  parser.trim_all( true );
+  parser.set_whitespaces( " " );
+  parser.set_engine( csv_parser::engine::structural_index );
+
+  EXPECT_EQ( read_file( file.path(), s_dialects[2], csv_parser::engine::state_machine, to_bytes<64>::KBytes ), read_rows( reader ) );
+  EXPECT_EQ( ';',  parser.get_delimeter() );
+  EXPECT_EQ( '\'', parser.get_quote() );
+  EXPECT_EQ( '#',  parser.get_comment() );
+  EXPECT_TRUE( parser.allow_comments() );
+  EXPECT_TRUE( parser.skip_whitespaces() );
+  EXPECT_FALSE( parser.trim_all() );
+  EXPECT_EQ( dialect_t::whitespaces(), parser.get_whitespaces() );
+}
+
+TEST_F( csv_parser_test, rfc4180_rows )
+{
+  EXPECT_EQ( parse( "h1,h2\n\"x,y\",\"a\"\"b\"\n" ), 
+             (rows_t{ { {false,"h1"}, {false,"h2"} }, { {true,"x,y"}, {true,"a\"\"b"} } }) );
+  EXPECT_EQ( parse( "h1,h2\r\na,b\r\n" ), 
+             (rows_t{ { {false,"h1"}, {false,"h2"} }, { {false,"a"}, {false,"b"} } }) );
+  EXPECT_EQ( parse( "h1,h2,h3\n  a b ,\tc\t, \" q \"\n" ), 
+             (rows_t{ { {false,"h1"}, {false,"h2"}, {false,"h3"} }, { {false,"a b"}, {false,"c"}, {true," q "} } }) );
+  EXPECT_EQ( parse( "h1,h2,h3\n,,\n\n1\n" ), 
+             (rows_t{ { {false,"h1"}, {false,"h2"}, {false,"h3"} }, { {false,""}, {false,""}, {false,""} }, 
+                      { {false,""} }, { {false,"1"} } }) );
+  EXPECT_EQ( parse( "h1,h2\nab\"c,\"x\"y\n" ), 
+             (rows_t{ { {false,"h1"}, {false,"h2"} }, { {false,"ab\"c"}, {false,"\"x\"y"} } }) );
+}
+
+TEST_F( csv_parser_test, row_batch_match_rows )
+{
+  for ( uint32_t seed = 1; seed <= 6; ++seed )
+  {
+    temp_file    file( "views.csv", random_csv( seed, 500, ',', '"', false ) );
+    const rows_t expected = read_file( file.path(), s_dialects[0], csv_parser::engine::state_machine, to_bytes<64>::KBytes );
+
+    {
+      csv_reader    reader( "test", std::make_unique<csv_dev_file>( file_options( file.path(), 256 ), nullptr ), nullptr );
+      csv_row_batch batch;
+      rows_t        rows;
+      while ( reader.read_batch( batch, 7 ) )
+      {
+        if ( rows.empty() )
+          rows.push_back( to_row( reader.get_header() ) );
+        for ( const csv_row& row : batch )
+          rows.push_back( to_row( row ) );
+      }
+      EXPECT_EQ( expected, rows ) << "csv_row_batch seed " << seed;
+    }
+  }
+}
+
+TEST_F( csv_parser_test, column_batch_match_rows )
+{
+  for ( uint32_t seed = 1; seed <= 6; ++seed )
+  {
+    temp_file    file( "views.csv", random_csv( seed, 500, ',', '"', false ) );
+    const rows_t expected = read_file( file.path(), s_dialects[0], csv_parser::engine::state_machine, to_bytes<64>::KBytes );
+
+    {
+      csv_reader       reader( "test", std::make_unique<csv_dev_file>( file_options( file.path(), 256 ), nullptr ), nullptr );
+      csv_column_batch batch;
+      rows_t           rows;
+      rows_t           padded;
+      while ( reader.read_batch( batch, 7 ) )
+      {
+        if ( rows.empty() )
+        {
+          rows.push_back( to_row( reader.get_header() ) );
+          padded.push_back( expected.front() );
+        }
+        for ( std::size_t ndx = 0; ndx < batch.size(); ++ndx )
+        {
+          row_t row;
+          for ( std::size_t col = 0; col < batch.columns(); ++col )
+            row.push_back( { batch.get_column( col ).hasquotes( ndx ), std::string( batch.get( ndx, col ) ) } );
+          rows.push_back( row );
+
+          // Rows shorter than the largest one in the batch are completed with empty fields.
+          row_t expected_row = (padded.size() < expected.size())?expected[padded.size()]:row_t();
+          expected_row.resize( std::max( expected_row.size(), batch.columns() ), field_t( false, "" ) );
+          padded.push_back( expected_row );
+        }
+      }
+      EXPECT_EQ( expected.size(), rows.size() ) << "csv_column_batch seed " << seed;
+      EXPECT_EQ( padded, rows ) << "csv_column_batch seed " << seed;
+    }
+  }
+}
+
+TEST_F( csv_parser_test, column_batch_clear_drops_columns )
+{
+  temp_file        file( "columns.csv", "h1,h2,h3\n1,2,3\n4\n5,6\n" );
+  csv_reader       reader( "test", std::make_unique<csv_dev_file>( file_options( file.path() ), nullptr ), nullptr );
+  csv_column_batch batch;
+
+  // Columns are the largest row of each batch, not of all batches read so far.
+  const std::vector<std::vector<std::string>> expected = { { "1", "2", "3" }, { "4" }, { "5", "6" } };
+  for ( const auto& row : expected )
+  {
+    ASSERT_TRUE( reader.read_batch( batch, 1 ) );
+    ASSERT_EQ( 1u, batch.size() );
+    ASSERT_EQ( row.size(), batch.columns() );
+    for ( std::size_t col = 0; col < row.size(); ++col )
+    {
+      EXPECT_EQ( row[col], batch.get( 0, col ) );
+      EXPECT_EQ( 1u, batch.get_column( col ).size() );
+    }
+  }
+  EXPECT_FALSE( reader.read_batch( batch, 1 ) );
+  EXPECT_EQ( 0u, batch.columns() );
+}
+
+TEST_F( csv_parser_test, projection_keep_selected_fields )
+{
+  const std::vector<std::string> labels = { "h0", "h2", "h5", "unknown" };
+
+  for ( csv_parser::engine eEngine : { csv_parser::engine::state_machine, csv_parser::engine::structural_index } )
+  {
+    for ( uint32_t seed = 1; seed <= 8; ++seed )
+    {
+      for ( const dialect_t& dialect : s_dialects )
+      {
+        temp_file    file( "projection.csv", random_csv( seed, 500, dialect.delimiter, dialect.quote ) );
+        const rows_t expected = read_file( file.path(), dialect, csv_parser::engine::state_machine, to_bytes<64>::KBytes );
+
+        csv_reader reader( "test", std::make_unique<csv_dev_file>( file_options( file.path(), 256 ), nullptr ), nullptr );
+        apply( reader, dialect );
+        reader.set_engine( eEngine );
+        reader.set_projection( labels );
+        const rows_t rows = read_rows( reader );
+
+        ASSERT_EQ( expected.size(), rows.size() ) << "seed " << seed;
+        ASSERT_FALSE( rows.empty() );
+        EXPECT_EQ( expected.front(), rows.front() ) << "header, seed " << seed;
+
+        const row_t& header = expected.front();
+        for ( std::size_t ndx = 1; ndx < rows.size(); ++ndx )
+        {
+          // Rows keep their width, so that indexes from the header remain valid.
+          ASSERT_EQ( expected[ndx].size(), rows[ndx].size() ) << "seed " << seed << " row " << ndx;
+          for ( std::size_t col = 0; col < rows[ndx].size(); ++col )
+          {
+            const bool selected = (col < header.size()) && (std::find( labels.begin(), labels.end(), header[col].second ) != labels.end());
+            if ( selected )
+              EXPECT_EQ( expected[ndx][col], rows[ndx][col] ) << "seed " << seed << " row " << ndx << " col " << col;
+            else
+              EXPECT_EQ( field_t( false, "" ), rows[ndx][col] ) << "seed " << seed << " row " << ndx << " col " << col;
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST_F( csv_parser_test, predicates_on_missing_fields )
+{
+  /**
+   * Collect errors reported by the reader.
+   */
+  class error_events : public csv_events
+  {
+  public:
+    explicit error_events( std::vector<csv_result>& errors ) : m_errors( errors ) {}
+
+    void                    onBegin       () override {}
+    void                    onHeader      ( const csv_header& ) override {}
+    csv_unique_ptr<csv_row> onRow         ( const csv_header&, csv_unique_ptr<csv_row> row ) override { return row; }
+    csv_unique_ptr<csv_row> onFilteredRow ( const csv_header&, csv_unique_ptr<csv_row> row ) override { return row; }
+    void                    onEnd         () override {}
+    void                    onError       ( csv_result eCode ) override { m_errors.push_back( eCode ); }
+    bool                    onAppendField ( const csv_header&, const csv_field_t&, const csv_field_t& ) override { return true; }
+
+  private:
+    std::vector<csv_result>& m_errors;
+  };
+
+  temp_file file( "predicates.csv", "h0,h1,h2\na,1,x\nb,2\nc\nd,3,\ne,4,y\n" );
+
+  auto first_fields = [&]( const csv_predicate& predicate, std::vector<csv_result>& errors ) {
+    csv_reader reader( "test", std::make_unique<csv_dev_file>( file_options( file.path() ), nullptr ), 
+                       std::make_unique<error_events>( errors ) );
+    reader.add_predicate( predicate );
+
+    std::string    first;
+    csv_row_view   row;
+    while ( reader.read( row ) )
+      first += std::string( row[0].data() );
+    return first;
+  };
+
+  std::vector<csv_result> errors;
+  EXPECT_EQ( "a",    first_fields( csv_predicate::equal( "h2", "x" ), errors ) );
+  EXPECT_EQ( "bcd",  first_fields( csv_predicate::equal( "h2", "" ), errors ) );
+  EXPECT_EQ( "abde", first_fields( csv_predicate::range( "h1", 0, 10 ), errors ) );
+  EXPECT_EQ( "c",    first_fields( csv_predicate::in( "h1", { "", "9" } ), errors ) );
+  EXPECT_TRUE( std::find( errors.begin(), errors.end(), csv_result::_unknown_label ) == errors.end() );
+
+  // Labels not present in the header are missing in all rows.
+  EXPECT_EQ( "",      first_fields( csv_predicate::equal( "h3", "x" ), errors ) );
+  EXPECT_EQ( 1, std::count( errors.begin(), errors.end(), csv_result::_unknown_label ) );
+  EXPECT_EQ( "abcde", first_fields( csv_predicate::equal( "h3", "" ), errors ) );
+  EXPECT_EQ( 2, std::count( errors.begin(), errors.end(), csv_result::_unknown_label ) );
+}
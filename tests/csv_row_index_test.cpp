@@ -0,0 +1,257 @@
+/**************************************************************************************************
+ * 
+ * Copyright 2022 https://github.com/fe-dagostino
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this 
+ * software and associated documentation files (the "Software"), to deal in the Software 
+ * without restriction, including without limitation the rights to use, copy, modify, 
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to 
+ * permit persons to whom the Software is furnished to do so, subject to the following 
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies 
+ * or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE 
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR 
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *************************************************************************************************/
+
+#include "csv_test_utils.h"
+#include "csv_row_index.h"
+#include "csv_dev_mmap.h"
+#include "csv_dev_compressed.h"
+
+using namespace csv;
+using namespace csv_test;
+
+namespace {
+
+/**
+ * Data set where the first field is the row number.
+ */
+std::string numbered_csv( std::size_t rows )
+{
+  std::mt19937 rnd( 7 );
+  std::string  data = "row,name,note\n";
+
+  for ( std::size_t row = 0; row < rows; ++row )
+    data += std::to_string(row) + ",item " + std::to_string(rnd() % 1000) + ((rnd() % 4)?",plain\n":",\"quoted, with delimiter\"\n");
+
+  return data;
+}
+
+/**
+ * Build the index reading all rows.
+ */
+void build_index( core::unique_ptr<csv_device> ptrDevice, csv_row_index& index )
+{
+  csv_reader   reader( "test", std::move(ptrDevice), nullptr );
+  csv_row_view row;
+
+  reader.set_row_index( &index );
+  while ( reader.read( row ) )
+  {}
+  reader.close();
+}
+
+/**
+ * Check that seek_row() reach each row in @param targets.
+ */
+void check_seek( core::unique_ptr<csv_device> ptrDevice, csv_row_index& index, const std::vector<std::size_t>& targets )
+{
+  csv_reader   reader( "test", std::move(ptrDevice), nullptr );
+  csv_row_view row;
+
+  reader.set_row_index( &index );
+  ASSERT_TRUE( reader.open() );
+  for ( std::size_t target : targets )
+  {
+    ASSERT_TRUE( reader.seek_row( target ) ) << "row " << target;
+    ASSERT_TRUE( reader.read( row ) ) << "row " << target;
+    EXPECT_EQ( target, row[0].as<std::size_t>() );
+  }
+  EXPECT_FALSE( reader.seek_row( index.rows() + 1 ) );
+  reader.close();
+}
+
+/**
+ * Read or replace the whole content of @param filename.
+ */
+std::string read_binary( const std::string& filename )
+{
+  std::ifstream in( filename, std::ios::binary );
+  return std::string( std::istreambuf_iterator<char>( in ), std::istreambuf_iterator<char>() );
+}
+
+/***/
+void write_binary( const std::string& filename, const std::string& content )
+{
+  std::ofstream out( filename, std::ios::binary | std::ios::trunc );
+  out.write( content.data(), static_cast<std::streamsize>(content.size()) );
+}
+
+/***/
+std::vector<std::size_t> random_rows( std::size_t rows, std::size_t count )
+{
+  std::mt19937             rnd( 3 );
+  std::vector<std::size_t> targets = { 0, rows - 1 };
+  while ( targets.size() < count )
+    targets.push_back( rnd() % rows );
+  return targets;
+}
+
+} // namespace
+
+TEST( csv_row_index_test, record_and_find )
+{
+  csv_row_index index( 4 );
+  for ( std::size_t row = 0; row < 10; ++row )
+    index.record( row, static_cast<csv_uint_t>(row * 10) );
+  // Rows already indexed or after a gap are ignored.
+  index.record( 3, 1000 );
+  index.record( 12, 1000 );
+
+  std::size_t indexed_row = 0;
+  csv_uint_t  offset      = 0;
+
+  EXPECT_EQ( 10u, index.rows() );
+  EXPECT_EQ( (std::vector<csv_uint_t>{ 0, 40, 80 }), index.offsets() );
+  ASSERT_TRUE( index.find( 6, indexed_row, offset ) );
+  EXPECT_EQ( 4u, indexed_row );
+  EXPECT_EQ( 40u, offset );
+  ASSERT_TRUE( index.find( 100, indexed_row, offset ) );
+  EXPECT_EQ( 8u, indexed_row );
+  EXPECT_EQ( 80u, offset );
+}
+
+TEST( csv_row_index_test, seek_row_with_built_index )
+{
+  const std::size_t rows = 5000;
+  temp_file         file( "seek.csv", numbered_csv( rows ) );
+
+  for ( std::size_t nStep : { 1, 64 } )
+  {
+    csv_row_index index( nStep );
+    build_index( std::make_unique<csv_dev_file>( file_options( file.path() ), nullptr ), index );
+    ASSERT_EQ( rows, index.rows() );
+
+    check_seek( std::make_unique<csv_dev_file>( file_options( file.path(), 100 ), nullptr ), index, random_rows( rows, 100 ) );
+    check_seek( std::make_unique<csv_dev_mmap>( file_options( file.path() ), nullptr ), index, random_rows( rows, 100 ) );
+  }
+}
+
+TEST( csv_row_index_test, save_and_load )
+{
+  const std::size_t rows = 3000;
+  temp_file         file( "sidecar.csv", "\xEF\xBB\xBF" + numbered_csv( rows ) );
+  const std::string sidecar = csv_row_index::sidecar_name( file.path() );
+
+  csv_row_index built( 16 );
+  build_index( std::make_unique<csv_dev_file>( file_options( file.path() ), nullptr ), built );
+  ASSERT_EQ( csv_result::_ok, built.save( sidecar, file.path() ) );
+
+  csv_row_index loaded;
+  ASSERT_EQ( csv_result::_ok, loaded.load( sidecar, file.path() ) );
+  EXPECT_EQ( built.step(),    loaded.step()    );
+  EXPECT_EQ( built.rows(),    loaded.rows()    );
+  EXPECT_EQ( built.offsets(), loaded.offsets() );
+
+  check_seek( std::make_unique<csv_dev_file>( file_options( file.path() ), nullptr ), loaded, random_rows( rows, 100 ) );
+}
+
+TEST( csv_row_index_test, load_rejects_other_files )
+{
+  temp_file         file( "stale.csv", numbered_csv( 100 ) );
+  temp_file         other( "other.csv", numbered_csv( 200 ) );
+  const std::string sidecar = csv_row_index::sidecar_name( file.path() );
+
+  csv_row_index built;
+  build_index( std::make_unique<csv_dev_file>( file_options( file.path() ), nullptr ), built );
+  ASSERT_EQ( csv_result::_ok, built.save( sidecar, file.path() ) );
+
+  csv_row_index index( 5 );
+  EXPECT_EQ( csv_result::_cfg_error, index.load( sidecar, other.path() ) );
+  EXPECT_EQ( csv_result::_cfg_error, index.load( other.path(), file.path() ) );
+  EXPECT_EQ( csv_result::_access,    index.load( sidecar + ".missing", file.path() ) );
+  EXPECT_EQ( csv_result::_access,    index.load( sidecar, file.path() + ".missing" ) );
+  // Index is not modified on failure.
+  EXPECT_EQ( 5u, index.step() );
+  EXPECT_TRUE( index.empty() );
+
+  // Data file modified after the index has been saved.
+  ASSERT_TRUE( file.write( numbered_csv( 101 ) ) );
+  EXPECT_EQ( csv_result::_cfg_error, index.load( sidecar, file.path() ) );
+}
+
+TEST( csv_row_index_test, load_rejects_corrupt_index )
+{
+  temp_file         file( "corrupt.csv", numbered_csv( 500 ) );
+  const std::string sidecar = csv_row_index::sidecar_name( file.path() );
+
+  csv_row_index built( 4 );
+  build_index( std::make_unique<csv_dev_file>( file_options( file.path() ), nullptr ), built );
+  ASSERT_EQ( csv_result::_ok, built.save( sidecar, file.path() ) );
+  const std::string saved = read_binary( sidecar );
+
+  // Header is 56 bytes, with rows and count as the last two 64 bits fields.
+  std::string huge = saved;
+  for ( std::size_t offset : { 40, 48 } )
+  {
+    huge.replace( offset, 8, std::string( 8, '\0' ) );
+    huge[offset + 7] = 0x20;
+  }
+  write_binary( sidecar, huge );
+
+  csv_row_index index;
+  EXPECT_EQ( csv_result::_cfg_error, index.load( sidecar, file.path() ) );
+
+  write_binary( sidecar, saved.substr( 0, saved.size() - 10 ) );
+  EXPECT_EQ( csv_result::_cfg_error, index.load( sidecar, file.path() ) );
+
+  write_binary( sidecar, saved.substr( 0, 30 ) );
+  EXPECT_EQ( csv_result::_cfg_error, index.load( sidecar, file.path() ) );
+  EXPECT_TRUE( index.empty() );
+
+  write_binary( sidecar, saved );
+  EXPECT_EQ( csv_result::_ok, index.load( sidecar, file.path() ) );
+  EXPECT_EQ( built.offsets(), index.offsets() );
+}
+
+#if defined(CSV_HAS_ZLIB) || defined(CSV_HAS_ZSTD)
+TEST( csv_row_index_test, save_and_load_compressed )
+{
+  const std::size_t        rows = 3000;
+  const std::string        data = numbered_csv( rows );
+  std::vector<std::string> files;
+#ifdef CSV_HAS_ZLIB
+  files.push_back( bgzf( data, 700 ) );
+#endif
+#ifdef CSV_HAS_ZSTD
+  files.push_back( zstd_seekable( data, 900 ) );
+#endif
+
+  for ( const std::string& content : files )
+  {
+    // Compressed file is smaller than offsets stored in the index.
+    temp_file         file( "compressed.csv", content );
+    const std::string sidecar = csv_row_index::sidecar_name( file.path() );
+    ASSERT_LT( content.size(), data.size() );
+
+    csv_row_index built( 16 );
+    build_index( std::make_unique<csv_dev_compressed>( file_options( file.path() ), nullptr ), built );
+    ASSERT_EQ( rows, built.rows() );
+    ASSERT_EQ( csv_result::_ok, built.save( sidecar, file.path() ) );
+
+    csv_row_index loaded;
+    ASSERT_EQ( csv_result::_ok, loaded.load( sidecar, file.path() ) );
+    EXPECT_EQ( built.offsets(), loaded.offsets() );
+
+    check_seek( std::make_unique<csv_dev_compressed>( file_options( file.path(), 4096, 2 ), nullptr ), loaded, random_rows( rows, 50 ) );
+  }
+}
+#endif
@@ -0,0 +1,140 @@
+/**************************************************************************************************
+ * 
+ * Copyright 2022 https://github.com/fe-dagostino
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this 
+ * software and associated documentation files (the "Software"), to deal in the Software 
+ * without restriction, including without limitation the rights to use, copy, modify, 
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to 
+ * permit persons to whom the Software is furnished to do so, subject to the following 
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies 
+ * or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE 
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR 
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *************************************************************************************************/
+
+#include "csv_scanner.h"
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace csv;
+
+namespace {
+
+const csv_scanner::isa_t s_isas[] = { csv_scanner::isa_t::scalar, csv_scanner::isa_t::sse42, 
+                                      csv_scanner::isa_t::avx2,   csv_scanner::isa_t::avx512 };
+
+/**
+ * Restore the default instruction set at the end of each test.
+ */
+class csv_scanner_test : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  { m_eIsa = csv_scanner::get_isa(); }
+  void TearDown() override
+  { csv_scanner::set_isa( m_eIsa ); }
+
+  csv_scanner::isa_t  m_eIsa;
+};
+
+/***/
+const char* reference_find( const std::string& set, const char* pFirst, const char* pLast )
+{
+  for ( ; pFirst != pLast; ++pFirst )
+    if ( set.find( *pFirst ) != std::string::npos )
+      return pFirst;
+  return pLast;
+}
+
+} // namespace
+
+TEST_F( csv_scanner_test, find_match_scalar_search )
+{
+  const std::string sets[] = { ",", ",\"\n", ",\"\n#", ",\"\n\a\b\t\v\f\r", ";'\n# \t", std::string("\0\xff,",3) };
+  std::mt19937      rnd( 1 );
+
+  for ( csv_scanner::isa_t isa : s_isas )
+  {
+    if ( csv_scanner::set_isa( isa ) == false )
+      continue;
+
+    for ( const std::string& set : sets )
+    {
+      csv_scanner scanner;
+      scanner.insert( set );
+
+      for ( int round = 0; round < 200; ++round )
+      {
+        // Sparse and dense matches, at any alignment and with any length.
+        std::string data( rnd() % 300, 'a' );
+        for ( char& ch : data )
+          ch = (rnd() % (1 + round % 64) == 0)?set[rnd() % set.size()]:static_cast<char>(rnd() % 256);
+
+        for ( std::size_t first = 0; first < std::min<std::size_t>( data.size(), 70 ); first += 7 )
+        {
+          const char* pFirst = data.data() + first;
+          const char* pLast  = data.data() + data.size();
+          ASSERT_EQ( reference_find( set, pFirst, pLast ), scanner.find( pFirst, pLast ) ) 
+            << csv_scanner::isa_name( isa ) << " round " << round << " first " << first;
+        }
+      }
+    }
+  }
+}
+
+TEST_F( csv_scanner_test, mask_match_contains )
+{
+  std::mt19937 rnd( 2 );
+
+  for ( csv_scanner::isa_t isa : s_isas )
+  {
+    if ( csv_scanner::set_isa( isa ) == false )
+      continue;
+
+    csv_scanner scanner;
+    scanner.insert( ",\"\n\r\t" );
+
+    for ( int round = 0; round < 200; ++round )
+    {
+      char block[64];
+      for ( char& ch : block )
+        ch = (rnd() % 4 == 0)?",\"\n\r\t"[rnd() % 5]:static_cast<char>(rnd() % 256);
+
+      uint64_t expected = 0;
+      for ( int ndx = 0; ndx < 64; ++ndx )
+        expected |= scanner.contains( block[ndx] )?(uint64_t(1) << ndx):0;
+
+      ASSERT_EQ( expected, scanner.mask( block ) ) << csv_scanner::isa_name( isa );
+    }
+  }
+}
+
+TEST_F( csv_scanner_test, clear_and_insert )
+{
+  csv_scanner scanner;
+  const std::string data = "abc,def\"ghi";
+
+  scanner.insert( ',' );
+  EXPECT_TRUE ( scanner.contains( ',' ) );
+  EXPECT_FALSE( scanner.contains( '"' ) );
+  EXPECT_EQ( data.data() + 3, scanner.find( data.data(), data.data() + data.size() ) );
+
+  scanner.clear();
+  scanner.insert( '"' );
+  EXPECT_FALSE( scanner.contains( ',' ) );
+  EXPECT_EQ( data.data() + 7, scanner.find( data.data(), data.data() + data.size() ) );
+
+  scanner.clear();
+  EXPECT_EQ( data.data() + data.size(), scanner.find( data.data(), data.data() + data.size() ) );
+}
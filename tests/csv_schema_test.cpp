@@ -0,0 +1,211 @@
+/**************************************************************************************************
+ * 
+ * Copyright 2022 https://github.com/fe-dagostino
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this 
+ * software and associated documentation files (the "Software"), to deal in the Software 
+ * without restriction, including without limitation the rights to use, copy, modify, 
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to 
+ * permit persons to whom the Software is furnished to do so, subject to the following 
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies 
+ * or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE 
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR 
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *************************************************************************************************/
+
+#include "csv_test_utils.h"
+#include "csv_schema.h"
+#include "csv_number.h"
+#include <cstring>
+
+using namespace csv;
+using namespace csv_test;
+
+namespace {
+
+using type_t = csv_schema::type_t;
+
+/**
+ * Infer the schema of @param content from all its rows.
+ */
+csv_schema infer( const std::string& content, std::size_t nMaxDictionary = 256 )
+{
+  temp_file            file( "schema.csv", content );
+  csv_reader           reader( "test", std::make_unique<csv_dev_file>( file_options( file.path() ), nullptr ), nullptr );
+  std::vector<csv_row> rows;
+  csv_row              row;
+
+  while ( reader.read( row ) )
+    rows.push_back( std::move( row ) );
+
+  return csv_schema::infer( reader.get_header(), rows, nMaxDictionary );
+}
+
+/***/
+std::vector<type_t> types( const csv_schema& schema )
+{
+  std::vector<type_t> _types;
+  for ( const auto& column : schema.columns() )
+    _types.push_back( column.type );
+  return _types;
+}
+
+} // namespace
+
+TEST( csv_schema_test, try_parse_bool )
+{
+  for ( const char* text : { "true", "TRUE", "True", "tRuE", "1" } )
+  {
+    bool _value = false;
+    EXPECT_TRUE( try_parse_bool( text, std::strlen( text ), _value ) ) << text;
+    EXPECT_TRUE( _value ) << text;
+  }
+
+  for ( const char* text : { "false", "FALSE", "False", "0" } )
+  {
+    bool _value = true;
+    EXPECT_TRUE( try_parse_bool( text, std::strlen( text ), _value ) ) << text;
+    EXPECT_FALSE( _value ) << text;
+  }
+
+  for ( const char* text : { "", "t", "yes", "2", "01", "-1", " true", "true ", "truee", "fals", "TRUE\x01" } )
+  {
+    bool _value = true;
+    EXPECT_FALSE( try_parse_bool( text, std::strlen( text ), _value ) ) << text;
+    EXPECT_TRUE( _value ) << text;
+  }
+}
+
+TEST( csv_schema_test, classify )
+{
+  EXPECT_EQ( type_t::integer,   csv_schema::classify( "42" ) );
+  EXPECT_EQ( type_t::integer,   csv_schema::classify( "-7" ) );
+  EXPECT_EQ( type_t::integer,   csv_schema::classify( "1" ) );
+  EXPECT_EQ( type_t::floating,  csv_schema::classify( "2.5" ) );
+  EXPECT_EQ( type_t::floating,  csv_schema::classify( "-1e3" ) );
+  EXPECT_EQ( type_t::floating,  csv_schema::classify( "99999999999999999999" ) );
+  EXPECT_EQ( type_t::boolean,   csv_schema::classify( "true" ) );
+  EXPECT_EQ( type_t::boolean,   csv_schema::classify( "FALSE" ) );
+  EXPECT_EQ( type_t::timestamp, csv_schema::classify( "2024-02-29" ) );
+  EXPECT_EQ( type_t::timestamp, csv_schema::classify( "2024-02-29T23:59:60.125Z" ) );
+  EXPECT_EQ( type_t::timestamp, csv_schema::classify( "2024-02-29 10:20+01:00" ) );
+  EXPECT_EQ( type_t::timestamp, csv_schema::classify( "2024-02-29T10:20:30-0500" ) );
+  EXPECT_EQ( type_t::string,    csv_schema::classify( "2024-13-01" ) );
+  EXPECT_EQ( type_t::string,    csv_schema::classify( "2024-01-01T24:00" ) );
+  EXPECT_EQ( type_t::string,    csv_schema::classify( "2024-01-01T10:20:30." ) );
+  EXPECT_EQ( type_t::string,    csv_schema::classify( "yes" ) );
+  EXPECT_EQ( type_t::string,    csv_schema::classify( "0x10" ) );
+  EXPECT_EQ( type_t::string,    csv_schema::classify( "1 " ) );
+}
+
+TEST( csv_schema_test, types_are_widened )
+{
+  const csv_schema schema = infer( "int,float,mixed,bool,bits,bool_bits,date,date_int,num_bool\n"
+                                   "1,2,1,true,1,true,2024-01-01,2024-01-01,1.5\n"
+                                   "2,2.5,x,False,0,0,2024-01-02T10:00,3,true\n"
+                                   "-3,-1e3,2.5,TRUE,1,1,2024-01-03,4,0\n" );
+
+  EXPECT_EQ( (std::vector<type_t>{ type_t::integer, type_t::floating, type_t::string, type_t::boolean, type_t::integer, 
+                                   type_t::boolean, type_t::timestamp, type_t::string, type_t::string }), types( schema ) );
+  for ( const auto& column : schema.columns() )
+    EXPECT_FALSE( column.nullable ) << column.label;
+
+  ASSERT_EQ( 9u, schema.size() );
+  EXPECT_EQ( "int", schema[0].label );
+  EXPECT_EQ( 8, schema.find( "num_bool" ) );
+  EXPECT_EQ( -1, schema.find( "unknown" ) );
+}
+
+TEST( csv_schema_test, nullable_columns )
+{
+  const csv_schema schema = infer( "a,b,c,d\n"
+                                   "1,,x,\n"
+                                   "2,2.5,,\n"
+                                   "3,4,y,\n"
+                                   "1,2\n"
+                                   "4,5,z,,extra\n" );
+
+  // Rows with a different number of fields are not considered.
+  EXPECT_EQ( (std::vector<type_t>{ type_t::integer, type_t::floating, type_t::string, type_t::string }), types( schema ) );
+  EXPECT_FALSE( schema[0].nullable );
+  EXPECT_TRUE ( schema[1].nullable );
+  EXPECT_TRUE ( schema[2].nullable );
+  EXPECT_TRUE ( schema[3].nullable );
+}
+
+TEST( csv_schema_test, dictionary_columns )
+{
+  std::string content = "color,name,few\n";
+  for ( std::size_t row = 0; row < 60; ++row )
+    content += std::string( (row % 3 == 0)?"red":(row % 3 == 1)?"green":"blue" ) + ",name" + std::to_string( row ) + "," + ((row < 2)?"a":"b") + "\n";
+
+  EXPECT_EQ( (std::vector<type_t>{ type_t::dictionary, type_t::string, type_t::dictionary }), types( infer( content ) ) );
+  // More distinct values than allowed.
+  EXPECT_EQ( (std::vector<type_t>{ type_t::string, type_t::string, type_t::dictionary }), types( infer( content, 2 ) ) );
+  // Each value is not repeated on average.
+  EXPECT_EQ( (std::vector<type_t>{ type_t::string }), types( infer( "color\nred\ngreen\nblue\nred\n" ) ) );
+}
+
+TEST( csv_schema_test, declared_schema_resolve_header )
+{
+  csv_schema schema{ { "price", type_t::floating, false }, { "qty", type_t::integer, false } };
+  schema.add( "when", type_t::timestamp );
+  schema.add( "qty", type_t::floating, true );
+
+  ASSERT_EQ( 3u, schema.size() );
+  EXPECT_EQ( type_t::floating, schema[1].type );
+  EXPECT_TRUE( schema[1].nullable );
+
+  temp_file  file( "declared.csv", "symbol,qty,price,when\nx,1,2,2024-01-01\n" );
+  csv_reader reader( "test", std::make_unique<csv_dev_file>( file_options( file.path() ), nullptr ), nullptr );
+  csv_row    row;
+  ASSERT_TRUE( reader.read( row ) );
+  EXPECT_EQ( (std::vector<type_t>{ type_t::string, type_t::floating, type_t::floating, type_t::timestamp }), schema.resolve( reader.get_header() ) );
+}
+
+TEST( csv_schema_test, infer_from_reader )
+{
+  temp_file  file( "reader.csv", "a,b\n1,x\n2,y\n3.5,z\n" );
+  csv_reader reader( "test", std::make_unique<csv_dev_file>( file_options( file.path() ), nullptr ), nullptr );
+  ASSERT_TRUE( reader.open() );
+
+  // Only first two rows are sampled.
+  EXPECT_EQ( (std::vector<type_t>{ type_t::integer, type_t::string }), types( csv_schema::infer( reader, 2 ) ) );
+}
+
+TEST( csv_schema_test, infer_from_random_blocks )
+{
+  std::mt19937 rnd( 11 );
+  std::string  content = "id,price,flag,when,color\n";
+  for ( std::size_t row = 0; row < 20000; ++row )
+  {
+    content += std::to_string( row ) + "," + std::to_string( rnd() % 1000 ) + "." + std::to_string( rnd() % 100 ) + "," 
+             + ((rnd() % 2)?"true":"0") + ",2024-01-" + std::to_string( 10 + rnd() % 20 ) + "T10:00:00Z," 
+             + ((rnd() % 2)?"red":"blue") + "\n";
+  }
+
+  csv_reader parser( "test", nullptr, nullptr );
+  const csv_schema first  = csv_schema::infer( parser, content.data(), content.length(), 8, 4096 );
+  const csv_schema second = csv_schema::infer( parser, content.data(), content.length(), 8, 4096 );
+
+  EXPECT_EQ( (std::vector<type_t>{ type_t::integer, type_t::floating, type_t::boolean, type_t::timestamp, type_t::dictionary }), types( first ) );
+  EXPECT_EQ( types( first ), types( second ) );
+  for ( std::size_t ndx = 0; ndx < first.size(); ++ndx )
+  {
+    EXPECT_EQ( first[ndx].label, second[ndx].label );
+    EXPECT_EQ( first[ndx].nullable, second[ndx].nullable );
+    EXPECT_FALSE( first[ndx].nullable );
+  }
+
+  // Blocks never start in the middle of a row.
+  const csv_schema single = csv_schema::infer( parser, content.data(), content.length(), 1, 4096 );
+  EXPECT_EQ( types( first ), types( single ) );
+}
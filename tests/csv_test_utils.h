@@ -0,0 +1,321 @@
+/**************************************************************************************************
+ * 
+ * Copyright 2022 https://github.com/fe-dagostino
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this 
+ * software and associated documentation files (the "Software"), to deal in the Software 
+ * without restriction, including without limitation the rights to use, copy, modify, 
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to 
+ * permit persons to whom the Software is furnished to do so, subject to the following 
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies 
+ * or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE 
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR 
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *************************************************************************************************/
+
+#ifndef CSV_TEST_UTILS_H
+#define CSV_TEST_UTILS_H
+
+#include "csv_common.h"
+#include "csv_reader.h"
+#include "csv_dev_file.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include <unistd.h>
+
+#ifdef CSV_HAS_ZLIB
+# include <zlib.h>
+#endif
+#ifdef CSV_HAS_ZSTD
+# include <zstd.h>
+#endif
+
+namespace csv_test {
+
+/**
+ * Each field as ( hasquotes(), data() ), header included as first row.
+ */
+using field_t = std::pair<bool,std::string>;
+using row_t   = std::vector<field_t>;
+using rows_t  = std::vector<row_t>;
+
+/**
+ * File in the temporary directory removed on destruction, together with its sidecar.
+ */
+class temp_file
+{
+public:
+  explicit temp_file( const std::string& name )
+    : m_sPath( (std::filesystem::temp_directory_path() / ("libcsv_" + std::to_string(::getpid()) + "_" + name)).string() )
+  {}
+
+  temp_file( const std::string& name, const std::string& content )
+    : temp_file( name )
+  { write( content ); }
+
+  ~temp_file()
+  { 
+    std::remove( m_sPath.c_str() );
+    std::remove( csv::csv_row_index::sidecar_name( m_sPath ).c_str() );
+  }
+
+  inline const std::string& path() const noexcept
+  { return m_sPath; }
+
+  inline bool write( const std::string& content ) const
+  {
+    FILE* pFile = fopen( m_sPath.c_str(), "wb" );
+    if ( pFile == nullptr )
+      return false;
+    const bool _bWritten = (fwrite( content.data(), 1, content.size(), pFile ) == content.size());
+    return (fclose( pFile ) == 0) && _bWritten;
+  }
+
+  inline std::string read() const
+  {
+    std::string  _content;
+    FILE*        pFile = fopen( m_sPath.c_str(), "rb" );
+    if ( pFile == nullptr )
+      return _content;
+    char         _buffer[4096];
+    std::size_t  _nRead = 0;
+    while ( (_nRead = fread( _buffer, 1, sizeof(_buffer), pFile )) > 0 )
+      _content.append( _buffer, _nRead );
+    fclose( pFile );
+    return _content;
+  }
+
+private:
+  std::string   m_sPath;
+};
+
+/***/
+inline field_t to_field( const csv::csv_field_t& field )
+{ return { field.hasquotes(), field.data().empty()?std::string():std::string( field.data().data(), field.data().size() ) }; }
+
+/***/
+inline row_t to_row( const csv::csv_row& row )
+{
+  row_t _row;
+  for ( const auto& field : row )
+    _row.push_back( to_field( field ) );
+  return _row;
+}
+
+/**
+ * Read all rows with @param reader already configured, header included.
+ */
+template<typename reader_t>
+inline rows_t read_rows( reader_t& reader )
+{
+  rows_t        _rows;
+  csv::csv_row  _row;
+
+  while ( reader.read( _row ) )
+  {
+    if ( _rows.empty() )
+      _rows.push_back( to_row( reader.get_header() ) );
+    _rows.push_back( to_row( _row ) );
+  }
+
+  return _rows;
+}
+
+/**
+ * Options for a plain csv_dev_file on @param filename.
+ */
+inline std::unique_ptr<csv::csv_dev_file_options> file_options( const std::string& filename, csv::csv_uint_t nBufferSize = csv::to_bytes<64>::KBytes,
+                                                                 csv::csv_uint_t nReadAhead = 0, bool bDirect = false )
+{
+  return std::make_unique<csv::csv_dev_file_options>( filename, csv::csv_dev_file_options::openmode::read, nBufferSize,
+                                                      csv::csv_dev_file_options::filetype::PLAIN_TEXT, nReadAhead, bDirect );
+}
+
+/**
+ * Random csv with quoted fields, escaped quotes, delimiters and eol inside quotes, 
+ * whitespaces, CR, empty fields, comments, malformed quotes and with @param short_rows 
+ * rows with a different number of fields, using @param delimiter and @param quote.
+ */
+inline std::string random_csv( uint32_t seed, std::size_t rows, char delimiter = ',', char quote = '"', bool short_rows = true )
+{
+  std::mt19937      _rnd( seed );
+  const std::string _plain  = "abxyz012 \t\xc3\xa9";
+  const std::string _specials = std::string("#\r\n") + delimiter + quote + quote;
+  const std::size_t _columns = 1 + _rnd() % 8;
+  std::string       _csv;
+
+  auto text = [&]( std::size_t length, bool special ) {
+    std::string _text;
+    for ( std::size_t ndx = 0; ndx < length; ++ndx )
+      _text += (special && (_rnd() % 6 == 0))?_specials[_rnd() % _specials.size()]:_plain[_rnd() % _plain.size()];
+    return _text;
+  };
+
+  for ( std::size_t col = 0; col < _columns; ++col )
+    _csv += ((col > 0)?std::string(1,delimiter):std::string()) + "h" + std::to_string(col);
+  _csv += '\n';
+
+  for ( std::size_t row = 0; row < rows; ++row )
+  {
+    const std::size_t _nFields = (short_rows && (_rnd() % 10 == 0))?(_rnd() % (_columns + 2)):_columns;
+
+    if ( _rnd() % 40 == 0 )
+      _csv += "#" + text( _rnd() % 20, false );
+
+    for ( std::size_t col = 0; col < _nFields; ++col )
+    {
+      if ( col > 0 )
+        _csv += delimiter;
+
+      switch ( _rnd() % 6 )
+      {
+        case 0:   break;
+        case 1:
+        case 2:   _csv += text( _rnd() % 20, false ); break;
+        case 3:   
+        {
+          std::string _quoted = text( _rnd() % 40, true );
+          std::string _escaped;
+          for ( char ch : _quoted )
+            _escaped += (ch == quote)?std::string(2,quote):std::string(1,ch);
+          _csv += quote + _escaped + quote;
+        }
+        break;
+        case 4:   _csv += " " + std::string(1,quote) + text( _rnd() % 10, false ) + quote + " "; break;
+        default:  _csv += text( _rnd() % 20, true ); break;
+      }
+    }
+
+    _csv += (_rnd() % 8 == 0)?"\r\n":"\n";
+  }
+
+  return _csv;
+}
+
+/***/
+inline void append_le( std::string& out, uint32_t value, std::size_t bytes )
+{
+  for ( std::size_t ndx = 0; ndx < bytes; ++ndx, value >>= 8 )
+    out += static_cast<char>(value & 0xFF);
+}
+
+#ifdef CSV_HAS_ZLIB
+/**
+ * Single gzip member.
+ */
+inline std::string gzip( const std::string& data )
+{
+  std::string  _out( compressBound( static_cast<uLong>(data.size()) ) + 64, '\0' );
+  z_stream     _zs{};
+
+  deflateInit2( &_zs, 6, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY );
+  _zs.next_in   = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+  _zs.avail_in  = static_cast<uInt>(data.size());
+  _zs.next_out  = reinterpret_cast<Bytef*>(_out.data());
+  _zs.avail_out = static_cast<uInt>(_out.size());
+  deflate( &_zs, Z_FINISH );
+  _out.resize( _zs.total_out );
+  deflateEnd( &_zs );
+
+  return _out;
+}
+
+/**
+ * BGZF, gzip members of @param block_size bytes with the member size in the "BC" extra subfield.
+ */
+inline std::string bgzf( const std::string& data, std::size_t block_size )
+{
+  std::string   _out;
+
+  for ( std::size_t offset = 0; offset <= data.size(); offset += block_size )
+  {
+    const std::size_t  _length = std::min( block_size, data.size() - offset );
+    const Bytef*       _pInput = reinterpret_cast<const Bytef*>(data.data() + offset);
+    std::string        _block( compressBound( static_cast<uLong>(_length) ) + 64, '\0' );
+    z_stream           _zs{};
+
+    deflateInit2( &_zs, 6, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY );
+    _zs.next_in   = const_cast<Bytef*>(_pInput);
+    _zs.avail_in  = static_cast<uInt>(_length);
+    _zs.next_out  = reinterpret_cast<Bytef*>(_block.data());
+    _zs.avail_out = static_cast<uInt>(_block.size());
+    deflate( &_zs, Z_FINISH );
+    _block.resize( _zs.total_out );
+    deflateEnd( &_zs );
+
+    _out += std::string( "\x1f\x8b\x08\x04\0\0\0\0\0\xff\x06\0BC\x02\0", 16 );
+    append_le( _out, static_cast<uint32_t>(18 + _block.size() + 8 - 1), 2 );
+    _out += _block;
+    append_le( _out, static_cast<uint32_t>(crc32( 0, _pInput, static_cast<uInt>(_length) )), 4 );
+    append_le( _out, static_cast<uint32_t>(_length), 4 );
+
+    // Last block is empty, as the BGZF end of file marker.
+    if ( _length == 0 )
+      break;
+  }
+
+  return _out;
+}
+#endif
+
+#ifdef CSV_HAS_ZSTD
+/**
+ * Single zstd frame.
+ */
+inline std::string zstd( const std::string& data )
+{
+  std::string _out( ZSTD_compressBound( data.size() ), '\0' );
+  _out.resize( ZSTD_compress( _out.data(), _out.size(), data.data(), data.size(), 3 ) );
+  return _out;
+}
+
+/**
+ * zstd seekable format, frames of @param frame_size bytes followed by the seek table.
+ */
+inline std::string zstd_seekable( const std::string& data, std::size_t frame_size )
+{
+  std::string   _out;
+  std::string   _table;
+  uint32_t      _nFrames = 0;
+
+  for ( std::size_t offset = 0; offset < data.size(); offset += frame_size, ++_nFrames )
+  {
+    const std::size_t _length = std::min( frame_size, data.size() - offset );
+    std::string       _frame = zstd( data.substr( offset, _length ) );
+
+    _out += _frame;
+    append_le( _table, static_cast<uint32_t>(_frame.size()), 4 );
+    append_le( _table, static_cast<uint32_t>(_length), 4 );
+  }
+
+  append_le( _out, 0x184D2A5E, 4 );
+  append_le( _out, static_cast<uint32_t>(_table.size() + 9), 4 );
+  _out += _table;
+  append_le( _out, _nFrames, 4 );
+  append_le( _out, 0, 1 );
+  append_le( _out, 0x8F92EAB1, 4 );
+
+  return _out;
+}
+#endif
+
+} // namespace csv_test
+
+#endif //CSV_TEST_UTILS_H
@@ -0,0 +1,200 @@
+/**************************************************************************************************
+ * 
+ * Copyright 2022 https://github.com/fe-dagostino
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this 
+ * software and associated documentation files (the "Software"), to deal in the Software 
+ * without restriction, including without limitation the rights to use, copy, modify, 
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to 
+ * permit persons to whom the Software is furnished to do so, subject to the following 
+ * conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies 
+ * or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, 
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR 
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE 
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR 
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *************************************************************************************************/
+
+#include "csv_test_utils.h"
+#include "csv_writer.h"
+
+using namespace csv;
+using namespace csv_test;
+
+namespace {
+
+/***/
+csv_field_t field( const std::string& data, bool quoted = false )
+{ return csv_field_t( csv_data_t( data.data(), data.size() ), quoted ); }
+
+/***/
+csv_row make_row( const std::vector<std::string>& values, bool quoted = false )
+{
+  csv_row row;
+  for ( const std::string& value : values )
+    row.push_back( field( value, quoted ) );
+  return row;
+}
+
+/***/
+csv_header make_header( const std::vector<std::string>& labels )
+{
+  csv_header header;
+  header.init( make_row( labels ) );
+  return header;
+}
+
+/***/
+std::unique_ptr<csv_writer> make_writer( const std::string& filename, csv_uint_t nBufferSize = to_bytes<64>::KBytes )
+{
+  return std::make_unique<csv_writer>( "test", std::make_unique<csv_dev_file>( std::make_unique<csv_dev_file_options>( filename, csv_dev_file_options::openmode::write ), nullptr ), 
+                                       nullptr, nBufferSize );
+}
+
+} // namespace
+
+TEST( csv_writer_test, output_is_read_back )
+{
+  const std::string alphabet = "abx12 \t,;\"\r";
+  const csv_header  header   = make_header( { "h0", "h1", "h2", "h3", "h4", "h5" } );
+  std::mt19937      rnd( 1 );
+
+  for ( csv_uint_t nBufferSize : { 0, 1, 100, 65536 } )
+  {
+    temp_file                              file( "roundtrip.csv" );
+    std::vector<std::vector<std::string>>  values( 300 );
+
+    {
+      auto writer = make_writer( file.path(), nBufferSize );
+      ASSERT_TRUE( writer->open( header ) );
+      for ( auto& row : values )
+      {
+        for ( std::size_t col = 0; col < header.size(); ++col )
+        {
+          std::string value( rnd() % 60, ' ' );
+          for ( char& ch : value )
+            ch = alphabet[rnd() % ((rnd() % 3 == 0)?alphabet.size():6)];
+          // csv_parser close quotes at the first escaped quote, so delimiters are kept before it.
+          if ( std::size_t quote = value.find( '"' ); quote != std::string::npos )
+            std::replace( value.begin() + static_cast<std::ptrdiff_t>(quote), value.end(), ',', ';' );
+          row.push_back( value );
+        }
+        ASSERT_TRUE( writer->write( header, make_row( row ) ) );
+      }
+      ASSERT_TRUE( writer->close() );
+    }
+
+    csv_reader reader( "test", std::make_unique<csv_dev_file>( file_options( file.path() ), nullptr ), nullptr );
+    reader.skip_whitespaces( false );
+    reader.trim_all( false );
+
+    // csv_parser keep quoted fields escaped.
+    std::vector<std::vector<std::string>> result;
+    csv_row                               row;
+    while ( reader.read( row ) )
+    {
+      std::vector<std::string> fields;
+      for ( const auto& [quoted, data] : to_row( row ) )
+      {
+        std::string value;
+        for ( std::size_t ndx = 0; ndx < data.size(); ++ndx )
+        {
+          value += data[ndx];
+          if ( quoted && (data[ndx] == '"') && (ndx + 1 < data.size()) && (data[ndx+1] == '"') )
+            ++ndx;
+        }
+        fields.push_back( value );
+      }
+      result.push_back( fields );
+    }
+
+    EXPECT_EQ( values, result ) << "buffer " << nBufferSize;
+  }
+}
+
+TEST( csv_writer_test, columns_are_mapped_by_label )
+{
+  temp_file         file( "mapping.csv" );
+  const csv_header  output  = make_header( { "a", "b", "c" } );
+  const csv_header  reverse = make_header( { "c", "missing", "b", "a" } );
+
+  {
+    auto writer = make_writer( file.path() );
+    ASSERT_TRUE( writer->open( output ) );
+    ASSERT_TRUE( writer->write( output,  make_row( { "A1", "B1", "C1" } ) ) );
+    ASSERT_TRUE( writer->write( reverse, make_row( { "C2", "M2", "B2", "A2" } ) ) );
+    ASSERT_TRUE( writer->write( output,  make_row( { "A3", "B3", "C3" } ) ) );
+    ASSERT_TRUE( writer->close() );
+  }
+
+  EXPECT_EQ( "a,b,c\nA1,B1,C1\nA2,B2,C2\nA3,B3,C3\n", file.read() );
+}
+
+TEST( csv_writer_test, header_replaced_at_same_address )
+{
+  temp_file                  file( "replaced.csv" );
+  const csv_header           output = make_header( { "a", "b", "c" } );
+  std::optional<csv_header>  source;
+
+  {
+    auto writer = make_writer( file.path() );
+    ASSERT_TRUE( writer->open( output ) );
+
+    source.emplace( make_header( { "a", "b", "c" } ) );
+    ASSERT_TRUE( writer->write( *source, make_row( { "A1", "B1", "C1" } ) ) );
+
+    // Same address and same number of columns, labels in a different order.
+    source.reset();
+    source.emplace( make_header( { "c", "b", "a" } ) );
+    ASSERT_TRUE( writer->write( *source, make_row( { "C2", "B2", "A2" } ) ) );
+
+    // Labels changed in place.
+    source->init( make_row( { "b", "a", "c" } ) );
+    ASSERT_TRUE( writer->write( *source, make_row( { "B3", "A3", "C3" } ) ) );
+    ASSERT_TRUE( writer->close() );
+  }
+
+  EXPECT_EQ( "a,b,c\nA1,B1,C1\nA2,B2,C2\nA3,B3,C3\n", file.read() );
+}
+
+TEST( csv_writer_test, rfc4180_quoting )
+{
+  temp_file         file( "quoting.csv" );
+  const csv_header  header = make_header( { "a", "b", "c", "d", "e", "f" } );
+
+  {
+    auto writer = make_writer( file.path() );
+    ASSERT_TRUE( writer->open( header ) );
+    ASSERT_TRUE( writer->write( header, make_row( { "plain", "with,delimiter", "with \"quote\"", "line\nfeed", "carriage\rreturn", "" } ) ) );
+    // Quoted fields are kept escaped by csv_parser, only lone quotes are doubled.
+    ASSERT_TRUE( writer->write( header, make_row( { "x\"\"y", "", "lone\"quote", "a,b", "\"\"", "end\"" }, true ) ) );
+    ASSERT_TRUE( writer->close() );
+  }
+
+  EXPECT_EQ( "a,b,c,d,e,f\n"
+             "plain,\"with,delimiter\",\"with \"\"quote\"\"\",\"line\nfeed\",\"carriage\rreturn\",\n"
+             "\"x\"\"y\",\"\",\"lone\"\"quote\",\"a,b\",\"\"\"\",\"end\"\"\"\n", file.read() );
+}
+
+TEST( csv_writer_test, custom_dialect_quoting )
+{
+  temp_file         file( "dialect.csv" );
+  const csv_header  header = make_header( { "a", "b", "c" } );
+
+  {
+    auto writer = make_writer( file.path() );
+    writer->set_delimeter( ';' );
+    writer->set_quote( '\'' );
+    ASSERT_TRUE( writer->open( header ) );
+    ASSERT_TRUE( writer->write( header, make_row( { "a,b", "x;y", "it's" } ) ) );
+    ASSERT_TRUE( writer->close() );
+  }
+
+  EXPECT_EQ( "a;b;c\na,b;'x;y';'it''s'\n", file.read() );
+}